@@ -0,0 +1,360 @@
+
+#define ZRAND_IMPLEMENTATION
+#include "zrand.h"
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#   include <sched.h>
+#endif
+
+// Single-thread throughput of the core API against libc and <random> baselines.
+// Each case is warmed up and calibrated to ~10 ms per trial, then timed over
+// several trials; the median is reported, the minimum kept for reference.
+//
+//   runner_core [--trials N] [--cpu N] [--filter SUBSTR] [--json PATH]
+
+typedef uint64_t (*bench_fn)(size_t n);
+
+typedef struct 
+{
+    const char *name;
+    const char *group;      // "zrand" or "baseline".
+    double values_per_op;
+    double bytes_per_op;
+    bench_fn fn;
+} bench_case;
+
+typedef struct 
+{
+    const bench_case *c;
+    double ns_median;
+    double ns_min;
+} bench_result;
+
+static volatile uint64_t g_sink;
+
+static zrand_rng g_rng;
+static std::mt19937 g_mt(1);
+static std::minstd_rand g_minstd(1);
+
+enum { BYTES_CHUNK = 4096, SHUFFLE_LEN = 1024 };
+static uint8_t g_bytes[BYTES_CHUNK];
+static uint32_t g_deck[SHUFFLE_LEN];
+
+// zrand cases.
+
+static uint64_t b_rng_u32(size_t n) 
+{
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) 
+    {
+        acc += zrand_rng_u32(&g_rng);
+    }
+    return acc;
+}
+
+static uint64_t b_rng_u64(size_t n) 
+{
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) 
+    {
+        acc += zrand_rng_u64(&g_rng);
+    }
+    return acc;
+}
+
+static uint64_t b_u32(size_t n) 
+{
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) 
+    {
+        acc += zrand_u32();
+    }
+    return acc;
+}
+
+static uint64_t b_range(size_t n) 
+{
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) 
+    {
+        acc += (uint64_t)zrand_range(0, 999);
+    }
+    return acc;
+}
+
+static uint64_t b_f64(size_t n) 
+{
+    double acc = 0.0;
+    for (size_t i = 0; i < n; i++) 
+    {
+        acc += zrand_f64();
+    }
+    return (uint64_t)acc;
+}
+
+static uint64_t b_gaussian(size_t n) 
+{
+    double acc = 0.0;
+    for (size_t i = 0; i < n; i++) 
+    {
+        acc += zrand_gaussian(0.0, 1.0);
+    }
+    return (uint64_t)(acc * 1000.0);
+}
+
+static uint64_t b_bytes(size_t n) 
+{
+    for (size_t i = 0; i < n; i++) 
+    {
+        zrand_bytes(g_bytes, BYTES_CHUNK);
+    }
+    return g_bytes[0];
+}
+
+static uint64_t b_uuid(size_t n) 
+{
+    char buf[37];
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) 
+    {
+        zrand_uuid(buf);
+        acc += (uint8_t)buf[0];
+    }
+    return acc;
+}
+
+static uint64_t b_shuffle(size_t n) 
+{
+    for (size_t i = 0; i < n; i++) 
+    {
+        zrand_shuffle(g_deck, SHUFFLE_LEN, sizeof(g_deck[0]));
+    }
+    return g_deck[0];
+}
+
+// Baselines.
+
+static uint64_t b_libc_rand(size_t n) 
+{
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) 
+    {
+        acc += (uint64_t)rand();
+    }
+    return acc;
+}
+
+static uint64_t b_mt19937(size_t n) 
+{
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) 
+    {
+        acc += g_mt();
+    }
+    return acc;
+}
+
+static uint64_t b_minstd(size_t n) 
+{
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) 
+    {
+        acc += g_minstd();
+    }
+    return acc;
+}
+
+static uint64_t b_mt19937_range(size_t n) 
+{
+    std::uniform_int_distribution<int> dist(0, 999);
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) 
+    {
+        acc += (uint64_t)dist(g_mt);
+    }
+    return acc;
+}
+
+static uint64_t b_mt19937_f64(size_t n) 
+{
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    double acc = 0.0;
+    for (size_t i = 0; i < n; i++) 
+    {
+        acc += dist(g_mt);
+    }
+    return (uint64_t)acc;
+}
+
+static uint64_t b_mt19937_normal(size_t n) 
+{
+    std::normal_distribution<double> dist(0.0, 1.0);
+    double acc = 0.0;
+    for (size_t i = 0; i < n; i++) 
+    {
+        acc += dist(g_mt);
+    }
+    return (uint64_t)(acc * 1000.0);
+}
+
+static uint64_t b_std_shuffle(size_t n) 
+{
+    for (size_t i = 0; i < n; i++) 
+    {
+        std::shuffle(g_deck, g_deck + SHUFFLE_LEN, g_mt);
+    }
+    return g_deck[0];
+}
+
+static const bench_case g_cases[] = 
+{
+    { "zrand_rng_u32 (pcg32)",    "zrand",    1, 4,           b_rng_u32 },
+    { "zrand_rng_u64",            "zrand",    1, 8,           b_rng_u64 },
+    { "zrand_u32 (TLS)",          "zrand",    1, 4,           b_u32 },
+    { "zrand_range [0,999]",      "zrand",    1, 4,           b_range },
+    { "zrand_f64",                "zrand",    1, 8,           b_f64 },
+    { "zrand_gaussian",           "zrand",    1, 8,           b_gaussian },
+    { "zrand_bytes (4 KiB)",      "zrand",    BYTES_CHUNK, BYTES_CHUNK, b_bytes },
+    { "zrand_uuid",               "zrand",    1, 36,          b_uuid },
+    { "zrand_shuffle (1024 x4B)", "zrand",    SHUFFLE_LEN, SHUFFLE_LEN * 4, b_shuffle },
+    { "rand()",                   "baseline", 1, 4,           b_libc_rand },
+    { "std::mt19937",             "baseline", 1, 4,           b_mt19937 },
+    { "std::minstd_rand",         "baseline", 1, 4,           b_minstd },
+    { "mt19937 uniform_int",      "baseline", 1, 4,           b_mt19937_range },
+    { "mt19937 uniform_real",     "baseline", 1, 8,           b_mt19937_f64 },
+    { "mt19937 normal",           "baseline", 1, 8,           b_mt19937_normal },
+    { "std::shuffle (1024 x4B)",  "baseline", SHUFFLE_LEN, SHUFFLE_LEN * 4, b_std_shuffle },
+};
+
+static double time_ns(bench_fn fn, size_t n) 
+{
+    auto t0 = std::chrono::steady_clock::now();
+    g_sink += fn(n);
+    auto t1 = std::chrono::steady_clock::now();
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+}
+
+static bench_result run_case(const bench_case *c, int trials) 
+{
+    // Warm up and grow n until one trial takes at least 10 ms.
+    size_t n = 256;
+    while (time_ns(c->fn, n) < 1e7 && n < ((size_t)1 << 34)) 
+    {
+        n *= 2;
+    }
+    std::vector<double> per_op((size_t)trials);
+    for (int t = 0; t < trials; t++) 
+    {
+        per_op[(size_t)t] = time_ns(c->fn, n) / (double)n;
+    }
+    std::sort(per_op.begin(), per_op.end());
+    bench_result r = { c, per_op[per_op.size() / 2], per_op[0] };
+    return r;
+}
+
+static bool pin_cpu(int cpu) 
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return 0 == sched_setaffinity(0, sizeof(set), &set);
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+static void write_json(const char *path, const std::vector<bench_result> &results, int trials, int cpu, bool pinned) 
+{
+    FILE *f = fopen(path, "w");
+    if (!f) 
+    {
+        fprintf(stderr, "bench: cannot write %s\n", path);
+        return;
+    }
+    fprintf(f, "{\n  \"schema\": 1,\n  \"trials\": %d,\n  \"cpu\": %d,\n  \"pinned\": %s,\n  \"results\": [\n",
+            trials, cpu, pinned ? "true" : "false");
+    for (size_t i = 0; i < results.size(); i++) 
+    {
+        const bench_result &r = results[i];
+        fprintf(f, "    { \"name\": \"%s\", \"group\": \"%s\", \"ns_per_op\": %.4f, \"ns_per_op_min\": %.4f, "
+                   "\"values_per_sec\": %.6g, \"gb_per_sec\": %.4f }%s\n",
+                r.c->name, r.c->group, r.ns_median, r.ns_min,
+                r.c->values_per_op / r.ns_median * 1e9, r.c->bytes_per_op / r.ns_median,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+}
+
+int main(int argc, char **argv) 
+{
+    int trials = 7;
+    int cpu = 0;
+    const char *filter = NULL;
+    const char *json = NULL;
+    for (int i = 1; i < argc; i++) 
+    {
+        if (0 == strcmp(argv[i], "--trials") && i + 1 < argc) 
+        {
+            trials = atoi(argv[++i]);
+        }
+        else if (0 == strcmp(argv[i], "--cpu") && i + 1 < argc) 
+        {
+            cpu = atoi(argv[++i]);
+        }
+        else if (0 == strcmp(argv[i], "--filter") && i + 1 < argc) 
+        {
+            filter = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--json") && i + 1 < argc) 
+        {
+            json = argv[++i];
+        }
+        else 
+        {
+            fprintf(stderr, "usage: %s [--trials N] [--cpu N] [--filter SUBSTR] [--json PATH]\n", argv[0]);
+            return 2;
+        }
+    }
+    trials = trials < 1 ? 1 : trials;
+
+    bool pinned = pin_cpu(cpu);
+    zrand_rng_init(&g_rng, 1, 1);
+    srand(1);
+    for (uint32_t i = 0; i < SHUFFLE_LEN; i++) 
+    {
+        g_deck[i] = i;
+    }
+
+    printf("=> Core throughput (%d trials, median; cpu %d %s).\n", trials, cpu, pinned ? "pinned" : "unpinned");
+    printf("%-26s %-9s %10s %10s %14s %10s\n", "case", "group", "ns/op", "min", "values/s", "GB/s");
+    std::vector<bench_result> results;
+    for (size_t i = 0; i < sizeof(g_cases) / sizeof(g_cases[0]); i++) 
+    {
+        const bench_case *c = &g_cases[i];
+        if (filter && !strstr(c->name, filter)) 
+        {
+            continue;
+        }
+        bench_result r = run_case(c, trials);
+        printf("%-26s %-9s %10.3f %10.3f %14.4g %10.3f\n", c->name, c->group, r.ns_median, r.ns_min,
+               c->values_per_op / r.ns_median * 1e9, c->bytes_per_op / r.ns_median);
+        results.push_back(r);
+    }
+    if (json) 
+    {
+        write_json(json, results, trials, cpu, pinned);
+        printf("=> Wrote %s.\n", json);
+    }
+    return 0;
+}
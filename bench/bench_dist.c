@@ -0,0 +1,396 @@
+
+#define _DEFAULT_SOURCE
+#define ZRAND_IMPLEMENTATION
+#include "zrand.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// Speed next to statistical correctness for each distribution API.
+// Every case draws N samples in a timed loop, then checks them offline:
+//   - chi-square over 100 equiprobable bins (or one cell per outcome),
+//   - Kolmogorov-Smirnov against the analytic CDF (continuous cases),
+//   - mean and variance z-scores against the analytic moments.
+// A case FAILs when a p-value drops below ALPHA or |z| > Z_MAX, and is SLOW
+// when --baseline is given and ns/op regresses by more than --tolerance.
+//
+//   runner_dist [--n N] [--seed S] [--json PATH] [--baseline PATH] [--tolerance 0.10]
+
+#define ALPHA 1e-4
+#define Z_MAX 5.0
+#define CHI_BINS 100
+
+typedef struct 
+{
+    const char *name;
+    double (*sample)(void);
+    double (*cdf)(double x);     // Continuous cases; NULL for discrete.
+    double (*pmf)(int64_t k);    // Discrete cases over [lo, hi].
+    int64_t lo, hi;
+    double mean, var;
+} dist_case;
+
+typedef struct 
+{
+    double ns;
+    double chi_p, ks_p;   // -1 when not applicable.
+    double z_mean, z_var;
+    double skew, exkurt;
+    bool fail, slow;
+} dist_result;
+
+// Samplers.
+
+static double s_f32(void) { return zrand_f32(); }
+static double s_f64(void) { return zrand_f64(); }
+static double s_range_f(void) { return zrand_range_f(-2.0f, 3.0f); }
+static double s_range10(void) { return zrand_range(0, 9); }
+static double s_range7(void) { return zrand_range(-3, 3); }
+static double s_range_big(void) { return zrand_range(0, 999999); }
+static double s_gaussian(void) { return zrand_gaussian(0.0, 1.0); }
+static double s_gaussian_ms(void) { return zrand_gaussian(10.0, 2.5); }
+static double s_bool(void) { return zrand_bool(); }
+static double s_chance(void) { return zrand_chance(0.3); }
+static double s_u32_byte(void) { return zrand_u32() >> 24; }
+
+// Analytic distributions.
+
+static double cdf_unit(double x) { return x < 0.0 ? 0.0 : x > 1.0 ? 1.0 : x; }
+static double cdf_range_f(double x) { return cdf_unit((x + 2.0) / 5.0); }
+static double cdf_range_big(double x) { return cdf_unit((floor(x) + 1.0) / 1e6); }
+static double cdf_normal(double x) { return 0.5 * erfc(-x / sqrt(2.0)); }
+static double cdf_normal_ms(double x) { return cdf_normal((x - 10.0) / 2.5); }
+static double pmf_10(int64_t k) { (void)k; return 0.1; }
+static double pmf_7(int64_t k) { (void)k; return 1.0 / 7.0; }
+static double pmf_half(int64_t k) { (void)k; return 0.5; }
+static double pmf_chance(int64_t k) { return k ? 0.3 : 0.7; }
+static double pmf_256(int64_t k) { (void)k; return 1.0 / 256.0; }
+
+static const dist_case g_cases[] = 
+{
+    { "zrand_f32",            s_f32,         cdf_unit,      NULL,       0, 0,      0.5,  1.0 / 12.0 },
+    { "zrand_f64",            s_f64,         cdf_unit,      NULL,       0, 0,      0.5,  1.0 / 12.0 },
+    { "zrand_range_f(-2,3)",  s_range_f,     cdf_range_f,   NULL,       0, 0,      0.5,  25.0 / 12.0 },
+    { "zrand_range(0,9)",     s_range10,     NULL,          pmf_10,     0, 9,      4.5,  8.25 },
+    { "zrand_range(-3,3)",    s_range7,      NULL,          pmf_7,      -3, 3,     0.0,  4.0 },
+    { "zrand_range(0,999999)",s_range_big,   cdf_range_big, NULL,       0, 0,      499999.5, (1e12 - 1.0) / 12.0 },
+    { "zrand_gaussian(0,1)",  s_gaussian,    cdf_normal,    NULL,       0, 0,      0.0,  1.0 },
+    { "zrand_gaussian(10,2.5)", s_gaussian_ms, cdf_normal_ms, NULL,     0, 0,      10.0, 6.25 },
+    { "zrand_bool",           s_bool,        NULL,          pmf_half,   0, 1,      0.5,  0.25 },
+    { "zrand_chance(0.3)",    s_chance,      NULL,          pmf_chance, 0, 1,      0.3,  0.21 },
+    { "zrand_u32 >> 24",      s_u32_byte,    NULL,          pmf_256,    0, 255,    127.5, (65536.0 - 1.0) / 12.0 },
+};
+
+// Regularized upper incomplete gamma Q(a, x) (series / continued fraction).
+static double gamma_q(double a, double x) 
+{
+    if (x <= 0.0) 
+    {
+        return 1.0;
+    }
+    double gln = lgamma(a);
+    if (x < a + 1.0) 
+    {
+        double ap = a, sum = 1.0 / a, del = sum;
+        for (int n = 0; n < 1000 && fabs(del) > fabs(sum) * 1e-15; n++) 
+        {
+            ap += 1.0;
+            del *= x / ap;
+            sum += del;
+        }
+        return 1.0 - sum * exp(-x + a * log(x) - gln);
+    }
+    double b = x + 1.0 - a, c = 1e300, d = 1.0 / b, h = d;
+    for (int i = 1; i < 1000; i++) 
+    {
+        double an = -i * (i - a);
+        b += 2.0;
+        d = an * d + b;
+        d = fabs(d) < 1e-300 ? 1e-300 : d;
+        c = b + an / c;
+        c = fabs(c) < 1e-300 ? 1e-300 : c;
+        d = 1.0 / d;
+        double del = d * c;
+        h *= del;
+        if (fabs(del - 1.0) < 1e-15) 
+        {
+            break;
+        }
+    }
+    return exp(-x + a * log(x) - gln) * h;
+}
+
+// Asymptotic Kolmogorov distribution, with Stephens' small-sample correction.
+static double ks_p(double d, size_t n) 
+{
+    double sn = sqrt((double)n);
+    double l = (sn + 0.12 + 0.11 / sn) * d;
+    double sum = 0.0, sign = 1.0;
+    for (int k = 1; k <= 100; k++) 
+    {
+        double term = sign * exp(-2.0 * k * k * l * l);
+        sum += term;
+        if (fabs(term) < 1e-12) 
+        {
+            break;
+        }
+        sign = -sign;
+    }
+    double p = 2.0 * sum;
+    return p < 0.0 ? 0.0 : p > 1.0 ? 1.0 : p;
+}
+
+static int cmp_double(const void *a, const void *b) 
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double now_ns(void) 
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void evaluate(const dist_case *c, double *x, size_t n, dist_result *r) 
+{
+    // Moments (two-pass for stability).
+    double m = 0.0;
+    for (size_t i = 0; i < n; i++) 
+    {
+        m += x[i];
+    }
+    m /= (double)n;
+    double m2 = 0.0, m3 = 0.0, m4 = 0.0;
+    for (size_t i = 0; i < n; i++) 
+    {
+        double d = x[i] - m, d2 = d * d;
+        m2 += d2;
+        m3 += d2 * d;
+        m4 += d2 * d2;
+    }
+    m2 /= (double)n;
+    m3 /= (double)n;
+    m4 /= (double)n;
+    r->skew = m3 / pow(m2, 1.5);
+    r->exkurt = m4 / (m2 * m2) - 3.0;
+    r->z_mean = (m - c->mean) / sqrt(c->var / (double)n);
+    // Var(s^2) ~ (mu4 - sigma^4) / n, with mu4 estimated from the sample.
+    r->z_var = (m2 - c->var) / sqrt((m4 - m2 * m2) / (double)n);
+
+    // Chi-square.
+    double chi = 0.0;
+    int cells;
+    if (c->cdf) 
+    {
+        static size_t counts[CHI_BINS];
+        memset(counts, 0, sizeof(counts));
+        for (size_t i = 0; i < n; i++) 
+        {
+            int b = (int)(c->cdf(x[i]) * CHI_BINS);
+            counts[b < 0 ? 0 : b >= CHI_BINS ? CHI_BINS - 1 : b]++;
+        }
+        double e = (double)n / CHI_BINS;
+        for (int b = 0; b < CHI_BINS; b++) 
+        {
+            chi += (counts[b] - e) * (counts[b] - e) / e;
+        }
+        cells = CHI_BINS;
+    }
+    else 
+    {
+        cells = (int)(c->hi - c->lo + 1);
+        size_t *counts = (size_t*)calloc((size_t)cells, sizeof(size_t));
+        size_t outside = 0;
+        for (size_t i = 0; i < n; i++) 
+        {
+            int64_t k = (int64_t)x[i];
+            if (k < c->lo || k > c->hi || (double)k != x[i]) 
+            {
+                outside++;
+                continue;
+            }
+            counts[k - c->lo]++;
+        }
+        for (int k = 0; k < cells; k++) 
+        {
+            double e = (double)n * c->pmf(c->lo + k);
+            chi += (counts[k] - e) * (counts[k] - e) / e;
+        }
+        free(counts);
+        // Any value outside the support is an outright failure.
+        chi = outside ? 1e300 : chi;
+    }
+    r->chi_p = gamma_q(0.5 * (cells - 1), 0.5 * chi);
+
+    // Kolmogorov-Smirnov.
+    r->ks_p = -1.0;
+    if (c->cdf) 
+    {
+        qsort(x, n, sizeof(double), cmp_double);
+        double dmax = 0.0;
+        for (size_t i = 0; i < n; i++) 
+        {
+            double f = c->cdf(x[i]);
+            double lo = f - (double)i / n, hi = (double)(i + 1) / n - f;
+            dmax = lo > dmax ? lo : dmax;
+            dmax = hi > dmax ? hi : dmax;
+        }
+        r->ks_p = ks_p(dmax, n);
+    }
+
+    r->fail = r->chi_p < ALPHA || (r->ks_p >= 0.0 && r->ks_p < ALPHA) ||
+              fabs(r->z_mean) > Z_MAX || fabs(r->z_var) > Z_MAX;
+}
+
+// Reads ns_per_op for `name` from a JSON file written by --json (one case per line).
+static double baseline_ns(const char *path, const char *name) 
+{
+    FILE *f = fopen(path, "r");
+    if (!f) 
+    {
+        return -1.0;
+    }
+    char line[512], key[160];
+    snprintf(key, sizeof(key), "\"name\": \"%s\"", name);
+    double ns = -1.0;
+    while (fgets(line, sizeof(line), f)) 
+    {
+        const char *p = strstr(line, key);
+        const char *q = p ? strstr(p, "\"ns_per_op\": ") : NULL;
+        if (q) 
+        {
+            ns = atof(q + strlen("\"ns_per_op\": "));
+            break;
+        }
+    }
+    fclose(f);
+    return ns;
+}
+
+static void fmt_p(char *buf, size_t len, double p) 
+{
+    if (p < 0.0) 
+    {
+        snprintf(buf, len, "-");
+    }
+    else 
+    {
+        snprintf(buf, len, "%.4f", p);
+    }
+}
+
+int main(int argc, char **argv) 
+{
+    size_t n = (size_t)1 << 20;
+    uint64_t seed = 1;
+    double tolerance = 0.10;
+    const char *json = NULL;
+    const char *baseline = NULL;
+    for (int i = 1; i < argc; i++) 
+    {
+        if (0 == strcmp(argv[i], "--n") && i + 1 < argc) 
+        {
+            n = (size_t)strtoull(argv[++i], NULL, 10);
+        }
+        else if (0 == strcmp(argv[i], "--seed") && i + 1 < argc) 
+        {
+            seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (0 == strcmp(argv[i], "--json") && i + 1 < argc) 
+        {
+            json = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--baseline") && i + 1 < argc) 
+        {
+            baseline = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--tolerance") && i + 1 < argc) 
+        {
+            tolerance = atof(argv[++i]);
+        }
+        else 
+        {
+            fprintf(stderr, "usage: %s [--n N] [--seed S] [--json PATH] [--baseline PATH] [--tolerance T]\n", argv[0]);
+            return 2;
+        }
+    }
+    n = n < 1000 ? 1000 : n;
+
+    double *x = (double*)malloc(n * sizeof(double));
+    if (!x) 
+    {
+        fprintf(stderr, "bench: out of memory\n");
+        return 1;
+    }
+    // The global API draws from this thread's generator; seed it for reproducible verdicts.
+    zrand_rng_init(zrand_local(), seed, 1);
+
+    FILE *out = json ? fopen(json, "w") : NULL;
+    if (out) 
+    {
+        fprintf(out, "{\n  \"schema\": 1,\n  \"samples\": %zu,\n  \"seed\": %llu,\n  \"results\": [\n",
+                n, (unsigned long long)seed);
+    }
+
+    printf("=> Distribution speed and goodness of fit (n = %zu, seed = %llu, alpha = %g).\n",
+           n, (unsigned long long)seed, ALPHA);
+    printf("%-24s %8s %9s %9s %8s %8s %8s %8s  %s\n",
+           "case", "ns/op", "chi2 p", "KS p", "z mean", "z var", "skew", "exkurt", "verdict");
+    size_t ncases = sizeof(g_cases) / sizeof(g_cases[0]);
+    int failures = 0, slow = 0;
+    for (size_t ci = 0; ci < ncases; ci++) 
+    {
+        const dist_case *c = &g_cases[ci];
+        dist_result r;
+        memset(&r, 0, sizeof(r));
+
+        // Warm up, then time the fill.
+        for (size_t i = 0; i < n / 16; i++) 
+        {
+            x[i] = c->sample();
+        }
+        double t0 = now_ns();
+        for (size_t i = 0; i < n; i++) 
+        {
+            x[i] = c->sample();
+        }
+        r.ns = (now_ns() - t0) / (double)n;
+
+        evaluate(c, x, n, &r);
+        if (baseline) 
+        {
+            double base = baseline_ns(baseline, c->name);
+            r.slow = base > 0.0 && r.ns > base * (1.0 + tolerance);
+        }
+        failures += r.fail;
+        slow += r.slow;
+
+        char chi_s[16], ks_s[16];
+        fmt_p(chi_s, sizeof(chi_s), r.chi_p);
+        fmt_p(ks_s, sizeof(ks_s), r.ks_p);
+        printf("%-24s %8.2f %9s %9s %8.2f %8.2f %8.3f %8.3f  %s%s\n",
+               c->name, r.ns, chi_s, ks_s, r.z_mean, r.z_var, r.skew, r.exkurt,
+               r.fail ? "FAIL" : "ok", r.slow ? " SLOW" : "");
+        if (out) 
+        {
+            fprintf(out, "    { \"name\": \"%s\", \"ns_per_op\": %.4f, \"chi2_p\": %.6g, \"ks_p\": %.6g, "
+                         "\"z_mean\": %.4f, \"z_var\": %.4f, \"fail\": %s, \"slow\": %s }%s\n",
+                    c->name, r.ns, r.chi_p, r.ks_p, r.z_mean, r.z_var,
+                    r.fail ? "true" : "false", r.slow ? "true" : "false", ci + 1 < ncases ? "," : "");
+        }
+    }
+    if (out) 
+    {
+        fprintf(out, "  ]\n}\n");
+        fclose(out);
+    }
+    free(x);
+
+    printf("=> %d accuracy failure(s), %d speed regression(s).\n", failures, slow);
+    return (failures || slow) ? 1 : 0;
+}
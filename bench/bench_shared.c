@@ -0,0 +1,108 @@
+
+#define _DEFAULT_SOURCE
+#define ZRAND_IMPLEMENTATION
+#define ZRAND_SHARED
+#include "zrand.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+// Scalability of one sequence consumed by many threads:
+// a mutex-guarded zrand_rng versus zrand_shared at several batch sizes.
+
+#define DRAWS_PER_THREAD (1u << 20)
+#define MAX_THREADS 128
+
+typedef struct 
+{
+    int mode;      // 0 = mutex, otherwise the zrand_shared batch size.
+    uint64_t sink;
+} worker_arg;
+
+static zrand_shared g_shared;
+static zrand_rng g_rng;
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_barrier_t g_start;
+
+static double now_sec(void) 
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *worker(void *p) 
+{
+    worker_arg *arg = (worker_arg*)p;
+    uint64_t acc = 0;
+    pthread_barrier_wait(&g_start);
+    if (0 == arg->mode) 
+    {
+        for (uint32_t i = 0; i < DRAWS_PER_THREAD; i++) 
+        {
+            pthread_mutex_lock(&g_lock);
+            acc += zrand_rng_u64(&g_rng);
+            pthread_mutex_unlock(&g_lock);
+        }
+    }
+    else 
+    {
+        zrand_shared_cursor cur;
+        zrand_shared_cursor_init(&cur, &g_shared, (uint32_t)arg->mode);
+        for (uint32_t i = 0; i < DRAWS_PER_THREAD; i++) 
+        {
+            acc += zrand_shared_cursor_u64(&cur);
+        }
+    }
+    arg->sink = acc;
+    return NULL;
+}
+
+static double run(int nthreads, int mode) 
+{
+    pthread_t threads[MAX_THREADS];
+    worker_arg args[MAX_THREADS];
+    pthread_barrier_init(&g_start, NULL, (unsigned)nthreads + 1);
+    for (int t = 0; t < nthreads; t++) 
+    {
+        args[t].mode = mode;
+        pthread_create(&threads[t], NULL, worker, &args[t]);
+    }
+    double t0 = now_sec();
+    pthread_barrier_wait(&g_start);
+    for (int t = 0; t < nthreads; t++) 
+    {
+        pthread_join(threads[t], NULL);
+    }
+    double elapsed = now_sec() - t0;
+    pthread_barrier_destroy(&g_start);
+    return (double)nthreads * DRAWS_PER_THREAD / elapsed / 1e6;
+}
+
+int main(int argc, char **argv) 
+{
+    int max_threads = (argc > 1) ? atoi(argv[1]) : MAX_THREADS;
+    if (max_threads < 1 || max_threads > MAX_THREADS) 
+    {
+        max_threads = MAX_THREADS;
+    }
+    static const int modes[] = {0, 1, 16, 256};
+
+    zrand_shared_init(&g_shared, 1);
+    zrand_rng_init(&g_rng, 1, 1);
+
+    printf("=> Shared generator scaling (Mdraws/s, %u draws per thread).\n", DRAWS_PER_THREAD);
+    printf("%8s %12s %12s %12s %12s\n", "threads", "mutex", "shared/1", "shared/16", "shared/256");
+    for (int n = 1; n <= max_threads; n *= 2) 
+    {
+        printf("%8d", n);
+        for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) 
+        {
+            printf(" %12.1f", run(n, modes[m]));
+        }
+        printf("\n");
+    }
+    return 0;
+}
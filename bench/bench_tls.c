@@ -0,0 +1,181 @@
+
+#define _DEFAULT_SOURCE
+#ifndef BENCH_SHARED_LIB
+#   define ZRAND_IMPLEMENTATION
+#endif
+#include "zrand.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+// Scaling of the thread-local global API. For 1..N threads, each thread:
+//   1. times its first zrand_u32() call (TLS allocation + OS seeding),
+//   2. hammers zrand_u32 / zrand_range / zrand_uuid for a fixed count,
+//   3. records per-call latency averaged over batches of LAT_BATCH calls
+//      (a clock read per call would cost more than the call itself).
+// Build it statically and against a shared library (see `make bench_tls`):
+// the TLS access model differs (local-exec vs. __tls_get_addr, or initial-exec
+// with ZRAND_TLS_INITIAL_EXEC). BENCH_BUILD labels the output.
+//
+//   runner_tls [max_threads]
+
+#define OPS_PER_THREAD (1u << 21)
+#define LAT_BATCH 16
+#define LAT_SAMPLES (OPS_PER_THREAD / LAT_BATCH)
+#define MAX_THREADS 256
+
+enum { API_U32, API_RANGE, API_UUID, API_COUNT };
+static const char *g_api_names[API_COUNT] = { "zrand_u32", "zrand_range", "zrand_uuid" };
+
+// One cache line (or more) per thread so the harness adds no false sharing.
+typedef struct 
+{
+    int api;
+    uint32_t ops;
+    double first_call_ns;
+    double elapsed_ns;
+    float *lat;          // ns per call, one entry per batch.
+    uint64_t sink;
+} __attribute__((aligned(64))) worker_arg;
+
+static pthread_barrier_t g_start;
+
+static double now_ns(void) 
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static inline uint64_t call_api(int api, char *uuid) 
+{
+    switch (api) 
+    {
+        case API_U32:   return zrand_u32();
+        case API_RANGE: return (uint64_t)zrand_range(0, 999);
+        default:        zrand_uuid(uuid); return (uint8_t)uuid[0];
+    }
+}
+
+static void *worker(void *p) 
+{
+    worker_arg *arg = (worker_arg*)p;
+    char uuid[37];
+    uint64_t acc = 0;
+
+    // A fresh thread: the first call allocates and seeds its generator.
+    double t0 = now_ns();
+    acc += zrand_u32();
+    arg->first_call_ns = now_ns() - t0;
+
+    pthread_barrier_wait(&g_start);
+    t0 = now_ns();
+    double prev = t0;
+    for (uint32_t b = 0; b < arg->ops / LAT_BATCH; b++) 
+    {
+        for (int i = 0; i < LAT_BATCH; i++) 
+        {
+            acc += call_api(arg->api, uuid);
+        }
+        double t = now_ns();
+        arg->lat[b] = (float)((t - prev) / LAT_BATCH);
+        prev = t;
+    }
+    arg->elapsed_ns = now_ns() - t0;
+    arg->sink = acc;
+    return NULL;
+}
+
+static int cmp_float(const void *a, const void *b) 
+{
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+static int cmp_double(const void *a, const void *b) 
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void run(int nthreads, int api, worker_arg *args, float *all_lat) 
+{
+    pthread_t threads[MAX_THREADS];
+    pthread_barrier_init(&g_start, NULL, (unsigned)nthreads);
+    for (int t = 0; t < nthreads; t++) 
+    {
+        memset(&args[t], 0, sizeof(args[t]));
+        args[t].api = api;
+        args[t].ops = (API_UUID == api) ? OPS_PER_THREAD / 16 : OPS_PER_THREAD;
+        args[t].lat = all_lat + (size_t)t * LAT_SAMPLES;
+        pthread_create(&threads[t], NULL, worker, &args[t]);
+    }
+    for (int t = 0; t < nthreads; t++) 
+    {
+        pthread_join(threads[t], NULL);
+    }
+    pthread_barrier_destroy(&g_start);
+
+    // Threads run in lockstep from the barrier; throughput is total work over the slowest thread.
+    double slowest = 0.0, ops = 0.0;
+    double first[MAX_THREADS];
+    size_t nlat = 0;
+    for (int t = 0; t < nthreads; t++) 
+    {
+        slowest = args[t].elapsed_ns > slowest ? args[t].elapsed_ns : slowest;
+        ops += args[t].ops;
+        first[t] = args[t].first_call_ns;
+        // Compact each thread's samples to the front for one global sort.
+        size_t n = args[t].ops / LAT_BATCH;
+        memmove(all_lat + nlat, args[t].lat, n * sizeof(float));
+        nlat += n;
+    }
+    qsort(first, (size_t)nthreads, sizeof(double), cmp_double);
+    qsort(all_lat, nlat, sizeof(float), cmp_float);
+
+    double mops = ops / slowest * 1e3;
+    printf("%-12s %8d %12.1f %12.1f %10.0f %10.0f %9.2f %9.2f %9.2f\n",
+           g_api_names[api], nthreads, mops, mops / nthreads,
+           first[nthreads / 2], first[nthreads - 1],
+           all_lat[nlat / 2], all_lat[(size_t)(nlat * 0.99)], all_lat[(size_t)(nlat * 0.999)]);
+}
+
+int main(int argc, char **argv) 
+{
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = (argc > 1) ? atoi(argv[1]) : (int)(ncpu > 0 ? ncpu : 1);
+    if (max_threads < 1 || max_threads > MAX_THREADS) 
+    {
+        max_threads = MAX_THREADS;
+    }
+
+    static worker_arg args[MAX_THREADS];
+    float *lat = (float*)malloc(sizeof(float) * LAT_SAMPLES * (size_t)max_threads);
+    if (!lat) 
+    {
+        fprintf(stderr, "bench: out of memory\n");
+        return 1;
+    }
+
+#ifndef BENCH_BUILD
+#   define BENCH_BUILD "static"
+#endif
+    const char *build = BENCH_BUILD;
+    printf("=> TLS global API scaling (%s build, %ld CPUs, latency averaged over %d calls).\n",
+           build, ncpu, LAT_BATCH);
+    printf("%-12s %8s %12s %12s %10s %10s %9s %9s %9s\n",
+           "api", "threads", "Mops/s", "Mops/s/thr", "seed p50", "seed max", "ns p50", "ns p99", "ns p999");
+    for (int api = 0; api < API_COUNT; api++) 
+    {
+        for (int n = 1; n <= max_threads; n *= 2) 
+        {
+            run(n, api, args, lat);
+        }
+    }
+    free(lat);
+    return 0;
+}
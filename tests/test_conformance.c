@@ -0,0 +1,646 @@
+#define ZRAND_IMPLEMENTATION
+#define ZRAND_BUFFERED
+#define ZRAND_SHARED
+#define ZRAND_LOGITS
+#include "zrand.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+// Bit-exact conformance. Every deterministic engine/API is run from a set of
+// edge seeds; the first outputs and an FNV-1a digest of the first N outputs
+// must match the golden table below, which was produced by the scalar build
+// (ZRAND_NO_SIMD). `make test_conformance` compiles this file once per backend
+// (scalar, default, AVX2, AVX-512; select with ZRAND_BACKENDS=...) so
+// each SIMD path is checked against the same reference on one machine.
+// Backends the CPU cannot run are skipped.
+//
+// Floating-point APIs that go through libm/zmath (gaussian, noise, samplers)
+// are not bit-exact across math libraries and are covered by tolerance tests
+// in test_main.c instead. Logit sampling is included: its weights come from
+// zrand's own exp polynomial, summed in the same order by every backend, so
+// each build must pick the same tokens.
+//
+// After an intentional sequence change, regenerate the table with
+//   ./tests/runner_conformance_scalar --emit
+
+#ifndef ZRAND_BACKEND_NAME
+#   define ZRAND_BACKEND_NAME "default"
+#endif
+
+#define TEST(name) printf("[TEST] %-35s", name);
+#define PASS() printf(" \033[0;32mPASS\033[0m\n")
+
+#define CONF_N 4096
+
+typedef void (*conf_fn)(uint64_t seed, uint64_t seq, uint32_t *out, size_t n);
+
+typedef struct 
+{
+    const char *name;
+    conf_fn fn;
+} conf_case;
+
+typedef struct 
+{
+    const char *name;
+    int seed_index;
+    uint32_t first[4];
+    uint64_t digest;
+} conf_vector;
+
+static const uint64_t g_seeds[][2] = 
+{
+    { 42ULL, 54ULL },                                  // PCG reference demo.
+    { 0ULL, 0ULL },
+    { UINT64_MAX, UINT64_MAX },
+    { 1ULL, 0x7FFFFFFFFFFFFFFFULL },
+    { 0x853C49E6748FEA9BULL, 0xDA3E39CB94B95BDBULL },  // zrand's unseeded default.
+};
+#define NSEEDS (sizeof(g_seeds) / sizeof(g_seeds[0]))
+
+// Engines and APIs.
+
+static void c_u32(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    zrand_rng r;
+    zrand_rng_init(&r, seed, seq);
+    for (size_t i = 0; i < n; i++) 
+    {
+        out[i] = zrand_rng_u32(&r);
+    }
+}
+
+static void c_u64(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    zrand_rng r;
+    zrand_rng_init(&r, seed, seq);
+    for (size_t i = 0; i + 1 < n; i += 2) 
+    {
+        uint64_t v = zrand_rng_u64(&r);
+        out[i] = (uint32_t)v;
+        out[i + 1] = (uint32_t)(v >> 32);
+    }
+}
+
+static void c_range(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    zrand_rng r;
+    zrand_rng_init(&r, seed, seq);
+    for (size_t i = 0; i < n; i++) 
+    {
+        // Small, odd and full-width spans exercise every rejection path.
+        switch (i % 3) 
+        {
+            case 0:  out[i] = (uint32_t)zrand_rng_range(&r, 0, 6); break;
+            case 1:  out[i] = (uint32_t)zrand_rng_range(&r, -1000, 1000); break;
+            default: out[i] = (uint32_t)zrand_rng_range(&r, INT32_MIN, INT32_MAX); break;
+        }
+    }
+}
+
+static void c_float(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    zrand_rng r;
+    zrand_rng_init(&r, seed, seq);
+    for (size_t i = 0; i + 1 < n; i += 4) 
+    {
+        float f = zrand_rng_f32(&r);
+        float g = zrand_rng_range_f(&r, -3.5f, 7.25f);
+        double d = zrand_rng_f64(&r);
+        memcpy(&out[i], &f, 4);
+        if (i + 3 < n) 
+        {
+            memcpy(&out[i + 1], &g, 4);
+            memcpy(&out[i + 2], &d, 8);
+        }
+    }
+}
+
+static void c_bool(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    zrand_rng r;
+    zrand_rng_init(&r, seed, seq);
+    for (size_t i = 0; i < n; i++) 
+    {
+        out[i] = (uint32_t)zrand_rng_bool(&r) | ((uint32_t)zrand_rng_chance(&r, 0.25) << 1);
+    }
+}
+
+static void c_bytes(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    zrand_rng r;
+    zrand_rng_init(&r, seed, seq);
+    uint8_t *p = (uint8_t*)out;
+    size_t len = n * 4, done = 0;
+    // Chunks of 1..7 bytes hit the tail handling.
+    for (size_t k = 1; done < len; k = k % 7 + 1) 
+    {
+        size_t c = (len - done < k) ? len - done : k;
+        zrand_rng_bytes(&r, p + done, c);
+        done += c;
+    }
+}
+
+static void c_shuffle(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    zrand_rng r;
+    zrand_rng_init(&r, seed, seq);
+    for (size_t i = 0; i < n; i++) 
+    {
+        out[i] = (uint32_t)(i % 64);
+    }
+    for (size_t i = 0; i + 64 <= n; i += 64) 
+    {
+        zrand_rng_shuffle(&r, out + i, 64, sizeof(uint32_t));
+    }
+}
+
+static void c_advance(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    zrand_rng r;
+    zrand_rng_init(&r, seed, seq);
+    for (size_t i = 0; i < n; i++) 
+    {
+        zrand_rng_advance(&r, (uint64_t)i * 0x9E3779B97F4A7C15ULL);
+        out[i] = zrand_rng_u32(&r);
+    }
+}
+
+static void c_partition(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    zrand_rng base, r;
+    zrand_rng_init(&base, seed, seq);
+    for (size_t i = 0; i < n; i++) 
+    {
+        r = base;
+        zrand_rng_partition(&r, i % 13, 13, (i & 1) ? 0 : 1000003);
+        out[i] = zrand_rng_u32(&r);
+    }
+}
+
+static void c_leapfrog(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    zrand_rng r;
+    zrand_leapfrog lf;
+    zrand_rng_init(&r, seed, seq);
+    zrand_leapfrog_init(&lf, &r, 2, 5);
+    for (size_t i = 0; i < n; i++) 
+    {
+        out[i] = zrand_leapfrog_u32(&lf);
+    }
+}
+
+static void c_bank(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    // 37 lanes: full AVX-512/AVX2 blocks plus a scalar tail.
+    enum { LANES = 37 };
+    zrand_rng_bank bank;
+    uint32_t tmp[LANES];
+    uint8_t mask[LANES];
+    bool ok = zrand_rng_bank_init(&bank, LANES, seed ^ seq, seq & 1);
+    assert(ok);
+    (void)ok;
+    for (size_t i = 0; i < LANES; i++) 
+    {
+        mask[i] = (uint8_t)(i % 3 != 0);
+        tmp[i] = 0;
+    }
+    for (size_t i = 0; i < n;) 
+    {
+        switch ((i / LANES) % 3) 
+        {
+            case 0:  zrand_rng_bank_u32(&bank, tmp); break;
+            case 1:  zrand_rng_bank_f32(&bank, (float*)tmp); break;
+            default: zrand_rng_bank_u32_masked(&bank, mask, tmp); break;
+        }
+        for (size_t l = 0; l < LANES && i < n; l++, i++) 
+        {
+            out[i] = tmp[l];
+        }
+    }
+    zrand_rng_bank_free(&bank);
+}
+
+static void c_bank_lanes(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    (void)seq;
+    zrand_rng_bank bank;
+    bool ok = zrand_rng_bank_init(&bank, 8, seed, true);
+    assert(ok);
+    (void)ok;
+    for (size_t i = 0; i < n; i++) 
+    {
+        out[i] = zrand_rng_bank_lane_u32(&bank, (i * 5) % 8);
+    }
+    zrand_rng_bank_free(&bank);
+}
+
+static void c_buffer_lanes(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    // The ZRAND_BUFFERED refill kernel, fed from explicit lane states.
+    uint64_t state[ZRAND_BUFFER_LANES], inc[ZRAND_BUFFER_LANES];
+    for (size_t l = 0; l < ZRAND_BUFFER_LANES; l++) 
+    {
+        zrand_rng r;
+        zrand_rng_init(&r, seed, seq + l);
+        state[l] = r.state;
+        inc[l] = r.inc;
+    }
+    zrand__pcg32_lanes(state, inc, out, n - n % ZRAND_BUFFER_LANES);
+}
+
+static void c_mcg(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    zrand_mcg m;
+    zrand_mcg_init(&m, seed ^ seq);
+    for (size_t i = 0; i < n; i++) 
+    {
+        out[i] = (i & 1) ? zrand_mcg_u32(&m) : (uint32_t)zrand_mcg_range(&m, -50, 50);
+    }
+}
+
+static void c_tiny(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    zrand_tiny t;
+    zrand_tiny_init(&t, (uint32_t)(seed ^ (seed >> 32) ^ seq));
+    for (size_t i = 0; i < n; i++) 
+    {
+        out[i] = (i & 1) ? zrand_tiny_u16(&t) : (uint32_t)zrand_tiny_range(&t, 0, 99);
+    }
+}
+
+static void c_hash(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    enum { B = 256 };
+    int32_t x[B], y[B], z[B];
+    zrand_rng r;
+    zrand_rng_init(&r, seed, seq);
+    uint32_t s = (uint32_t)seed;
+    for (size_t i = 0; i < n; i += B) 
+    {
+        size_t m = (n - i < B) ? n - i : B;
+        for (size_t k = 0; k < m; k++) 
+        {
+            x[k] = (int32_t)zrand_rng_u32(&r);
+            y[k] = (int32_t)k - 100;
+            z[k] = (int32_t)(i + k);
+        }
+        switch ((i / B) % 4) 
+        {
+            case 0:  zrand_hash_u32_batch(s, x, out + i, m); break;
+            case 1:  zrand_hash2_u32_batch(s, x, y, out + i, m); break;
+            case 2:  zrand_hash3_u32_batch(s, x, y, z, out + i, m); break;
+            default: zrand_hash2_f32_grid(s, x[0] >> 8, -7, m, 1, (float*)(out + i)); break;
+        }
+    }
+}
+
+static void c_hash_tail(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    // Lengths 1..43 and grid widths 1..19: every SIMD tail and grids that
+    // straddle INT32_MAX.
+    enum { B = 43 };
+    int32_t x[B], y[B], z[B];
+    zrand_rng r;
+    zrand_rng_init(&r, seed, seq);
+    uint32_t s = (uint32_t)(seed >> 32);
+    for (size_t i = 0, len = 1; i < n; i += len, len = len % B + 1) 
+    {
+        size_t m = (n - i < len) ? n - i : len;
+        for (size_t k = 0; k < m; k++) 
+        {
+            x[k] = (int32_t)zrand_rng_u32(&r);
+            y[k] = (int32_t)zrand_rng_u32(&r);
+            z[k] = (int32_t)k;
+        }
+        switch (len % 4) 
+        {
+            case 0:  zrand_hash_u32_batch(s, x, out + i, m); break;
+            case 1:  zrand_hash2_u32_batch(s, x, y, out + i, m); break;
+            case 2:  zrand_hash3_u32_batch(s, x, y, z, out + i, m); break;
+            default: zrand_hash2_f32_grid(s, INT32_MAX - (int32_t)(len % 11), y[0], m % 19 + 1, m / (m % 19 + 1), (float*)(out + i)); break;
+        }
+    }
+}
+
+static void c_shared(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    zrand_shared sh;
+    zrand_shared_cursor cur;
+    zrand_shared_init(&sh, seed ^ seq);
+    zrand_shared_cursor_init(&cur, &sh, 16);
+    for (size_t i = 0; i + 1 < n; i += 2) 
+    {
+        uint64_t v = (i & 2) ? zrand_shared_u64(&sh) : zrand_shared_cursor_u64(&cur);
+        out[i] = (uint32_t)v;
+        out[i + 1] = (uint32_t)(v >> 32);
+    }
+}
+
+static void c_logits(uint64_t seed, uint64_t seq, uint32_t *out, size_t n) 
+{
+    // 1003 logits: several walk blocks, full vector blocks and a tail.
+    enum { V = 1003 };
+    static float logits[V];
+    zrand_rng r;
+    zrand_rng_init(&r, seed, seq);
+    for (size_t i = 0; i < n; i++) 
+    {
+        if (0 == i % 256) 
+        {
+            for (size_t k = 0; k < V; k++) 
+            {
+                logits[k] = (k % 97 == 5) ? -INFINITY : zrand_rng_range_f(&r, -6.0f, 6.0f);
+            }
+        }
+        switch (i % 4) 
+        {
+            case 0:  out[i] = (uint32_t)zrand_sample_logits(&r, logits, V, 1.0f, 0, 1.0f); break;
+            case 1:  out[i] = (uint32_t)zrand_sample_logits(&r, logits, V, 0.7f, 40, 1.0f); break;
+            case 2:  out[i] = (uint32_t)zrand_sample_logits(&r, logits, V, 1.3f, 0, 0.9f); break;
+            default: out[i] = (uint32_t)zrand_sample_logits(&r, logits, 13 + i % 11, 0.5f, 0, 0.3f); break;
+        }
+    }
+}
+
+static const conf_case g_cases[] = 
+{
+    { "rng_u32",      c_u32 },
+    { "rng_u64",      c_u64 },
+    { "rng_range",    c_range },
+    { "rng_float",    c_float },
+    { "rng_bool",     c_bool },
+    { "rng_bytes",    c_bytes },
+    { "rng_shuffle",  c_shuffle },
+    { "rng_advance",  c_advance },
+    { "partition",    c_partition },
+    { "leapfrog",     c_leapfrog },
+    { "bank",         c_bank },
+    { "bank_lanes",   c_bank_lanes },
+    { "buffer_lanes", c_buffer_lanes },
+    { "mcg",          c_mcg },
+    { "tiny",         c_tiny },
+    { "hash",         c_hash },
+    { "hash_tail",    c_hash_tail },
+    { "shared",       c_shared },
+    { "logits",       c_logits },
+};
+#define NCASES (sizeof(g_cases) / sizeof(g_cases[0]))
+
+static uint64_t fnv1a(const uint32_t *v, size_t n) 
+{
+    uint64_t h = 0xCBF29CE484222325ULL;
+    const uint8_t *p = (const uint8_t*)v;
+    for (size_t i = 0; i < n * 4; i++) 
+    {
+        h = (h ^ p[i]) * 0x100000001B3ULL;
+    }
+    return h;
+}
+
+// Golden vectors (scalar reference).
+static const conf_vector g_golden[] = 
+{
+// CONFORMANCE_VECTORS_BEGIN
+    { "rng_u32", 0, { 0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293 }, 0x6f3803b1c09a1b0cULL },
+    { "rng_u32", 1, { 0xe4c14788, 0x379c6516, 0x5c4ab3bb, 0x601d23e0 }, 0x7cc2fc7a897b7a61ULL },
+    { "rng_u32", 2, { 0x2675c047, 0x7779a837, 0xa145aa13, 0x5f6be726 }, 0x16417bcae3be59f0ULL },
+    { "rng_u32", 3, { 0xfff00001, 0x44726f5c, 0xcbd39f38, 0x9e250255 }, 0xa453a9620ffa7b1fULL },
+    { "rng_u32", 4, { 0x1bbeb4f2, 0xe82e89e9, 0x681cfdeb, 0xe00fa2ec }, 0xbc971be8649bc099ULL },
+    { "rng_u64", 0, { 0x7b47f409, 0xa15c02b7, 0x83d2f293, 0xba1d3330 }, 0xe0ddc4673fa3e510ULL },
+    { "rng_u64", 1, { 0x379c6516, 0xe4c14788, 0x601d23e0, 0x5c4ab3bb }, 0x66b030b059a8b719ULL },
+    { "rng_u64", 2, { 0x7779a837, 0x2675c047, 0x5f6be726, 0xa145aa13 }, 0xbebe0cf01bc93a14ULL },
+    { "rng_u64", 3, { 0x44726f5c, 0xfff00001, 0x9e250255, 0xcbd39f38 }, 0xf8b79dd47e4ccea3ULL },
+    { "rng_u64", 4, { 0xe82e89e9, 0x1bbeb4f2, 0xe00fa2ec, 0x681cfdeb }, 0xbf1d10868f5266c1ULL },
+    { "rng_range", 0, { 0x00000004, 0xffffffdb, 0xba1d3330, 0x00000003 }, 0x9dfcf4289436e96eULL },
+    { "rng_range", 1, { 0x00000006, 0xfffffdca, 0x5c4ab3bb, 0x00000002 }, 0x41e40db60e57e2faULL },
+    { "rng_range", 2, { 0x00000001, 0xffffffbd, 0xa145aa13, 0x00000002 }, 0x6aba519ebf028c18ULL },
+    { "rng_range", 3, { 0x00000006, 0xfffffe2f, 0xcbd39f38, 0x00000004 }, 0xece85c2c7ce6b134ULL },
+    { "rng_range", 4, { 0x00000000, 0x0000032e, 0x681cfdeb, 0x00000006 }, 0x1bfa8260a0ad363cULL },
+    { "rng_float", 0, { 0x3f215c02, 0x3fd6a2c0, 0x66107a5e, 0x3fe743a6 }, 0x0db756e7e5fd31b3ULL },
+    { "rng_float", 1, { 0x3f64c147, 0xbf951762, 0xeed80748, 0x3fd712ac }, 0x35fc3fff4ec9ad73ULL },
+    { "rng_float", 2, { 0x3e19d700, 0x3fc22de8, 0x426bed7c, 0x3fe428b5 }, 0xbc0f6585676f10b8ULL },
+    { "rng_float", 3, { 0x3f7ff000, 0xbf2031d8, 0xe713c4a0, 0x3fe97a73 }, 0xb66318c751fbaba6ULL },
+    { "rng_float", 4, { 0x3dddf5a0, 0x40c7fe88, 0x7af803e8, 0x3fda073f }, 0xadc89e77616d3588ULL },
+    { "rng_bool", 0, { 0x00000001, 0x00000001, 0x00000001, 0x00000002 }, 0x7e430834e0bc5525ULL },
+    { "rng_bool", 1, { 0x00000002, 0x00000002, 0x00000001, 0x00000001 }, 0x8f0a9623b8783af7ULL },
+    { "rng_bool", 2, { 0x00000001, 0x00000000, 0x00000001, 0x00000000 }, 0xa18d94af1a359f35ULL },
+    { "rng_bool", 3, { 0x00000001, 0x00000001, 0x00000000, 0x00000000 }, 0xff1834e4cb838e44ULL },
+    { "rng_bool", 4, { 0x00000000, 0x00000000, 0x00000000, 0x00000001 }, 0xee978bd7a75e9234ULL },
+    { "rng_bytes", 0, { 0x30f409b7, 0xf2931d33, 0x784b83d2, 0xad6ebfa4 }, 0x72c6da77a17f72f2ULL },
+    { "rng_bytes", 1, { 0xbb651688, 0x23e04ab3, 0x2b8c601d, 0x2d161c38 }, 0x63c730165551fa51ULL },
+    { "rng_bytes", 2, { 0x13a83747, 0xe72645aa, 0x44c55f6b, 0x13d6523c }, 0xf436eda817c7bcecULL },
+    { "rng_bytes", 3, { 0x386f5c01, 0x0255d39f, 0x303a9e25, 0xbcf8463f }, 0xcc23b7bd296f2c70ULL },
+    { "rng_bytes", 4, { 0xeb89e9f2, 0xa2ec1cfd, 0xa434e00f, 0x948db1e1 }, 0x523441ec88ef85a3ULL },
+    { "rng_shuffle", 0, { 0x00000014, 0x0000002f, 0x00000013, 0x00000002 }, 0x25e762c1eb330035ULL },
+    { "rng_shuffle", 1, { 0x00000025, 0x00000009, 0x0000001d, 0x00000000 }, 0xe17c5ce3c1123ba5ULL },
+    { "rng_shuffle", 2, { 0x00000002, 0x0000000a, 0x00000031, 0x00000026 }, 0xb11677f7458c9cf5ULL },
+    { "rng_shuffle", 3, { 0x0000002e, 0x00000018, 0x0000000a, 0x0000000e }, 0x4b96574a003df7e5ULL },
+    { "rng_shuffle", 4, { 0x0000001c, 0x00000033, 0x00000018, 0x00000024 }, 0x0963d3c9bc3aebb5ULL },
+    { "rng_advance", 0, { 0xa15c02b7, 0xecb8c4d0, 0x1cd0ebce, 0xa7b364f4 }, 0xb778f929efc4d403ULL },
+    { "rng_advance", 1, { 0xe4c14788, 0x1eb66348, 0x15872731, 0x2244799e }, 0x26baa58d757a4749ULL },
+    { "rng_advance", 2, { 0x2675c047, 0xb6c4f688, 0x1ecd8972, 0xe9b337fa }, 0x345a56a85da87c73ULL },
+    { "rng_advance", 3, { 0xfff00001, 0x9934d4e2, 0xb1fa33fa, 0x33935554 }, 0xf9dbc78c1673bca6ULL },
+    { "rng_advance", 4, { 0x1bbeb4f2, 0x23a2ecd6, 0x0f7e2160, 0xc62c33ad }, 0x1c89478285bbb9f0ULL },
+    { "partition", 0, { 0xa15c02b7, 0x5d3ba120, 0x16e0e93e, 0x3b4979c8 }, 0x9721a39a4c19eccbULL },
+    { "partition", 1, { 0xe4c14788, 0x7bdf8717, 0x63c518e8, 0x97c3a211 }, 0x548434307319e692ULL },
+    { "partition", 2, { 0x2675c047, 0xec4535fd, 0x70f8322d, 0xde0396f1 }, 0xfdefb6ac28ec6d92ULL },
+    { "partition", 3, { 0xfff00001, 0x9b9a3c34, 0xb216623c, 0x50d5c20e }, 0x2b73a0eb79d6809dULL },
+    { "partition", 4, { 0x1bbeb4f2, 0x02e55d66, 0x2ca323c9, 0x3117cab0 }, 0x2c42f1552f6a67c0ULL },
+    { "leapfrog", 0, { 0xba1d3330, 0x812fff6d, 0xed786826, 0x84da65e3 }, 0xc7113ba86332cda6ULL },
+    { "leapfrog", 1, { 0x5c4ab3bb, 0x92014a6e, 0x81c851dc, 0x51f04d1b }, 0xf60e351895903d93ULL },
+    { "leapfrog", 2, { 0xa145aa13, 0x8e3d51a0, 0x85e92559, 0xd987bcd8 }, 0xa195c74637f972d9ULL },
+    { "leapfrog", 3, { 0xcbd39f38, 0xb40ae933, 0x27388392, 0x271d3d2f }, 0x724100a34db0cc95ULL },
+    { "leapfrog", 4, { 0x681cfdeb, 0x9f1b63f5, 0x58ce0bbf, 0x03385db6 }, 0xd7e33545539096c9ULL },
+    { "bank", 0, { 0x29152e70, 0xe6d72e30, 0x1ead9254, 0xbd248567 }, 0xfcfa91755a88403bULL },
+    { "bank", 1, { 0xe4c14788, 0xb790ec05, 0xe1497466, 0xf5954c8f }, 0x4e76e57a46da94c9ULL },
+    { "bank", 2, { 0xc0c7e2c5, 0x60c3cb58, 0xf3a103a0, 0x7cab7d6f }, 0x5c7cd2a5db753487ULL },
+    { "bank", 3, { 0x925563d9, 0x254d175b, 0x472fef1f, 0x280e5bb0 }, 0xeaff75f0a4ce40e4ULL },
+    { "bank", 4, { 0x73a6a25e, 0xf217d79c, 0xec0654f1, 0xf0317f9f }, 0x1e6414871b9759e3ULL },
+    { "bank_lanes", 0, { 0xccfe45fc, 0x6e4797b6, 0x8f0e3f2a, 0x092ecdea }, 0x49737565f61102edULL },
+    { "bank_lanes", 1, { 0xc0c7e2c5, 0x28230272, 0xf3a103a0, 0x2ee1df8d }, 0x9c62c70aed04546fULL },
+    { "bank_lanes", 2, { 0x5413a003, 0x07ad2c13, 0x60f9004a, 0x14257bb3 }, 0xb6d75035184c4f40ULL },
+    { "bank_lanes", 3, { 0x80941f58, 0x590073f7, 0x031fd8ba, 0xae5d4f24 }, 0xb0c25663eddd5a13ULL },
+    { "bank_lanes", 4, { 0x91a52953, 0xd66f9ed9, 0x39be6a8f, 0x9e7878ad }, 0xef86d04148e26452ULL },
+    { "buffer_lanes", 0, { 0xa15c02b7, 0xadd2c78f, 0x42ba67b2, 0x5a42b557 }, 0x5c20e352fe25a144ULL },
+    { "buffer_lanes", 1, { 0xe4c14788, 0x0f5deba9, 0x7aa10266, 0xb2723db7 }, 0xd56f3f104128c6c9ULL },
+    { "buffer_lanes", 2, { 0x2675c047, 0x00000000, 0xe2393051, 0xc9828f91 }, 0x864e21483f671349ULL },
+    { "buffer_lanes", 3, { 0xfff00001, 0xe2393051, 0xc9828f91, 0x0f5deba9 }, 0x14f4118f237a3790ULL },
+    { "buffer_lanes", 4, { 0x1bbeb4f2, 0x288dcafd, 0xf9363463, 0x01c09005 }, 0xacfeef6193222b21ULL },
+    { "mcg", 0, { 0xfffffff3, 0xa6f5d726, 0xffffffdf, 0x18365a3a }, 0x5c3fee6f541fc032ULL },
+    { "mcg", 1, { 0xffffffd4, 0x6c47b1e8, 0xffffffe1, 0xf3c669ac }, 0xd8fd49cf62c24401ULL },
+    { "mcg", 2, { 0xffffffd4, 0x6c47b1e8, 0xffffffe1, 0xf3c669ac }, 0xd8fd49cf62c24401ULL },
+    { "mcg", 3, { 0xfffffff9, 0x3d0315af, 0x00000024, 0x861b965c }, 0x2eaf1df9c96e84e9ULL },
+    { "mcg", 4, { 0xffffffed, 0xd35204bb, 0x00000009, 0xd8adc3fc }, 0xceef60de7c64fd40ULL },
+    { "tiny", 0, { 0x0000000b, 0x0000e55f, 0x00000054, 0x0000f97d }, 0x499a2a80484c9891ULL },
+    { "tiny", 1, { 0x00000028, 0x00000754, 0x0000005b, 0x000024c3 }, 0xe0265d0c931eb77aULL },
+    { "tiny", 2, { 0x00000052, 0x00009d99, 0x00000007, 0x000019a6 }, 0x72d53b6904914675ULL },
+    { "tiny", 3, { 0x0000002e, 0x0000b42a, 0x00000063, 0x000000e0 }, 0xd463afe7092ff2e1ULL },
+    { "tiny", 4, { 0x00000025, 0x0000dd3a, 0x0000001b, 0x00001047 }, 0x702e0d9b37bafaefULL },
+    { "hash", 0, { 0xf86dad2c, 0xbfda2d19, 0xe5df4a2a, 0xa3e5cd82 }, 0xab43be32cdb3c34aULL },
+    { "hash", 1, { 0x430342b4, 0xcf62141a, 0x88cba897, 0x836bee99 }, 0xdde987e09d60bcd8ULL },
+    { "hash", 2, { 0xdb68af5c, 0xb34fca9a, 0x5fe83e48, 0x38cf7020 }, 0xc4b05f6c34de3a8dULL },
+    { "hash", 3, { 0x2594410c, 0xc20369b5, 0x3749dcde, 0x18cc0c37 }, 0xf182931037b14f49ULL },
+    { "hash", 4, { 0x1a21f3c1, 0x7c3b8b72, 0x8cc27aba, 0x8b94cae5 }, 0x277d7946bd1601dbULL },
+    { "hash_tail", 0, { 0x0bf4e54d, 0xb27a9f13, 0xefb44aea, 0x00000000 }, 0x93c47f97c50779e4ULL },
+    { "hash_tail", 1, { 0x39ece801, 0x199bd2bc, 0xa73fafff, 0x00000000 }, 0xcdbb841dad6ea686ULL },
+    { "hash_tail", 2, { 0xa89f9ce2, 0x84aed09a, 0x1497f23e, 0x00000000 }, 0x7348cc2db79ee61dULL },
+    { "hash_tail", 3, { 0x82d16ce3, 0x86aae661, 0x249b0805, 0x00000000 }, 0x17a6362d88037abcULL },
+    { "hash_tail", 4, { 0x3adc97dd, 0x95d54a68, 0xe53603cb, 0x00000000 }, 0xbcbdd770d2f9bab6ULL },
+    { "shared", 0, { 0x292dd280, 0x09d677c3, 0x24be9653, 0x14cc175b }, 0x4f8ec321d4f53d95ULL },
+    { "shared", 1, { 0xf399fe1e, 0x75679b0f, 0x35afe8d5, 0x385e00b2 }, 0x42f222cc5439fa23ULL },
+    { "shared", 2, { 0xf399fe1e, 0x75679b0f, 0x35afe8d5, 0x385e00b2 }, 0x42f222cc5439fa23ULL },
+    { "shared", 3, { 0x8cc9e027, 0x7a022556, 0x1a54ce7d, 0xe16a9e85 }, 0x927e6d96bc5e5725ULL },
+    { "shared", 4, { 0x53df5565, 0xa2990093, 0x588d5076, 0x2c1fe490 }, 0xf6209b44b4023bb3ULL },
+    { "logits", 0, { 0x000002d5, 0x0000034d, 0x00000368, 0x0000000a }, 0x627050891e018f62ULL },
+    { "logits", 1, { 0x00000077, 0x00000228, 0x000000f4, 0x0000000c }, 0xccbc8b9a63d9fc53ULL },
+    { "logits", 2, { 0x00000282, 0x00000152, 0x00000398, 0x00000007 }, 0x92f1e602640bf119ULL },
+    { "logits", 3, { 0x000000cb, 0x000000c8, 0x000001a9, 0x00000000 }, 0xc59c4d8b6017908dULL },
+    { "logits", 4, { 0x00000137, 0x0000034d, 0x0000013f, 0x00000001 }, 0xa2228fd08574dd95ULL },
+// CONFORMANCE_VECTORS_END
+};
+
+static bool backend_supported(void) 
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+#   if defined(__AVX512F__)
+    if (!__builtin_cpu_supports("avx512f") || !__builtin_cpu_supports("avx512dq") || !__builtin_cpu_supports("avx512vl")) 
+    {
+        return false;
+    }
+#   endif
+#   if defined(__AVX2__)
+    if (!__builtin_cpu_supports("avx2")) 
+    {
+        return false;
+    }
+#   endif
+#endif
+    return true;
+}
+
+static const char *compiled_kernel(void) 
+{
+#if defined(ZRAND__AVX512)
+    return "avx512";
+#elif defined(ZRAND__AVX2)
+    return "avx2";
+#else
+    return "scalar";
+#endif
+}
+
+void test_pcg_reference(void) 
+{
+    TEST("PCG32 Reference Outputs (42, 54)");
+    // From the pcg-c reference demo (pcg32_srandom_r(&rng, 42u, 54u)).
+    static const uint32_t expect[6] = { 0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e };
+    zrand_rng r;
+    zrand_rng_init(&r, 42ULL, 54ULL);
+    for (int i = 0; i < 6; i++) 
+    {
+        assert(zrand_rng_u32(&r) == expect[i]);
+    }
+    PASS();
+}
+
+void test_soa_kernel(void) 
+{
+    TEST("SoA Kernel vs Scalar Step");
+    // Every length 0..67 covers full vector blocks and each tail size.
+    zrand_rng seeder;
+    zrand_rng_init(&seeder, 7ULL, 11ULL);
+    for (size_t n = 0; n < 68; n++) 
+    {
+        uint64_t st[68], ref[68], inc[68];
+        uint32_t out[68];
+        for (size_t i = 0; i < n; i++) 
+        {
+            st[i] = ref[i] = zrand_rng_u64(&seeder);
+            inc[i] = zrand_rng_u64(&seeder) | 1u;
+        }
+        for (int shared = 0; shared < 2; shared++) 
+        {
+            zrand__pcg32_soa(st, shared ? NULL : inc, 0x14057B7EF767814FULL, out, n);
+            for (size_t i = 0; i < n; i++) 
+            {
+                assert(out[i] == zrand__pcg32_step(&ref[i], shared ? 0x14057B7EF767814FULL : inc[i]));
+                assert(st[i] == ref[i]);
+            }
+        }
+    }
+    PASS();
+}
+
+void test_golden_vectors(void) 
+{
+    TEST("Golden Vectors (all engines/APIs)");
+    static uint32_t buf[CONF_N];
+    size_t checked = 0;
+    for (size_t c = 0; c < NCASES; c++) 
+    {
+        for (size_t s = 0; s < NSEEDS; s++) 
+        {
+            memset(buf, 0, sizeof(buf));
+            g_cases[c].fn(g_seeds[s][0], g_seeds[s][1], buf, CONF_N);
+            uint64_t h = fnv1a(buf, CONF_N);
+            for (size_t g = 0; g < sizeof(g_golden) / sizeof(g_golden[0]); g++) 
+            {
+                const conf_vector *v = &g_golden[g];
+                if (strcmp(v->name, g_cases[c].name) || v->seed_index != (int)s) 
+                {
+                    continue;
+                }
+                if (memcmp(v->first, buf, sizeof(v->first)) || v->digest != h) 
+                {
+                    printf("\n  mismatch: %s seed #%zu (digest %016llx, expected %016llx)\n",
+                           v->name, s, (unsigned long long)h, (unsigned long long)v->digest);
+                    assert(0 && "conformance mismatch");
+                }
+                checked++;
+            }
+        }
+    }
+    assert(checked == NCASES * NSEEDS);
+    PASS();
+}
+
+static void emit(void) 
+{
+    static uint32_t buf[CONF_N];
+    for (size_t c = 0; c < NCASES; c++) 
+    {
+        for (size_t s = 0; s < NSEEDS; s++) 
+        {
+            memset(buf, 0, sizeof(buf));
+            g_cases[c].fn(g_seeds[s][0], g_seeds[s][1], buf, CONF_N);
+            printf("    { \"%s\", %zu, { 0x%08x, 0x%08x, 0x%08x, 0x%08x }, 0x%016llxULL },\n",
+                   g_cases[c].name, s, buf[0], buf[1], buf[2], buf[3], (unsigned long long)fnv1a(buf, CONF_N));
+        }
+    }
+}
+
+int main(int argc, char **argv) 
+{
+    if (argc > 1 && 0 == strcmp(argv[1], "--emit")) 
+    {
+        emit();
+        return 0;
+    }
+    printf("=> Running tests (zrand.h, conformance: %s build, %s kernels).\n", ZRAND_BACKEND_NAME, compiled_kernel());
+    if (!backend_supported()) 
+    {
+        printf("=> Skipped: this CPU cannot run the %s build.\n", ZRAND_BACKEND_NAME);
+        return 0;
+    }
+    test_pcg_reference();
+    test_soa_kernel();
+    test_golden_vectors();
+    printf("=> All tests passed successfully.\n");
+    return 0;
+}
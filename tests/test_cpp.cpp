@@ -2,6 +2,7 @@
 #include <cstdint>
 #include <limits>
 #define ZRAND_IMPLEMENTATION
+#define ZRAND_PARALLEL
 #include "zrand.h"
 
 #include <iostream>
@@ -75,6 +76,44 @@ void test_generator_class()
     int r = gen1.range(100, 200);
     assert(r >= 100 && r <= 200);
 
+    // Full parity with the global shortcuts.
+    z_rand::generator gen3(7), gen4(7);
+    assert(gen3.uuid() == gen4.uuid());
+    assert(gen3.string(12) == gen4.string(12));
+    assert(gen3.f32() == gen4.f32());
+    assert(gen3.range(0.5f, 1.5f) == gen4.range(0.5f, 1.5f));
+
+    std::vector<int> a = {1, 2, 3, 4, 5, 6, 7, 8};
+    std::vector<int> b = a;
+    gen3.shuffle(a);
+    gen4.shuffle(b);
+    assert(a == b);
+    assert(gen3.choice(a) == gen4.choice(b));
+
+    PASS();
+}
+
+void test_parallel_for() 
+{
+    TEST("Parallel For (Lambda)");
+
+    std::vector<double> a(10000), b(10000);
+    z_rand::parallel_for(a.size(), 256, 5, [&](size_t begin, size_t end, zrand_rng *rng) 
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            a[i] = zrand_rng_gaussian(rng, 0.0, 1.0);
+        }
+    }, 1);
+    z_rand::parallel_for(b.size(), 256, 5, [&](size_t begin, size_t end, zrand_rng *rng) 
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            b[i] = zrand_rng_gaussian(rng, 0.0, 1.0);
+        }
+    }, 4);
+    assert(a == b);
+
     PASS();
 }
 
@@ -84,6 +123,7 @@ int main()
     test_cpp_wrappers();
     test_stl_integration();
     test_generator_class();
+    test_parallel_for();
     std::cout << "=> All tests passed successfully.\n";
     return 0;
 }
@@ -1,11 +1,26 @@
 
 #define ZRAND_IMPLEMENTATION
 #define ZRAND_SHORT_NAMES
+#define ZRAND_PRODUCER
+#define ZRAND_PARALLEL
+#define ZRAND_SHARED
+#define ZRAND_NOISE
+#define ZRAND_SAMPLING
+#define ZRAND_PATHS
+#define ZRAND_MMAP_STREAM
+#define ZRAND_LOGITS
+// `make test_plain` builds without the instrumentation hooks.
+#ifndef ZRAND_TEST_NO_INSTRUMENTATION
+#   define ZRAND_STATS
+#   define ZRAND_TRACE
+#endif
 #include "zrand.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <math.h>
 
 #define TEST(name) printf("[TEST] %-35s", name);
 #define PASS() printf(" \033[0;32mPASS\033[0m\n")
@@ -30,6 +45,25 @@ void test_basic_gen(void)
     PASS();
 }
 
+void test_local_handle(void) 
+{
+    TEST("Thread-Local Handle");
+
+    zrand_rng *local = rand_local();
+    assert(local != NULL);
+    assert(local == rand_local());
+
+    // Draws through the handle advance the global stream.
+    zrand_rng snapshot = *local;
+    uint32_t expected = zrand_rng_u32(&snapshot);
+    assert(zrand_rng_u32(local) == expected);
+#ifndef ZRAND_BUFFERED
+    assert(rand_u32() == zrand_rng_u32(&snapshot));
+#endif
+
+    PASS();
+}
+
 void test_range(void) 
 {
     TEST("Range (Integer & Float)");
@@ -97,13 +131,1107 @@ void test_determinism(void)
     PASS();
 }
 
+void test_jump_ahead(void) 
+{
+    TEST("Jump-Ahead & Leapfrog");
+
+    zrand_rng ref, jumped;
+    zrand_rng_init(&ref, 2024ULL, 11ULL);
+    jumped = ref;
+
+    uint32_t stream[64];
+    for (int i = 0; i < 64; i++) 
+    {
+        stream[i] = zrand_rng_u32(&ref);
+    }
+
+    // advance(k) lands exactly k outputs ahead; advance(-k) steps back.
+    zrand_rng_advance(&jumped, 40);
+    assert(zrand_rng_u32(&jumped) == stream[40]);
+    zrand_rng_advance(&jumped, (uint64_t)-21);
+    assert(zrand_rng_u32(&jumped) == stream[20]);
+
+    // Block partition.
+    zrand_rng_init(&ref, 2024ULL, 11ULL);
+    zrand_rng part = ref;
+    zrand_rng_partition(&part, 3, 4, 16);
+    assert(zrand_rng_u32(&part) == stream[48]);
+
+    // Leapfrog: rank 1 of 4 sees outputs 1, 5, 9, ...
+    zrand_leapfrog lf;
+    zrand_leapfrog_init(&lf, &ref, 1, 4);
+    for (int i = 1; i < 64; i += 4) 
+    {
+        assert(zrand_leapfrog_u32(&lf) == stream[i]);
+    }
+
+    PASS();
+}
+
+void test_rng_bank(void) 
+{
+    TEST("Generator Bank (SoA)");
+
+    enum { LANES = 37 };
+    zrand_rng_bank bank;
+    uint32_t out[LANES];
+    zrand_rng ref[LANES];
+    zrand_rng lane, base;
+
+    // Per-lane streams match standalone generators on stream `i`.
+    assert(zrand_rng_bank_init(&bank, LANES, 55ULL, true));
+    for (int i = 0; i < LANES; i++) 
+    {
+        zrand_rng_bank_get(&bank, (size_t)i, &ref[i]);
+        zrand_rng_init(&lane, 0, (uint64_t)i);
+        assert(ref[i].inc == lane.inc);
+    }
+    for (int step = 0; step < 3; step++) 
+    {
+        zrand_rng_bank_u32(&bank, out);
+        for (int i = 0; i < LANES; i++) 
+        {
+            assert(out[i] == zrand_rng_u32(&ref[i]));
+        }
+    }
+
+    // Masked step leaves unselected lanes alone.
+    uint8_t mask[LANES];
+    for (int i = 0; i < LANES; i++) 
+    {
+        mask[i] = (uint8_t)(i % 3 == 0);
+        out[i] = 0xDEADBEEF;
+    }
+    zrand_rng_bank_u32_masked(&bank, mask, out);
+    for (int i = 0; i < LANES; i++) 
+    {
+        assert(out[i] == (mask[i] ? zrand_rng_u32(&ref[i]) : 0xDEADBEEF));
+    }
+    assert(zrand_rng_bank_lane_u32(&bank, 1) == zrand_rng_u32(&ref[1]));
+    zrand_rng_bank_free(&bank);
+
+    // Shared stream: lane i starts i * S outputs in, S odd in [2^63 / count, 2^64 / count).
+    assert(zrand_rng_bank_init(&bank, 4, 55ULL, false));
+    zrand_rng_init(&base, 55ULL, 0);
+    zrand_rng_bank_get(&bank, 2, &lane);
+    uint64_t half = 1ULL << 61;
+    zrand_rng_advance(&base, 2 * ((half + 0x9E3779B97F4A7C15ULL % half) | 1));
+    assert(lane.state == base.state);
+
+    // The same bank over caller storage, started from a generator.
+    uint64_t storage[4];
+    zrand_rng_bank shared;
+    zrand_rng_init(&base, 55ULL, 0);
+    zrand_rng_bank_init_shared(&shared, storage, 4, &base);
+    for (size_t i = 0; i < 4; i++) 
+    {
+        zrand_rng a, b;
+        zrand_rng_bank_get(&bank, i, &a);
+        zrand_rng_bank_get(&shared, i, &b);
+        assert(a.state == b.state && a.inc == b.inc);
+    }
+
+    float f[4];
+    zrand_rng_bank_f32(&bank, f);
+    for (int i = 0; i < 4; i++) 
+    {
+        assert(f[i] >= 0.0f && f[i] < 1.0f);
+    }
+    zrand_rng_bank_free(&bank);
+
+    PASS();
+}
+
+void test_compact_generators(void) 
+{
+    TEST("Compact Generators (8B / 4B)");
+
+    assert(sizeof(zrand_mcg) == 8);
+    assert(sizeof(zrand_tiny) == 4);
+
+    zrand_mcg m1, m2;
+    zrand_mcg_init(&m1, 9ULL);
+    zrand_mcg_init(&m2, 9ULL);
+    zrand_tiny t1, t2;
+    zrand_tiny_init(&t1, 9u);
+    zrand_tiny_init(&t2, 9u);
+
+    for (int i = 0; i < 100; i++) 
+    {
+        assert(zrand_mcg_u32(&m1) == zrand_mcg_u32(&m2));
+        assert(zrand_tiny_u16(&t1) == zrand_tiny_u16(&t2));
+    }
+
+    int hist[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 4000; i++) 
+    {
+
+        int32_t r = zrand_mcg_range(&m1, -3, 3);
+        assert(r >= -3 && r <= 3);
+        float f = zrand_mcg_f32(&m1);
+        assert(f >= 0.0f && f < 1.0f);
+
+        int32_t tr = zrand_tiny_range(&t1, 0, 3);
+        assert(tr >= 0 && tr <= 3);
+        hist[tr]++;
+        float tf = zrand_tiny_f32(&t1);
+        assert(tf >= 0.0f && tf < 1.0f);
+    }
+    for (int i = 0; i < 4; i++) 
+    {
+        assert(hist[i] > 800 && hist[i] < 1200);
+    }
+
+    PASS();
+}
+
+void test_coordinate_hash(void) 
+{
+    TEST("Coordinate Hashing");
+
+    // Order-independent and repeatable.
+    assert(zrand_hash2_u32(7, -5, 12) == zrand_hash2_u32(7, -5, 12));
+    assert(zrand_hash2_u32(7, -5, 12) != zrand_hash2_u32(7, 12, -5));
+    assert(zrand_hash3_u32(7, 1, 2, 3) != zrand_hash3_u32(8, 1, 2, 3));
+    (void)zrand_hash4_u32(7, 1, 2, 3, 4);
+
+    int32_t xs[100], ys[100];
+    uint32_t out[100];
+    int hist[6] = {0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < 100; i++) 
+    {
+        xs[i] = i - 50;
+        ys[i] = i * 3;
+    }
+    zrand_hash2_u32_batch(7, xs, ys, out, 100);
+    for (int i = 0; i < 100; i++) 
+    {
+        assert(out[i] == zrand_hash2_u32(7, xs[i], ys[i]));
+    }
+    zrand_hash_u32_batch(7, xs, out, 100);
+    assert(out[10] == zrand_hash_u32(7, xs[10]));
+
+    float grid[24 * 3];
+    zrand_hash2_f32_grid(7, -4, 9, 24, 3, grid);
+    assert(grid[2 * 24 + 5] == zrand_hash2_f32(7, 1, 11));
+    // Grids crossing INT32_MAX wrap to INT32_MIN.
+    zrand_hash2_f32_grid(7, INT32_MAX - 1, INT32_MAX, 4, 2, grid);
+    assert(grid[2] == zrand_hash2_f32(7, INT32_MIN, INT32_MAX));
+    assert(grid[4 + 3] == zrand_hash2_f32(7, INT32_MIN + 1, INT32_MIN));
+
+    for (int i = 0; i < 6000; i++) 
+    {
+        int32_t r = zrand_hash_to_range(zrand_hash_u32(1, i), 1, 6);
+        assert(r >= 1 && r <= 6);
+        hist[r - 1]++;
+        float f = zrand_hash3_f32(1, i, 0, -i);
+        assert(f >= 0.0f && f < 1.0f);
+    }
+    for (int i = 0; i < 6; i++) 
+    {
+        assert(hist[i] > 850 && hist[i] < 1150);
+    }
+
+    PASS();
+}
+
+void test_noise(void) 
+{
+    TEST("Noise (Simplex, Value, fBm)");
+
+    zrand_rng rng;
+    zrand_noise a, b;
+    zrand_rng_init(&rng, 31337ULL, 1ULL);
+    zrand_noise_init(&a, &rng);
+    zrand_rng_init(&rng, 31337ULL, 1ULL);
+    zrand_noise_init(&b, &rng);
+    assert(0 == memcmp(&a, &b, sizeof(a)));
+
+    float lo = 0.0f, hi = 0.0f;
+    for (int i = 0; i < 20000; i++) 
+    {
+        float x = (i % 200) * 0.173f - 17.0f;
+        float y = (i / 200) * 0.191f - 9.0f;
+        float v[7] = 
+        {
+            zrand_noise_simplex2(&a, x, y),
+            zrand_noise_simplex3(&a, x, y, 0.37f * x),
+            zrand_noise_simplex4(&a, x, y, 1.5f, -0.25f * y),
+            zrand_noise_value2(&a, x, y),
+            zrand_noise_value3(&a, x, y, 2.5f),
+            zrand_noise_value4(&a, x, y, 2.5f, -1.25f),
+            zrand_noise_fbm3(&a, x, y, 0.5f, 4, 2.0f, 0.5f)
+        };
+        for (int k = 0; k < 7; k++) 
+        {
+            assert(v[k] >= -1.1f && v[k] <= 1.1f);
+            lo = v[k] < lo ? v[k] : lo;
+            hi = v[k] > hi ? v[k] : hi;
+        }
+    }
+    assert(lo < -0.5f && hi > 0.5f);
+
+    // Value noise interpolates the lattice exactly.
+    assert(zrand_noise_value2(&a, 3.0f, 4.0f) == a.values[a.perm[3 + a.perm[4]]]);
+
+    // Grid (SIMD when available) agrees with the scalar path.
+    enum { W = 37, H = 5 };
+    float grid[W * H];
+    zrand_noise_simplex2_grid(&a, -3.3f, 1.7f, 0.13f, W, H, grid);
+    for (int j = 0; j < H; j++) 
+    {
+        for (int i = 0; i < W; i++) 
+        {
+            float ref = zrand_noise_simplex2(&a, -3.3f + i * 0.13f, 1.7f + j * 0.13f);
+            assert(fabsf(grid[j * W + i] - ref) < 1e-4f);
+        }
+    }
+    zrand_noise_fbm2_grid(&a, -3.3f, 1.7f, 0.13f, W, H, 5, 2.0f, 0.5f, grid);
+    for (int i = 0; i < W; i++) 
+    {
+        float ref = zrand_noise_fbm2(&a, -3.3f + i * 0.13f, 1.7f, 5, 2.0f, 0.5f);
+        assert(fabsf(grid[i] - ref) < 1e-3f);
+    }
+
+    PASS();
+}
+
+void test_instance_parity(void) 
+{
+    TEST("Instance API Parity");
+
+    zrand_rng rng1, rng2;
+    zrand_rng_init(&rng1, 777ULL, 3ULL);
+    zrand_rng_init(&rng2, 777ULL, 3ULL);
+
+    for (int i = 0; i < 1000; i++) 
+    {
+        float f = zrand_rng_f32(&rng1);
+        assert(f >= 0.0f && f < 1.0f);
+        float rf = zrand_rng_range_f(&rng1, -2.0f, 2.0f);
+        assert(rf >= -2.0f && rf < 2.0f);
+        (void)zrand_rng_bool(&rng1);
+        (void)zrand_rng_chance(&rng1, 0.5);
+    }
+    assert(zrand_rng_chance(&rng1, 1.0));
+    assert(!zrand_rng_chance(&rng1, 0.0));
+
+    // Utilities must be reproducible from the same seed.
+    char a[37], b[37];
+    zrand_rng_init(&rng1, 777ULL, 3ULL);
+
+    zrand_rng_uuid(&rng1, a);
+    zrand_rng_uuid(&rng2, b);
+    assert(0 == strcmp(a, b));
+    assert(a[14] == '4');
+
+    zrand_rng_str(&rng1, a, 20);
+    zrand_rng_str(&rng2, b, 20);
+    assert(0 == strcmp(a, b) && strlen(a) == 20);
+
+    int v1[32], v2[32];
+    for (int i = 0; i < 32; i++) 
+    {
+        v1[i] = v2[i] = i;
+    }
+    zrand_rng_shuffle(&rng1, v1, 32, sizeof(int));
+    zrand_rng_shuffle(&rng2, v2, 32, sizeof(int));
+    assert(0 == memcmp(v1, v2, sizeof(v1)));
+
+    int *p1 = (int*)zrand_rng_choice(&rng1, v1, 32, sizeof(int));
+    int *p2 = (int*)zrand_rng_choice(&rng2, v2, 32, sizeof(int));
+    assert(*p1 == *p2);
+
+    PASS();
+}
+
+void test_poisson_disk(void) 
+{
+    TEST("Poisson Disk / Blue Noise");
+
+    enum { MAXP = 4096 };
+    static float a[MAXP * 3], b[MAXP * 3];
+    zrand_rng rng;
+
+    for (int tile = 0; tile < 2; tile++) 
+    {
+        zrand_rng_init(&rng, 99ULL, 3ULL);
+        size_t n = zrand_poisson2(&rng, 64.0f, 48.0f, 2.0f, 30, tile, a, MAXP);
+        zrand_rng_init(&rng, 99ULL, 3ULL);
+        assert(n == zrand_poisson2(&rng, 64.0f, 48.0f, 2.0f, 30, tile, b, MAXP));
+        assert(0 == memcmp(a, b, n * 2 * sizeof(float)));
+        // Maximal packing of r = 2 fills 64x48 with a few hundred points.
+        assert(n > 250);
+        for (size_t i = 0; i < n; i++) 
+        {
+            assert(a[2 * i] >= 0.0f && a[2 * i] < 64.0f && a[2 * i + 1] >= 0.0f && a[2 * i + 1] < 48.0f);
+            for (size_t j = i + 1; j < n; j++) 
+            {
+                float dx = fabsf(a[2 * i] - a[2 * j]);
+                float dy = fabsf(a[2 * i + 1] - a[2 * j + 1]);
+                if (tile) 
+                {
+                    dx = dx > 32.0f ? 64.0f - dx : dx;
+                    dy = dy > 24.0f ? 48.0f - dy : dy;
+                }
+                assert(dx * dx + dy * dy >= 4.0f * 0.9999f);
+            }
+        }
+    }
+
+    zrand_rng_init(&rng, 5ULL, 1ULL);
+    size_t n3 = zrand_poisson3(&rng, 10.0f, 10.0f, 10.0f, 1.5f, 0, a, MAXP);
+    assert(n3 > 100);
+    for (size_t i = 0; i < n3; i++) 
+    {
+        for (size_t j = i + 1; j < n3; j++) 
+        {
+            float dx = a[3 * i] - a[3 * j], dy = a[3 * i + 1] - a[3 * j + 1], dz = a[3 * i + 2] - a[3 * j + 2];
+            assert(dx * dx + dy * dy + dz * dz >= 2.25f * 0.9999f);
+        }
+    }
+    assert(5 == zrand_poisson2(&rng, 64.0f, 64.0f, 1.0f, 30, false, a, 5));
+
+    // Blue-noise mask: every rank appears exactly once.
+    enum { S = 16 };
+    float mask[S * S];
+    uint8_t seen[S * S] = {0};
+    zrand_rng_init(&rng, 7ULL, 7ULL);
+    assert(zrand_blue_noise_mask(&rng, S, mask));
+    for (int i = 0; i < S * S; i++) 
+    {
+        int r = (int)(mask[i] * (S * S) + 0.5f);
+        assert(r >= 0 && r < S * S && !seen[r]);
+        seen[r] = 1;
+    }
+    // The lowest 1/8 of ranks are spread out: no two are adjacent.
+    for (int i = 0; i < S * S; i++) 
+    {
+        if (mask[i] >= 0.125f) 
+        {
+            continue;
+        }
+        int x = i % S, y = i / S;
+        assert(mask[y * S + (x + 1) % S] >= 0.125f);
+        assert(mask[((y + 1) % S) * S + x] >= 0.125f);
+    }
+    PASS();
+}
+
+void test_geometric_samplers(void) 
+{
+    TEST("Geometric Samplers (Disk..Mesh)");
+
+    enum { N = 20000 };
+    static float xs[N], ys[N], zs[N];
+    static uint32_t tris[N];
+    zrand_rng rng, ref;
+    zrand_rng_init(&rng, 404ULL, 9ULL);
+
+    // Disk: inside, and uniform by area (half the mass within r = 1/sqrt(2)).
+    zrand_rng_disk_batch(&rng, xs, ys, N);
+    int inner = 0;
+    for (int i = 0; i < N; i++) 
+    {
+        float r2 = xs[i] * xs[i] + ys[i] * ys[i];
+        assert(r2 <= 1.0001f);
+        inner += r2 < 0.5f;
+    }
+    assert(abs(inner - N / 2) < N / 50);
+
+    // Sphere: unit length, mean near zero, uniform z.
+    zrand_rng_sphere_batch(&rng, xs, ys, zs, N);
+    double mx = 0, mz = 0; int upper = 0;
+    for (int i = 0; i < N; i++) 
+    {
+        assert(fabsf(xs[i] * xs[i] + ys[i] * ys[i] + zs[i] * zs[i] - 1.0f) < 1e-4f);
+        mx += xs[i]; mz += zs[i];
+        upper += zs[i] > 0.5f;
+    }
+    assert(fabs(mx / N) < 0.02 && fabs(mz / N) < 0.02);
+    assert(abs(upper - N / 4) < N / 50);
+
+    // Ball: half the volume lies within r = 0.5^(1/3).
+    zrand_rng_ball_batch(&rng, xs, ys, zs, N);
+    inner = 0;
+    for (int i = 0; i < N; i++) 
+    {
+        float r2 = xs[i] * xs[i] + ys[i] * ys[i] + zs[i] * zs[i];
+        assert(r2 <= 1.0001f);
+        inner += r2 < 0.62996f;
+    }
+    assert(abs(inner - N / 2) < N / 50);
+
+    // Cone: every direction within the half angle of the axis.
+    const float axis[3] = { 0.0f, -0.6f, 0.8f };
+    zrand_rng_cone_batch(&rng, axis, 0.3f, xs, ys, zs, N);
+    for (int i = 0; i < N; i++) 
+    {
+        float d = xs[i] * axis[0] + ys[i] * axis[1] + zs[i] * axis[2];
+        assert(d >= cosf(0.3f) - 1e-4f && d <= 1.0001f);
+    }
+
+    // Single-sample and batch forms consume the stream identically.
+    zrand_rng_init(&rng, 1ULL, 2ULL);
+    ref = rng;
+    float p[3];
+    zrand_rng_circle_batch(&rng, xs, ys, 4);
+    for (int i = 0; i < 4; i++) 
+    {
+        zrand_rng_circle(&ref, p);
+        assert(p[0] == xs[i] && p[1] == ys[i]);
+    }
+
+    // Triangle: barycentric coordinates inside [0, 1].
+    const float a[3] = { 0, 0, 0 }, b[3] = { 4, 0, 0 }, c[3] = { 0, 2, 0 };
+    for (int i = 0; i < 1000; i++) 
+    {
+        zrand_rng_triangle(&rng, a, b, c, p);
+        assert(p[0] >= -1e-5f && p[1] >= -1e-5f && p[0] / 4.0f + p[1] / 2.0f <= 1.0001f);
+    }
+
+    // Mesh: a unit quad (area 1) plus a 3x-area triangle gets a quarter / three quarters.
+    const float verts[] = { 0,0,0, 1,0,0, 1,1,0, 0,1,0,  0,0,5, 3,0,5, 0,2,5 };
+    const uint32_t idx[] = { 0,1,2, 0,2,3, 4,5,6 };
+    zrand_mesh_sampler ms;
+    assert(zrand_mesh_sampler_init(&ms, verts, idx, 3));
+    assert(fabsf(ms.total_area - 4.0f) < 1e-5f);
+    zrand_mesh_sampler_batch(&ms, &rng, xs, ys, zs, tris, N);
+    int big = 0;
+    for (int i = 0; i < N; i++) 
+    {
+        assert((tris[i] == 2) == (zs[i] > 2.5f));
+        big += 2 == tris[i];
+    }
+    assert(abs(big - 3 * N / 4) < N / 50);
+    zrand_mesh_sampler_free(&ms);
+    const float flat[] = { 0,0,0, 1,1,1, 2,2,2 };
+    const uint32_t one[] = { 0,1,2 };
+    assert(!zrand_mesh_sampler_init(&ms, flat, one, 1));
+    PASS();
+}
+
+void test_rotations(void) 
+{
+    TEST("Rotations & Unit Vectors");
+
+    enum { N = 20000 };
+    static float qx[N], qy[N], qz[N], qw[N];
+    zrand_rng rng;
+    zrand_rng_init(&rng, 2718ULL, 5ULL);
+
+    // Quaternions: unit norm, and the rotated +Z axis is uniform on the sphere.
+    zrand_rng_quat_batch(&rng, qx, qy, qz, qw, N);
+    double mz = 0.0; int upper = 0;
+    for (int i = 0; i < N; i++) 
+    {
+        assert(fabsf(qx[i] * qx[i] + qy[i] * qy[i] + qz[i] * qz[i] + qw[i] * qw[i] - 1.0f) < 1e-4f);
+        float z = 1.0f - 2.0f * (qx[i] * qx[i] + qy[i] * qy[i]);
+        mz += z;
+        upper += z > 0.5f;
+    }
+    assert(fabs(mz / N) < 0.02);
+    assert(abs(upper - N / 4) < N / 50);
+
+    float m[9];
+    zrand_rng_rotation3(&rng, m);
+    float det = m[0] * (m[4] * m[8] - m[5] * m[7]) - m[1] * (m[3] * m[8] - m[5] * m[6]) + m[2] * (m[3] * m[7] - m[4] * m[6]);
+    assert(fabsf(det - 1.0f) < 1e-4f);
+
+    // Unit vectors in several dimensions; coordinate mean ~0, E[x_k^2] = 1/dim.
+    for (size_t dim = 1; dim <= 9; dim += 2) 
+    {
+        float v[9];
+        double m1 = 0.0, m2 = 0.0;
+        for (int i = 0; i < 4000; i++) 
+        {
+            zrand_rng_unit_vector(&rng, v, dim);
+            double len = 0.0;
+            for (size_t k = 0; k < dim; k++) 
+            {
+                len += v[k] * v[k];
+            }
+            assert(fabs(len - 1.0) < 1e-4);
+            m1 += v[0];
+            m2 += v[0] * v[0];
+        }
+        assert(fabs(m1 / 4000) < 0.05);
+        assert(fabs(m2 / 4000 - 1.0 / dim) < 0.03);
+    }
+
+    // Orthogonal matrices: Q Q^T = I, and both determinant signs occur.
+    enum { D = 6 };
+    static float q[16 * D * D];
+    zrand_rng_orthogonal_batch(&rng, q, D, 16);
+    for (int n = 0; n < 16; n++) 
+    {
+        const float *a = q + n * D * D;
+        for (int i = 0; i < D; i++) 
+        {
+            for (int j = 0; j < D; j++) 
+            {
+                double d = 0.0;
+                for (int k = 0; k < D; k++) 
+                {
+                    d += a[i * D + k] * a[j * D + k];
+                }
+                assert(fabs(d - (i == j)) < 1e-4);
+            }
+        }
+    }
+    int neg = 0;
+    for (int n = 0; n < 64; n++) 
+    {
+        zrand_rng_orthogonal(&rng, m, 3);
+        det = m[0] * (m[4] * m[8] - m[5] * m[7]) - m[1] * (m[3] * m[8] - m[5] * m[6]) + m[2] * (m[3] * m[7] - m[4] * m[6]);
+        assert(fabsf(fabsf(det) - 1.0f) < 1e-4f);
+        neg += det < 0.0f;
+    }
+    assert(neg > 10 && neg < 54);
+    PASS();
+}
+
+void test_brownian_paths(void) 
+{
+    TEST("Brownian / GBM / Bridge Paths");
+
+    enum { P = 4001, S = 16 };
+    static double a[P * (S + 1)], b[P * (S + 1)];
+    zrand_rng rng;
+
+    // W(T) ~ N(0, T) with T = 16 * 0.25 = 4.
+    zrand_rng_init(&rng, 11ULL, 1ULL);
+    zrand_rng_brownian_paths(&rng, P, S, 0.25, a);
+    double m = 0.0, v = 0.0;
+    for (int p = 0; p < P; p++) 
+    {
+        assert(0.0 == a[p * (S + 1)]);
+        m += a[p * (S + 1) + S];
+        v += a[p * (S + 1) + S] * a[p * (S + 1) + S];
+    }
+    assert(fabs(m / P) < 0.1 && fabs(v / P - 4.0) < 0.3);
+
+    // Layouts transpose the same numbers; antithetic pairs mirror around x0.
+    zrand_path_opts pm = { ZRAND_PATH_MAJOR, true }, tm = { ZRAND_TIME_MAJOR, true };
+    zrand_rng_init(&rng, 12ULL, 1ULL);
+    zrand_rng_brownian_paths_ex(&rng, P, S, 0.1, 1.0, 0.5, 2.0, &pm, a);
+    zrand_rng_init(&rng, 12ULL, 1ULL);
+    zrand_rng_brownian_paths_ex(&rng, P, S, 0.1, 1.0, 0.5, 2.0, &tm, b);
+    for (int p = 0; p < P; p++) 
+    {
+        for (int k = 0; k <= S; k++) 
+        {
+            assert(a[p * (S + 1) + k] == b[k * P + p]);
+        }
+    }
+    for (int p = 0; p + 1 < P; p += 2) 
+    {
+        double drift = 2.0 * (1.0 + 0.5 * 0.1 * S);
+        assert(fabs(a[p * (S + 1) + S] + a[(p + 1) * (S + 1) + S] - drift) < 1e-9);
+    }
+
+    // GBM: positive, E[S_T] = s0 * exp(mu * T).
+    zrand_rng_init(&rng, 13ULL, 1ULL);
+    zrand_rng_gbm_paths(&rng, P, S, 1.0 / S, 100.0, 0.05, 0.2, &pm, a);
+    m = 0.0;
+    for (int p = 0; p < P; p++) 
+    {
+        assert(a[p * (S + 1) + S] > 0.0);
+        m += a[p * (S + 1) + S];
+    }
+    assert(fabs(m / P - 100.0 * exp(0.05)) < 0.5);
+
+    // Bridge: exact endpoints, midpoint variance sigma^2 * T / 4.
+    zrand_rng_init(&rng, 14ULL, 1ULL);
+    zrand_rng_brownian_bridge(&rng, P, S, 0.25, -1.0, 3.0, 1.0, NULL, a);
+    m = 0.0; v = 0.0;
+    for (int p = 0; p < P; p++) 
+    {
+        assert(-1.0 == a[p * (S + 1)]);
+        assert(fabs(a[p * (S + 1) + S] - 3.0) < 1e-12);
+        double mid = a[p * (S + 1) + S / 2] - 1.0;
+        m += mid;
+        v += mid * mid;
+    }
+    assert(fabs(m / P) < 0.05 && fabs(v / P - 1.0) < 0.1);
+
+    // One unit step holds the raw increments: they match libm Box-Muller on
+    // the same draws, and the generator ends where the draws leave it.
+    enum { NZ = 4 * 64 };
+    zrand_path_opts tz = { ZRAND_TIME_MAJOR, false };
+    zrand_rng ref;
+    zrand_rng_init(&rng, 15ULL, 1ULL);
+    ref = rng;
+    zrand_rng_brownian_paths_ex(&rng, NZ, 1, 1.0, 0.0, 0.0, 1.0, &tz, a);
+    for (int i = 0; i < NZ; i += 2) 
+    {
+        double u = ((double)(zrand_rng_u64(&ref) >> 11) + 1.0) * (1.0 / 9007199254740992.0);
+        double t = (double)(zrand_rng_u64(&ref) >> 11) * (6.28318530717958647692 / 9007199254740992.0);
+        double r = sqrt(-2.0 * log(u));
+        assert(fabs(a[NZ + i] - r * cos(t)) < 1e-12 * (1.0 + r));
+        assert(fabs(a[NZ + i + 1] - r * sin(t)) < 1e-12 * (1.0 + r));
+    }
+    assert(zrand_rng_u64(&rng) == zrand_rng_u64(&ref));
+    PASS();
+}
+
+void test_producer_ring(void) 
+{
+    TEST("Producer Ring (SPSC)");
+
+    zrand_ring *ring = zrand_ring_create(8, NULL, NULL);
+    assert(ring != NULL);
+
+    uint64_t acc = 0;
+    for (int i = 0; i < 100000; i++) 
+    {
+        acc ^= zrand_ring_pop_u64(ring);
+        double d = zrand_ring_pop_f64(ring);
+        assert(d >= 0.0 && d < 1.0);
+    }
+    assert(acc != 0);
+
+    zrand_ring_stats st;
+    zrand_ring_get_stats(ring, &st);
+    assert(st.popped + st.fallback == 200000);
+    assert(st.capacity == 8 && st.occupancy <= st.capacity);
+    zrand_ring_destroy(ring);
+
+    // CSPRNG backend.
+    ring = zrand_ring_create(2, zrand_fill_os, NULL);
+    assert(ring != NULL);
+    for (int i = 0; i < 1000; i++) 
+    {
+        (void)zrand_ring_pop_u64(ring);
+    }
+    zrand_ring_destroy(ring);
+
+    PASS();
+}
+
+static void pi_chunk(void *ctx, size_t begin, size_t end, zrand_rng *rng) 
+{
+    uint32_t *hits = (uint32_t*)ctx;
+    for (size_t i = begin; i < end; i++) 
+    {
+        double x = zrand_rng_f64(rng);
+        double y = zrand_rng_f64(rng);
+        hits[i] = (x * x + y * y) < 1.0;
+    }
+}
+
+static void span_chunk(void *ctx, size_t begin, size_t end, zrand_rng *rng) 
+{
+    size_t *spans = (size_t*)ctx;
+    (void)rng;
+    spans[spans[0] * 2 + 1] = begin;
+    spans[spans[0] * 2 + 2] = end;
+    spans[0]++;
+}
+
+void test_parallel_for(void) 
+{
+    TEST("Parallel For (Deterministic)");
+
+    enum { N = 100000 };
+    static uint32_t a[N], b[N], c[N];
+    zrand_parallel_for_ex(N, 1000, 99ULL, pi_chunk, a, 1);
+    zrand_parallel_for_ex(N, 1000, 99ULL, pi_chunk, b, 7);
+    zrand_parallel_for(N, 1000, 99ULL, pi_chunk, c);
+
+    // Bit-identical regardless of thread count.
+    assert(0 == memcmp(a, b, sizeof(a)));
+    assert(0 == memcmp(a, c, sizeof(a)));
+
+    uint32_t hits = 0;
+    for (int i = 0; i < N; i++) 
+    {
+        hits += a[i];
+    }
+    double pi = 4.0 * hits / N;
+    assert(pi > 3.1 && pi < 3.2);
+
+    // Chunk count near SIZE_MAX must not wrap.
+    size_t spans[5] = { 0 };
+    zrand_parallel_for_ex(SIZE_MAX, SIZE_MAX / 2 + 1, 99ULL, span_chunk, spans, 1);
+    assert(2 == spans[0]);
+    assert(0 == spans[1] && SIZE_MAX / 2 + 1 == spans[2]);
+    assert(SIZE_MAX / 2 + 1 == spans[3] && SIZE_MAX == spans[4]);
+
+    PASS();
+}
+
+static zrand_shared g_shared;
+
+static void shared_chunk(void *ctx, size_t begin, size_t end, zrand_rng *rng) 
+{
+    uint64_t *taken = (uint64_t*)ctx;
+    zrand_shared_cursor cur;
+    zrand_shared_cursor_init(&cur, &g_shared, 8);
+    (void)rng;
+    for (size_t i = begin; i < end; i++) 
+    {
+        taken[i] = zrand_shared_cursor_u64(&cur);
+    }
+}
+
+static int cmp_u64(const void *a, const void *b) 
+{
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+void test_shared_generator(void) 
+{
+    TEST("Shared Generator (Lock-Free)");
+
+    // The counter owns a whole cache line.
+    assert(64 == sizeof(zrand_shared));
+    assert(0 == (uintptr_t)&g_shared % 64);
+
+    // Single-threaded: draws follow the indexed sequence.
+    zrand_shared_init(&g_shared, 123ULL);
+    assert(zrand_shared_u64(&g_shared) == zrand_shared_at(&g_shared, 0));
+    uint64_t batch[4];
+    zrand_shared_fill_u64(&g_shared, batch, 4);
+    assert(batch[3] == zrand_shared_at(&g_shared, 4));
+
+    // Concurrent: the multiset of values equals the first N outputs.
+    enum { N = 4096 };
+    static uint64_t taken[N], expect[N];
+    zrand_shared_init(&g_shared, 123ULL);
+    zrand_parallel_for_ex(N, 64, 0, shared_chunk, taken, 4);
+    for (int i = 0; i < N; i++) 
+    {
+        expect[i] = zrand_shared_at(&g_shared, (uint64_t)i);
+    }
+    qsort(taken, N, sizeof(uint64_t), cmp_u64);
+    qsort(expect, N, sizeof(uint64_t), cmp_u64);
+    assert(0 == memcmp(taken, expect, sizeof(taken)));
+
+    PASS();
+}
+
+#ifdef ZRAND_STATS
+
+static void stats_chunk(void *ctx, size_t begin, size_t end, zrand_rng *rng) 
+{
+    (void)ctx;
+    (void)rng;
+    for (size_t i = begin; i < end; i++) 
+    {
+        (void)zrand_u32();
+    }
+}
+
+void test_stats(void) 
+{
+    TEST("Instrumentation Counters");
+    zrand_stats a, b;
+
+    // Half of all draws land in [2^31, 2^32) and are retried; every draw is one step.
+    zrand_rng rng;
+    zrand_rng_init(&rng, 42, 54);
+    zrand_stats_snapshot(&a);
+    for (int i = 0; i < 1000; i++) 
+    {
+        (void)zrand_rng_range(&rng, 0, INT32_MAX);
+    }
+    zrand_stats_snapshot(&b);
+    uint64_t retries = b.range_retries - a.range_retries;
+    assert(retries > 800 && retries < 1200);
+    assert(b.steps - a.steps == 1000 + retries);
+
+    for (int i = 0; i < 5; i++) 
+    {
+        (void)rand_u32();
+    }
+    (void)zrand_chance(0.5);
+    zrand_init();
+    zrand_stats_snapshot(&a);
+    assert(5 == a.calls[ZRAND_API_U32] - b.calls[ZRAND_API_U32]);
+    assert(1 == a.calls[ZRAND_API_CHANCE] - b.calls[ZRAND_API_CHANCE]);
+    assert(a.calls[ZRAND_API_F64] == b.calls[ZRAND_API_F64]);
+    assert(1 == a.reseeds - b.reseeds);
+    assert(a.threads >= 1);
+
+    // Workers exit before zrand_parallel_for returns; their counts are kept.
+    zrand_parallel_for_ex(4000, 100, 0, stats_chunk, NULL, 4);
+    zrand_stats_snapshot(&b);
+    assert(4000 == b.calls[ZRAND_API_U32] - a.calls[ZRAND_API_U32]);
+    assert(b.threads >= a.threads);
+
+    assert(0 == strcmp("zrand_range", zrand_api_name(ZRAND_API_RANGE)));
+
+    PASS();
+}
+
+#endif // ZRAND_STATS
+
+#ifdef ZRAND_TRACE
+
+// One round of mixed global and instance draws; `out` receives the results.
+static void trace_round(uint32_t *out) 
+{
+    char uuid[37];
+    zrand_rng rng;
+    zrand_rng_init(&rng, 7, 7);
+    out[0] = zrand_u32();
+    out[1] = (uint32_t)zrand_range(1, 6);
+    out[2] = (uint32_t)(zrand_gaussian(0.0, 1.0) * 1e6);
+    zrand_uuid(uuid);
+    out[3] = (uint32_t)uuid[0] | (uint32_t)uuid[35] << 8;
+    out[4] = zrand_rng_u32(&rng);
+    out[5] = (uint32_t)(zrand_f64() * 4294967296.0);
+}
+
+void test_trace(void) 
+{
+    TEST("Record / Replay Tracer");
+    const char *path = "tests/trace_test.bin";
+    uint32_t rec[6], rep[6];
+
+    assert(zrand_trace_record(path));
+    assert(!zrand_trace_record(path));
+    trace_round(rec);
+    zrand_trace_stop();
+
+    // A fresh OS seed: live values would differ, replayed ones must not.
+    zrand_init();
+    assert(zrand_trace_replay(path));
+    trace_round(rep);
+    assert(0 == memcmp(rec, rep, sizeof(rec)));
+    assert(0 == zrand_trace_divergences());
+    (void)zrand_u32();
+    assert(1 == zrand_trace_divergences());
+    zrand_trace_stop();
+
+    assert(!zrand_trace_replay("tests/no_such_trace.bin"));
+
+    // Malformed: empty blocks and thread ordinals past the number of blocks
+    // are rejected.
+    static const uint32_t bad[][6] = 
+    {
+        { 1, 8, 0xFFFFFFFFu, 0, 0, 0 },
+        { 1, 8, 5, 1, 0x1234, 0 },
+        { 1, 8, 0x7FFFFFFFu, 1, 0x1234, 0 },
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) 
+    {
+        FILE *f = fopen(path, "wb");
+        assert(f);
+        fwrite("ZRTRACE1", 1, 8, f);
+        fwrite(bad[i], sizeof(uint32_t), 0 == i ? 4 : 6, f);
+        fclose(f);
+        assert(!zrand_trace_replay(path));
+    }
+
+    // Bound streams replay by tag, not by first-draw order: record tags 7
+    // then 3, replay 3 then 7.
+    assert(!zrand_trace_bind(0x80000000u));
+    assert(zrand_trace_record(path));
+    assert(zrand_trace_bind(7));
+    uint32_t a = zrand_u32();
+    assert(zrand_trace_bind(3));
+    uint32_t b = zrand_u32();
+    zrand_trace_stop();
+    zrand_init();
+    assert(zrand_trace_replay(path));
+    assert(zrand_trace_bind(3));
+    assert(b == zrand_u32());
+    assert(zrand_trace_bind(7));
+    assert(a == zrand_u32());
+    assert(zrand_trace_bind(9));
+    (void)zrand_u32();
+    assert(1 == zrand_trace_divergences());
+    zrand_trace_stop();
+    remove(path);
+
+    PASS();
+}
+
+#endif // ZRAND_TRACE
+
+void test_mmap_stream(void) 
+{
+    TEST("Recorded mmap Stream");
+    const char *path = "tests/stream_test.bin";
+    zrand_mmap_stream s;
+
+    assert(!zrand_mmap_stream_write(path, ZRAND_MMAP_PCG, 7, 0));
+    assert(zrand_mmap_stream_write(path, ZRAND_MMAP_PCG, 7, 10000));
+    assert(zrand_mmap_stream_open(&s, path, true));
+    assert(10000 == s.count && 7 == s.seed && ZRAND_MMAP_PCG == s.engine);
+
+    // The file replays zrand_rng_u64 of (seed, 0), then wraps to the start.
+    zrand_rng rng;
+    zrand_rng_init(&rng, 7, 0);
+    uint64_t first = zrand_rng_u64(&rng);
+    assert(first == zrand_mmap_stream_next_u64(&s));
+    for (int i = 1; i < 10000; i++) 
+    {
+        assert(zrand_rng_u64(&rng) == zrand_mmap_stream_next_u64(&s));
+    }
+    assert(first == zrand_mmap_stream_next_u64(&s) && 1 == s.wraps);
+
+    uint64_t buf[3];
+    zrand_mmap_stream_seek(&s, 9998);
+    zrand_mmap_stream_fill_u64(&s, buf, 3);
+    assert(buf[2] == first && 2 == s.wraps && 1 == s.pos);
+    double u = zrand_mmap_stream_next_f64(&s);
+    assert(u >= 0.0 && u < 1.0);
+    zrand_mmap_stream_close(&s);
+
+    // OS streams are only reproducible through the file.
+    assert(zrand_mmap_stream_write(path, ZRAND_MMAP_OS, 0, 64));
+    assert(zrand_mmap_stream_open(&s, path, false));
+    assert(64 == s.count && ZRAND_MMAP_OS == s.engine);
+    zrand_mmap_stream_close(&s);
+
+    // A truncated file no longer covers its declared count.
+    assert(zrand_mmap_stream_write(path, ZRAND_MMAP_PCG, 1, 4));
+    FILE *f = fopen(path, "rb");
+    uint8_t img[96];
+    assert(96 == fread(img, 1, sizeof(img), f));
+    fclose(f);
+    f = fopen(path, "wb");
+    fwrite(img, 1, 88, f);
+    fclose(f);
+    assert(!zrand_mmap_stream_open(&s, path, false));
+    assert(NULL == s.map);
+    remove(path);
+    assert(!zrand_mmap_stream_open(&s, "tests/no_such_stream.bin", false));
+
+    PASS();
+}
+
+static void logits_freq(zrand_rng *rng, const float *logits, size_t n, size_t top_k, float top_p, int draws, double *freq) 
+{
+    memset(freq, 0, n * sizeof(double));
+    for (int i = 0; i < draws; i++) 
+    {
+        size_t k = zrand_sample_logits(rng, logits, n, 1.0f, top_k, top_p);
+        assert(k < n);
+        freq[k] += 1.0 / draws;
+    }
+}
+
+void test_sample_logits(void) 
+{
+    TEST("Logit Sampling (top-k, top-p)");
+    zrand_rng rng;
+    zrand_rng_init(&rng, 11, 0);
+
+    // Greedy and single-token calls do not draw.
+    const float tie[4] = { 1.0f, 3.0f, 3.0f, 2.0f };
+    uint64_t state = rng.state;
+    assert(1 == zrand_sample_logits(&rng, tie, 4, 0.0f, 0, 1.0f));
+    assert(0 == zrand_sample_logits(&rng, tie, 1, 0.7f, 0, 1.0f));
+    assert(state == rng.state);
+
+    // Probabilities .05 .4 .3 .15 .1 and a masked token.
+    float small[6] = { logf(0.05f), logf(0.4f), logf(0.3f), logf(0.15f), logf(0.1f), -INFINITY };
+    double f[6];
+    logits_freq(&rng, small, 6, 0, 1.0f, 40000, f);
+    assert(fabs(f[0] - 0.05) < 0.01 && fabs(f[1] - 0.4) < 0.015 && fabs(f[4] - 0.1) < 0.01 && 0.0 == f[5]);
+    logits_freq(&rng, small, 6, 2, 1.0f, 20000, f);
+    assert(fabs(f[1] - 0.4 / 0.7) < 0.015 && 0.0 == f[0] + f[3] + f[4] + f[5]);
+    logits_freq(&rng, small, 6, 0, 0.75f, 20000, f);
+    assert(fabs(f[3] - 0.15 / 0.85) < 0.015 && 0.0 == f[0] + f[4] + f[5]);
+    logits_freq(&rng, small, 6, 3, 0.5f, 20000, f);
+    assert(fabs(f[2] - 0.3 / 0.7) < 0.015 && 0.0 == f[0] + f[3] + f[4] + f[5]);
+
+    // A nucleus of the argmax alone: the cutoff bound lies above every logit.
+    const float flat[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    for (int i = 0; i < 100; i++) 
+    {
+        assert(0 == zrand_sample_logits(&rng, flat, 4, 1.0f, 0, 0.2f));
+    }
+    const float peak[3] = { 0.0f, 0.5f, 0.0f };
+    assert(1 == zrand_sample_logits(&rng, peak, 3, 1.0f, 0, 0.1f));
+
+    // Large vocabularies (the second needs heap scratch): one dominant token.
+    for (size_t n = 50000; n <= 300000; n += 250000) 
+    {
+        float *logits = (float*)malloc(n * sizeof(float));
+        double z = 0.0;
+        for (size_t i = 0; i < n; i++) 
+        {
+            logits[i] = -5.0f * zrand_rng_f32(&rng);
+            z += exp(logits[i]);
+        }
+        logits[n / 3] = 10.0f;
+        z += exp(10.0) - exp(-5.0);
+        double hit = 0.0;
+        for (int i = 0; i < 4000; i++) 
+        {
+            hit += (n / 3 == zrand_sample_logits(&rng, logits, n, 1.0f, 0, 1.0f)) / 4000.0;
+        }
+        assert(fabs(hit - exp(10.0) / z) < 0.03);
+
+        // Every top-p draw lies in the exact nucleus (one token of slack).
+        for (int d = 0; d < 50; d++) 
+        {
+            size_t k = zrand_sample_logits(&rng, logits, n, 1.0f, 0, 0.4f);
+            double above = 0.0;
+            for (size_t i = 0; i < n; i++) 
+            {
+                above += (logits[i] > logits[k]) ? exp(logits[i]) / z : 0.0;
+            }
+            assert(above < 0.4 + 1e-3);
+        }
+        free(logits);
+    }
+
+    // Same seed, same draws.
+    zrand_rng a, b;
+    zrand_rng_init(&a, 5, 5);
+    zrand_rng_init(&b, 5, 5);
+    for (int i = 0; i < 100; i++) 
+    {
+        assert(zrand_sample_logits(&a, small, 6, 0.8f, 0, 0.9f) == zrand_sample_logits(&b, small, 6, 0.8f, 0, 0.9f));
+    }
+
+    PASS();
+}
+
 int main(void) 
 {
     printf("=> Running tests (zrand.h, main).\n");
+#if defined(__AVX2__) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("avx2")) 
+    {
+        printf("=> Skipped: this CPU cannot run the AVX2 build.\n");
+        return 0;
+    }
+#endif
     test_basic_gen();
+    test_local_handle();
     test_range();
     test_utilities();
     test_determinism();
+    test_jump_ahead();
+    test_instance_parity();
+    test_rng_bank();
+    test_compact_generators();
+    test_coordinate_hash();
+    test_noise();
+    test_poisson_disk();
+    test_geometric_samplers();
+    test_rotations();
+    test_brownian_paths();
+    test_producer_ring();
+    test_parallel_for();
+    test_shared_generator();
+#ifdef ZRAND_STATS
+    test_stats();
+#endif
+#ifdef ZRAND_TRACE
+    test_trace();
+#endif
+    test_mmap_stream();
+    test_sample_logits();
     printf("=> All tests passed successfully.\n");
     return 0;
 }
@@ -0,0 +1,677 @@
+
+#define _GNU_SOURCE
+#define ZRAND_IMPLEMENTATION
+#include "zrand.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+// Command-line random data generator.
+//
+//   zrand MODE [--count N] [--seed N] [--threads N] [--binary] [--out FILE]
+//              [--min A --max B] [--mean M --stddev S] [--len N]
+//
+// Modes:
+//   bytes     raw bytes (--count is in bytes)
+//   u32 u64   unsigned integers, one per line (--binary: little-endian words)
+//   f64       doubles in [0, 1), %.17g per line (--binary: IEEE doubles)
+//   range     integers in [--min, --max] (--binary: int32)
+//   gaussian  normal deviates with --mean, --stddev (--binary: doubles)
+//   uuid      UUID v4 strings, one per line
+//   str       alphanumeric strings of --len characters, one per line
+//
+// Output is cut into chunks of about 1 MiB. Chunk k draws from its own
+// generator, zrand_rng_init(mix(seed, k), k), so the output depends on the
+// arguments only, never on --threads (raw words come from a 64-lane bank on
+// that stream, so build with -march=native for the SIMD kernels). Workers
+// fill a ring of chunk slots and the main thread writes them in order:
+// vmsplice() into a pipe (no copy), batched writev() into anything else.
+// With --out and a fixed-width format (binary, uuid, str) the file is sized
+// up front and the workers generate straight into a shared mmap() of it.
+// Without --count output is unbounded.
+
+#define CHUNK_BYTES (1u << 20)
+#define MAX_THREADS 64
+#define MAX_IOV 64
+
+typedef enum { MODE_BYTES, MODE_U32, MODE_U64, MODE_F64, MODE_RANGE, MODE_GAUSSIAN, MODE_UUID, MODE_STR } mode_id;
+
+static const char *g_mode_names[] = { "bytes", "u32", "u64", "f64", "range", "gaussian", "uuid", "str" };
+
+typedef struct 
+{
+    mode_id mode;
+    uint64_t seed;
+    uint64_t count;       // Items (bytes for MODE_BYTES); 0 with `bounded` false.
+    bool bounded;
+    unsigned threads;
+    bool binary;
+    const char *out;
+    int32_t min, max;
+    double mean, stddev;
+    size_t len;
+    size_t width;         // Bytes per item when fixed-width, 0 for text numbers.
+    size_t max_width;     // Upper bound of bytes per item.
+    size_t min_width;     // Lower bound of bytes per item.
+    uint64_t per_chunk;   // Items per chunk.
+    uint64_t nchunks;     // Valid when bounded.
+} options;
+
+// Generation.
+
+static uint64_t mix64(uint64_t z) 
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static char *put_u64(char *p, uint64_t v) 
+{
+    char tmp[20];
+    int n = 0;
+    do 
+    {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n) 
+    {
+        *p++ = tmp[--n];
+    }
+    return p;
+}
+
+static char *put_f64(char *p, double v) 
+{
+    char tmp[32];
+    int n = snprintf(tmp, sizeof(tmp), "%.17g", v);
+    memcpy(p, tmp, (size_t)n);
+    return p + n;
+}
+
+// Raw bytes come from a 64-lane shared-stream bank on the chunk's stream,
+// stepped by the SIMD kernels when compiled for them.
+static void gen_bytes(const zrand_rng *rng, char *dst, size_t len) 
+{
+    enum { LANES = 64 };
+    uint64_t state[LANES];
+    uint32_t tail[LANES];
+    zrand_rng_bank bank;
+    zrand_rng_bank_init_shared(&bank, state, LANES, rng);
+    // Chunks start at multiples of 1 MiB in 4096-byte-aligned memory.
+    for (; len >= sizeof(tail); len -= sizeof(tail), dst += sizeof(tail)) 
+    {
+        zrand_rng_bank_u32(&bank, (uint32_t*)(void*)dst);
+    }
+    if (len) 
+    {
+        zrand_rng_bank_u32(&bank, tail);
+        memcpy(dst, tail, len);
+    }
+}
+
+static uint64_t chunk_items(const options *o, uint64_t k) 
+{
+    if (o->bounded && k == o->nchunks - 1) 
+    {
+        return o->count - k * o->per_chunk;
+    }
+    return o->per_chunk;
+}
+
+// Writes the items of chunk `k` to `dst`; returns the number of bytes.
+static size_t gen_chunk(const options *o, uint64_t k, char *dst) 
+{
+    zrand_rng rng;
+    zrand_rng_init(&rng, mix64(o->seed + (k + 1) * 0x9E3779B97F4A7C15ULL), k);
+    uint64_t n = chunk_items(o, k);
+    char *p = dst;
+
+    if (MODE_BYTES == o->mode || (o->binary && (MODE_U32 == o->mode || MODE_U64 == o->mode))) 
+    {
+        // Raw integer words are the same bit stream as `bytes`.
+        gen_bytes(&rng, dst, (size_t)(n * o->width));
+        return (size_t)(n * o->width);
+    }
+    for (uint64_t i = 0; i < n; i++) 
+    {
+        switch (o->mode) 
+        {
+            case MODE_U32:
+                p = put_u64(p, zrand_rng_u32(&rng));
+                *p++ = '\n';
+                break;
+            case MODE_U64:
+                p = put_u64(p, zrand_rng_u64(&rng));
+                *p++ = '\n';
+                break;
+            case MODE_F64:
+            case MODE_GAUSSIAN:
+            {
+                double v = (MODE_F64 == o->mode) ? zrand_rng_f64(&rng) : zrand_rng_gaussian(&rng, o->mean, o->stddev);
+                if (o->binary) 
+                {
+                    memcpy(p, &v, 8);
+                    p += 8;
+                }
+                else 
+                {
+                    p = put_f64(p, v);
+                    *p++ = '\n';
+                }
+                break;
+            }
+            case MODE_RANGE:
+            {
+                int32_t v = zrand_rng_range(&rng, o->min, o->max);
+                if (o->binary) 
+                {
+                    memcpy(p, &v, 4);
+                    p += 4;
+                }
+                else 
+                {
+                    if (v < 0) 
+                    {
+                        *p++ = '-';
+                    }
+                    p = put_u64(p, (v < 0) ? 0u - (uint64_t)(int64_t)v : (uint64_t)v);
+                    *p++ = '\n';
+                }
+                break;
+            }
+            case MODE_UUID:
+            {
+                char uuid[37];
+                zrand_rng_uuid(&rng, uuid);
+                memcpy(p, uuid, 36);
+                p[36] = '\n';
+                p += 37;
+                break;
+            }
+            case MODE_STR:
+                // zrand_rng_str terminates at p[len], which the newline replaces.
+                zrand_rng_str(&rng, p, o->len);
+                p[o->len] = '\n';
+                p += o->len + 1;
+                break;
+            default:
+                break;
+        }
+    }
+    return (size_t)(p - dst);
+}
+
+// Worker pool over a ring of chunk slots.
+
+enum { SLOT_FREE, SLOT_BUSY, SLOT_READY };
+
+typedef struct 
+{
+    char *buf;
+    size_t len;
+    uint64_t chunk;
+    uint64_t next;        // The only chunk allowed to claim this slot next.
+    uint64_t end;         // Output offset just past this chunk (vmsplice release).
+    int state;
+} slot;
+
+typedef struct 
+{
+    const options *opt;
+    slot *slots;
+    unsigned nslots;
+    char *map;            // mmap mode: workers write here directly.
+    uint64_t next;        // Next chunk to claim.
+    bool stop;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    pthread_cond_t freed;
+} pool;
+
+static bool chunks_left(const pool *pl, uint64_t k) 
+{
+    return !pl->opt->bounded || k < pl->opt->nchunks;
+}
+
+static void *worker(void *arg) 
+{
+    pool *pl = (pool*)arg;
+    pthread_mutex_lock(&pl->lock);
+    while (!pl->stop && chunks_left(pl, pl->next)) 
+    {
+        uint64_t k = pl->next++;
+        if (pl->map) 
+        {
+            pthread_mutex_unlock(&pl->lock);
+            gen_chunk(pl->opt, k, pl->map + k * pl->opt->per_chunk * pl->opt->width);
+            pthread_mutex_lock(&pl->lock);
+            continue;
+        }
+        // Slot k % nslots goes to chunk k only after chunk k - nslots has been
+        // written. Waiting for FREE alone would let chunk k + nslots (on a
+        // faster worker) take it first, and the writer would wait on chunk k
+        // forever.
+        slot *s = &pl->slots[k % pl->nslots];
+        while (!pl->stop && (SLOT_FREE != s->state || s->next != k)) 
+        {
+            pthread_cond_wait(&pl->freed, &pl->lock);
+        }
+        if (pl->stop) 
+        {
+            break;
+        }
+        s->state = SLOT_BUSY;
+        pthread_mutex_unlock(&pl->lock);
+        size_t len = gen_chunk(pl->opt, k, s->buf);
+        pthread_mutex_lock(&pl->lock);
+        s->len = len;
+        s->chunk = k;
+        s->state = SLOT_READY;
+        pthread_cond_broadcast(&pl->ready);
+    }
+    pthread_mutex_unlock(&pl->lock);
+    return NULL;
+}
+
+static void release(pool *pl, slot *s) 
+{
+    pthread_mutex_lock(&pl->lock);
+    s->next = s->chunk + pl->nslots;
+    s->state = SLOT_FREE;
+    pthread_cond_broadcast(&pl->freed);
+    pthread_mutex_unlock(&pl->lock);
+}
+
+// Output.
+
+static int writev_all(int fd, struct iovec *iov, int n) 
+{
+    while (n > 0) 
+    {
+        ssize_t w = writev(fd, iov, n);
+        if (w < 0) 
+        {
+            if (EINTR == errno) 
+            {
+                continue;
+            }
+            return -1;
+        }
+        while (n > 0 && (size_t)w >= iov->iov_len) 
+        {
+            w -= (ssize_t)iov->iov_len;
+            iov++;
+            n--;
+        }
+        if (n > 0) 
+        {
+            iov->iov_base = (char*)iov->iov_base + w;
+            iov->iov_len -= (size_t)w;
+        }
+    }
+    return 0;
+}
+
+// Returns 1 when spliced, 0 when vmsplice does not apply, -1 on error.
+static int vmsplice_all(int fd, const char *buf, size_t len) 
+{
+    while (len > 0) 
+    {
+        struct iovec iov = { (void*)buf, len };
+        ssize_t w = vmsplice(fd, &iov, 1, 0);
+        if (w < 0) 
+        {
+            if (EINTR == errno) 
+            {
+                continue;
+            }
+            return (EINVAL == errno || EBADF == errno) ? 0 : -1;
+        }
+        buf += w;
+        len -= (size_t)w;
+    }
+    return 1;
+}
+
+// Writes chunks in order until the end or a write error. `pipe_size` > 0
+// selects vmsplice: the pipe then references the slot's pages until the
+// reader has consumed them, which is certain once `pipe_size` more bytes
+// have been spliced behind the chunk.
+static int drain(pool *pl, int fd, size_t pipe_size) 
+{
+    uint64_t spliced = 0;
+    uint64_t oldest = 0;    // Oldest chunk still held by the pipe.
+    for (uint64_t k = 0; chunks_left(pl, k); ) 
+    {
+        struct iovec iov[MAX_IOV];
+        int n = 0;
+        pthread_mutex_lock(&pl->lock);
+        for (;;) 
+        {
+            slot *s = &pl->slots[(k + (uint64_t)n) % pl->nslots];
+            bool ready = SLOT_READY == s->state && s->chunk == k + (uint64_t)n;
+            if (ready) 
+            {
+                iov[n].iov_base = s->buf;
+                iov[n].iov_len = s->len;
+                n++;
+            }
+            // Batch what is ready, but never wait once something is.
+            if (n == MAX_IOV || (n > 0 && !ready) || (n > 0 && !chunks_left(pl, k + (uint64_t)n))) 
+            {
+                break;
+            }
+            if (!ready) 
+            {
+                pthread_cond_wait(&pl->ready, &pl->lock);
+            }
+        }
+        pthread_mutex_unlock(&pl->lock);
+
+        int rc = 0;
+        if (pipe_size) 
+        {
+            for (int i = 0; i < n && rc >= 0; i++) 
+            {
+                rc = vmsplice_all(fd, (const char*)iov[i].iov_base, iov[i].iov_len);
+                if (0 == rc) 
+                {
+                    // Not a pipe after all: fall back to copies for the rest.
+                    pipe_size = 0;
+                    rc = writev_all(fd, &iov[i], n - i);
+                    break;
+                }
+                spliced += iov[i].iov_len;
+                pl->slots[(k + (uint64_t)i) % pl->nslots].end = spliced;
+            }
+            if (rc < 0) 
+            {
+                return -1;
+            }
+            k += (uint64_t)n;
+            while (oldest < k && (!pipe_size || pl->slots[oldest % pl->nslots].end + pipe_size <= spliced)) 
+            {
+                release(pl, &pl->slots[oldest % pl->nslots]);
+                oldest++;
+            }
+            continue;
+        }
+        if (writev_all(fd, iov, n) < 0) 
+        {
+            return -1;
+        }
+        for (int i = 0; i < n; i++) 
+        {
+            release(pl, &pl->slots[(k + (uint64_t)i) % pl->nslots]);
+        }
+        k += (uint64_t)n;
+        oldest = k;
+    }
+    return 0;
+}
+
+// Arguments.
+
+static void usage(const char *argv0) 
+{
+    fprintf(stderr,
+            "usage: %s MODE [--count N] [--seed N] [--threads N] [--binary] [--out FILE]\n"
+            "               [--min A --max B] [--mean M --stddev S] [--len N]\n"
+            "modes: bytes u32 u64 f64 range gaussian uuid str\n", argv0);
+}
+
+static bool parse(int argc, char **argv, options *o) 
+{
+    memset(o, 0, sizeof(*o));
+    o->seed = 42;
+    o->min = 0;
+    o->max = 99;
+    o->stddev = 1.0;
+    o->len = 16;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    o->threads = (ncpu > 0) ? (unsigned)ncpu : 1;
+    if (argc < 2) 
+    {
+        return false;
+    }
+    size_t m = 0;
+    while (m < sizeof(g_mode_names) / sizeof(g_mode_names[0]) && 0 != strcmp(argv[1], g_mode_names[m])) 
+    {
+        m++;
+    }
+    if (m == sizeof(g_mode_names) / sizeof(g_mode_names[0])) 
+    {
+        return false;
+    }
+    o->mode = (mode_id)m;
+    for (int i = 2; i < argc; i++) 
+    {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (0 == strcmp(a, "--binary")) 
+        {
+            o->binary = true;
+            continue;
+        }
+        if (!v) 
+        {
+            return false;
+        }
+        i++;
+        if (0 == strcmp(a, "--count")) 
+        {
+            o->count = strtoull(v, NULL, 0);
+            o->bounded = true;
+        }
+        else if (0 == strcmp(a, "--seed")) 
+        {
+            o->seed = strtoull(v, NULL, 0);
+        }
+        else if (0 == strcmp(a, "--threads")) 
+        {
+            o->threads = (unsigned)strtoul(v, NULL, 0);
+        }
+        else if (0 == strcmp(a, "--out")) 
+        {
+            o->out = v;
+        }
+        else if (0 == strcmp(a, "--min")) 
+        {
+            o->min = (int32_t)strtol(v, NULL, 0);
+        }
+        else if (0 == strcmp(a, "--max")) 
+        {
+            o->max = (int32_t)strtol(v, NULL, 0);
+        }
+        else if (0 == strcmp(a, "--mean")) 
+        {
+            o->mean = strtod(v, NULL);
+        }
+        else if (0 == strcmp(a, "--stddev")) 
+        {
+            o->stddev = strtod(v, NULL);
+        }
+        else if (0 == strcmp(a, "--len")) 
+        {
+            o->len = (size_t)strtoull(v, NULL, 0);
+        }
+        else 
+        {
+            return false;
+        }
+    }
+    if (o->threads < 1 || o->threads > MAX_THREADS) 
+    {
+        o->threads = (o->threads < 1) ? 1 : MAX_THREADS;
+    }
+
+    // Fixed item widths; text numbers get an upper bound instead.
+    static const size_t bin_width[] = { 1, 4, 8, 8, 4, 8, 0, 0 };
+    static const size_t text_max[] = { 1, 11, 21, 26, 12, 26, 0, 0 };
+    if (MODE_UUID == o->mode) 
+    {
+        o->width = 37;
+    }
+    else if (MODE_STR == o->mode) 
+    {
+        if (0 == o->len || o->len >= CHUNK_BYTES) 
+        {
+            return false;
+        }
+        o->width = o->len + 1;
+    }
+    else if (MODE_BYTES == o->mode || o->binary) 
+    {
+        o->width = bin_width[o->mode];
+    }
+    o->max_width = o->width ? o->width : text_max[o->mode];
+    o->min_width = o->width ? o->width : 2;
+    o->per_chunk = CHUNK_BYTES / o->max_width;
+    o->nchunks = (o->count + o->per_chunk - 1) / o->per_chunk;
+    return true;
+}
+
+int main(int argc, char **argv) 
+{
+    options opt;
+    if (!parse(argc, argv, &opt)) 
+    {
+        usage(argv[0]);
+        return 2;
+    }
+    if (opt.bounded && 0 == opt.count) 
+    {
+        return 0;
+    }
+    if (opt.out && !opt.bounded) 
+    {
+        fprintf(stderr, "zrand: --out needs --count\n");
+        return 2;
+    }
+
+    // A reader closing the pipe (e.g. `| head -c`) is a normal way to stop.
+    signal(SIGPIPE, SIG_IGN);
+
+    int fd = STDOUT_FILENO;
+    if (opt.out) 
+    {
+        fd = open(opt.out, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) 
+        {
+            perror(opt.out);
+            return 1;
+        }
+    }
+
+    pool pl;
+    memset(&pl, 0, sizeof(pl));
+    pl.opt = &opt;
+    pthread_mutex_init(&pl.lock, NULL);
+    pthread_cond_init(&pl.ready, NULL);
+    pthread_cond_init(&pl.freed, NULL);
+
+    size_t pipe_size = 0;
+    if (opt.out && opt.width) 
+    {
+        // Fixed width: size the file and let the workers fill it in place.
+        uint64_t total = opt.count * opt.width;
+        if (0 != ftruncate(fd, (off_t)total)) 
+        {
+            perror(opt.out);
+            return 1;
+        }
+        pl.map = (char*)mmap(NULL, (size_t)total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (MAP_FAILED == pl.map) 
+        {
+            perror(opt.out);
+            return 1;
+        }
+        madvise(pl.map, (size_t)total, MADV_SEQUENTIAL);
+    }
+    else 
+    {
+        if (!opt.out) 
+        {
+            int sz = fcntl(fd, F_SETPIPE_SZ, (int)CHUNK_BYTES);
+            if (sz <= 0) 
+            {
+                sz = fcntl(fd, F_GETPIPE_SZ);
+            }
+            pipe_size = (sz > 0) ? (size_t)sz : 0;
+        }
+        // Enough slots for every worker plus the chunks a full pipe still holds:
+        // otherwise the worker owed the next chunk would wait on a slot that
+        // is only released once that chunk itself has been written.
+        uint64_t min_chunk = opt.per_chunk * opt.min_width;
+        pl.nslots = opt.threads + 2 + (unsigned)(pipe_size / min_chunk) + 1;
+        pl.slots = (slot*)calloc(pl.nslots, sizeof(slot));
+        if (!pl.slots) 
+        {
+            fprintf(stderr, "zrand: out of memory\n");
+            return 1;
+        }
+        for (unsigned i = 0; i < pl.nslots; i++) 
+        {
+            pl.slots[i].next = i;
+            pl.slots[i].buf = (char*)aligned_alloc(4096, CHUNK_BYTES);
+            if (!pl.slots[i].buf) 
+            {
+                fprintf(stderr, "zrand: out of memory\n");
+                return 1;
+            }
+        }
+    }
+
+    pthread_t threads[MAX_THREADS];
+    unsigned started = 0;
+    while (started < opt.threads && 0 == pthread_create(&threads[started], NULL, worker, &pl)) 
+    {
+        started++;
+    }
+    if (0 == started) 
+    {
+        fprintf(stderr, "zrand: cannot start threads\n");
+        return 1;
+    }
+
+    int rc = 0;
+    if (!pl.map) 
+    {
+        rc = drain(&pl, fd, pipe_size);
+        if (rc < 0 && EPIPE != errno) 
+        {
+            perror("zrand");
+        }
+        pthread_mutex_lock(&pl.lock);
+        pl.stop = true;
+        pthread_cond_broadcast(&pl.freed);
+        pthread_mutex_unlock(&pl.lock);
+    }
+    for (unsigned t = 0; t < started; t++) 
+    {
+        pthread_join(threads[t], NULL);
+    }
+
+    if (pl.map) 
+    {
+        munmap(pl.map, (size_t)(opt.count * opt.width));
+    }
+    if (opt.out) 
+    {
+        close(fd);
+    }
+    // Spliced pages stay referenced by the pipe; the buffers are released at exit.
+    return (rc < 0 && EPIPE != errno) ? 1 : 0;
+}
@@ -0,0 +1,323 @@
+
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+// Compact statistical battery over a raw 32-bit stream on stdin.
+//
+//   zrand_stream --engine pcg32 | zrand_quality [--bytes N] [--name LABEL]
+//
+// Tests (each yields a p-value; FAIL below 1e-6 or above 1 - 1e-6, "suspect"
+// below 1e-3 or above 1 - 1e-3):
+//   - bit frequency: ones count per bit position (chi-square, 32 dof),
+//   - byte frequency: 256-cell chi-square over all bytes,
+//   - serial correlation: lag 1..4 correlation of u32 / 2^32,
+//   - gap test (Knuth): gaps between values with top 3 bits zero,
+//   - birthday spacings (Marsaglia): 512 birthdays in 2^24 days,
+//     on the high and the low 24 bits, over the first 4096 samples.
+// Not a replacement for PractRand/TestU01; a fast local smoke test that
+// catches gross regressions before and after performance work.
+
+#define FAIL_P 1e-6
+#define SUSPECT_P 1e-3
+#define CHUNK_WORDS (1u << 16)
+// The Poisson law for duplicate spacings is an approximation; beyond a few
+// thousand repetitions the battery starts detecting the approximation itself.
+#define BDAY_REPS 4096
+
+// Regularized upper incomplete gamma Q(a, x) (series / continued fraction).
+static double gamma_q(double a, double x) 
+{
+    if (x <= 0.0) 
+    {
+        return 1.0;
+    }
+    double gln = lgamma(a);
+    if (x < a + 1.0) 
+    {
+        double ap = a, sum = 1.0 / a, del = sum;
+        for (int n = 0; n < 10000 && fabs(del) > fabs(sum) * 1e-15; n++) 
+        {
+            ap += 1.0;
+            del *= x / ap;
+            sum += del;
+        }
+        return 1.0 - sum * exp(-x + a * log(x) - gln);
+    }
+    double b = x + 1.0 - a, c = 1e300, d = 1.0 / b, h = d;
+    for (int i = 1; i < 10000; i++) 
+    {
+        double an = -i * (i - a);
+        b += 2.0;
+        d = an * d + b;
+        d = fabs(d) < 1e-300 ? 1e-300 : d;
+        c = b + an / c;
+        c = fabs(c) < 1e-300 ? 1e-300 : c;
+        d = 1.0 / d;
+        double del = d * c;
+        h *= del;
+        if (fabs(del - 1.0) < 1e-15) 
+        {
+            break;
+        }
+    }
+    return exp(-x + a * log(x) - gln) * h;
+}
+
+static double chi2_p(double chi, int dof) 
+{
+    return gamma_q(0.5 * dof, 0.5 * chi);
+}
+
+// Two-sided p-value of a standard normal z.
+static double normal_p(double z) 
+{
+    return erfc(fabs(z) / sqrt(2.0));
+}
+
+typedef struct 
+{
+    // Bit and byte frequency.
+    uint64_t ones[32];
+    uint64_t bytes[256];
+    // Serial correlation (lags 1..4) on u / 2^32 - 0.5.
+    double prev[4];
+    double sum_xy[4];
+    double sum_x2;
+    double sum_x;
+    // Gap test.
+    uint64_t gaps[33];
+    uint64_t gap_len;
+    bool gap_started;
+    // Birthday spacings (two bit windows).
+    uint32_t bday[2][512];
+    uint32_t bday_fill;
+    uint64_t bday_hist[2][9];
+    uint64_t words;
+} battery;
+
+static int cmp_u32(const void *a, const void *b) 
+{
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int bday_dups(uint32_t *days) 
+{
+    uint32_t spacing[512];
+    qsort(days, 512, sizeof(uint32_t), cmp_u32);
+    spacing[0] = days[0];
+    for (int i = 1; i < 512; i++) 
+    {
+        spacing[i] = days[i] - days[i - 1];
+    }
+    qsort(spacing, 512, sizeof(uint32_t), cmp_u32);
+    int dups = 0;
+    for (int i = 1; i < 512; i++) 
+    {
+        dups += spacing[i] == spacing[i - 1];
+    }
+    return dups;
+}
+
+static void feed(battery *b, const uint32_t *w, size_t n) 
+{
+    for (size_t i = 0; i < n; i++) 
+    {
+        uint32_t v = w[i];
+        for (int k = 0; k < 32; k++) 
+        {
+            b->ones[k] += (v >> k) & 1u;
+        }
+        b->bytes[v & 0xFF]++;
+        b->bytes[(v >> 8) & 0xFF]++;
+        b->bytes[(v >> 16) & 0xFF]++;
+        b->bytes[v >> 24]++;
+
+        double x = v * (1.0 / 4294967296.0) - 0.5;
+        if (b->words >= 4) 
+        {
+            for (int l = 0; l < 4; l++) 
+            {
+                b->sum_xy[l] += x * b->prev[l];
+            }
+        }
+        b->prev[3] = b->prev[2];
+        b->prev[2] = b->prev[1];
+        b->prev[1] = b->prev[0];
+        b->prev[0] = x;
+        b->sum_x += x;
+        b->sum_x2 += x * x;
+
+        // A hit is a value in [0, 1/8); count the misses in between.
+        if (v < (1u << 29)) 
+        {
+            if (b->gap_started) 
+            {
+                b->gaps[b->gap_len < 32 ? b->gap_len : 32]++;
+            }
+            b->gap_started = true;
+            b->gap_len = 0;
+        }
+        else 
+        {
+            b->gap_len++;
+        }
+
+        if (b->words >= (uint64_t)BDAY_REPS * 512) 
+        {
+            b->words++;
+            continue;
+        }
+        b->bday[0][b->bday_fill] = v >> 8;
+        b->bday[1][b->bday_fill] = v & 0xFFFFFF;
+        if (512 == ++b->bday_fill) 
+        {
+            for (int s = 0; s < 2; s++) 
+            {
+                int d = bday_dups(b->bday[s]);
+                b->bday_hist[s][d < 8 ? d : 8]++;
+            }
+            b->bday_fill = 0;
+        }
+        b->words++;
+    }
+}
+
+static int report(const char *test, double p) 
+{
+    const char *verdict = "ok";
+    int fail = 0;
+    if (p < FAIL_P || p > 1.0 - FAIL_P) 
+    {
+        verdict = "FAIL";
+        fail = 1;
+    }
+    else if (p < SUSPECT_P || p > 1.0 - SUSPECT_P) 
+    {
+        verdict = "suspect";
+    }
+    printf("  %-28s p = %-10.6f %s\n", test, p, verdict);
+    return fail;
+}
+
+static int finish(const battery *b) 
+{
+    int fails = 0;
+    double n = (double)b->words;
+
+    double chi = 0.0;
+    for (int k = 0; k < 32; k++) 
+    {
+        double z = (b->ones[k] - n / 2.0) / sqrt(n / 4.0);
+        chi += z * z;
+    }
+    fails += report("bit frequency (32 bits)", chi2_p(chi, 32));
+
+    chi = 0.0;
+    double e = 4.0 * n / 256.0;
+    for (int k = 0; k < 256; k++) 
+    {
+        chi += (b->bytes[k] - e) * (b->bytes[k] - e) / e;
+    }
+    fails += report("byte frequency", chi2_p(chi, 255));
+
+    for (int l = 0; l < 4; l++) 
+    {
+        // Under independence, r * sqrt(n) is approximately standard normal.
+        double m = (n - 4.0);
+        double r = (b->sum_xy[l] / m) / (1.0 / 12.0);
+        char name[40];
+        snprintf(name, sizeof(name), "serial correlation lag %d", l + 1);
+        fails += report(name, normal_p(r * sqrt(m)));
+    }
+
+    // Gap lengths are geometric: P(len = k) = p (1 - p)^k with p = 1/8.
+    uint64_t total = 0;
+    for (int k = 0; k <= 32; k++) 
+    {
+        total += b->gaps[k];
+    }
+    chi = 0.0;
+    for (int k = 0; k <= 32; k++) 
+    {
+        double pk = (k < 32) ? 0.125 * pow(0.875, k) : pow(0.875, 32);
+        double ek = pk * (double)total;
+        chi += (b->gaps[k] - ek) * (b->gaps[k] - ek) / ek;
+    }
+    fails += report("gap test (p = 1/8)", chi2_p(chi, 32));
+
+    // Duplicate spacings ~ Poisson(lambda = m^3 / (4 n)) = 2.
+    static const char *bday_names[2] = { "birthday spacings (hi 24)", "birthday spacings (lo 24)" };
+    for (int s = 0; s < 2; s++) 
+    {
+        uint64_t reps = 0;
+        for (int k = 0; k <= 8; k++) 
+        {
+            reps += b->bday_hist[s][k];
+        }
+        double lambda = 512.0 * 512.0 * 512.0 / (4.0 * 16777216.0);
+        double pk = exp(-lambda), tail = 1.0;
+        chi = 0.0;
+        for (int k = 0; k <= 8; k++) 
+        {
+            double prob = (k < 8) ? pk : tail;
+            double ek = prob * (double)reps;
+            chi += (b->bday_hist[s][k] - ek) * (b->bday_hist[s][k] - ek) / ek;
+            tail -= pk;
+            pk *= lambda / (k + 1);
+        }
+        fails += report(bday_names[s], chi2_p(chi, 8));
+    }
+    return fails;
+}
+
+int main(int argc, char **argv) 
+{
+    uint64_t limit = (uint64_t)1 << 28;   // 256 MiB.
+    const char *name = "stdin";
+    for (int i = 1; i < argc; i++) 
+    {
+        if (0 == strcmp(argv[i], "--bytes") && i + 1 < argc) 
+        {
+            limit = strtoull(argv[++i], NULL, 0);
+        }
+        else if (0 == strcmp(argv[i], "--name") && i + 1 < argc) 
+        {
+            name = argv[++i];
+        }
+        else 
+        {
+            fprintf(stderr, "usage: %s [--bytes N] [--name LABEL] < stream\n", argv[0]);
+            return 2;
+        }
+    }
+
+    static battery b;
+    static uint32_t buf[CHUNK_WORDS];
+    uint64_t want = limit / 4;
+    while (b.words < want) 
+    {
+        size_t n = want - b.words < CHUNK_WORDS ? (size_t)(want - b.words) : CHUNK_WORDS;
+        size_t got = fread(buf, 4, n, stdin);
+        feed(&b, buf, got);
+        if (got < n) 
+        {
+            break;
+        }
+    }
+    if (b.words < 4096) 
+    {
+        fprintf(stderr, "zrand_quality: need at least 16 KiB of input\n");
+        return 2;
+    }
+
+    printf("=> %s: %.1f MiB.\n", name, b.words * 4.0 / 1048576.0);
+    int fails = finish(&b);
+    printf("=> %s: %s.\n", name, fails ? "FAILED" : "passed");
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,347 @@
+
+#define _GNU_SOURCE
+#define ZRAND_IMPLEMENTATION
+#define ZRAND_SHARED
+#include "zrand.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#   include <fcntl.h>
+#   include <sys/uio.h>
+#endif
+
+// Streams raw binary output of one engine to stdout, for external batteries
+// (PractRand `RNG_test stdin32`, TestU01, dieharder -g 200) or `zrand_quality`.
+//
+//   zrand_stream [--engine NAME] [--seed N] [--seq N] [--bytes N] [--no-vmsplice]
+//
+// Output is produced in 1 MiB blocks. When stdout is a pipe on Linux, blocks
+// are handed to the kernel with vmsplice() instead of being copied by write().
+
+#define BLOCK_BYTES (1u << 20)
+
+typedef void (*fill_fn)(uint8_t *buf, size_t len);
+
+static zrand_rng g_rng;
+static zrand_mcg g_mcg;
+static zrand_tiny g_tiny;
+static zrand_rng_bank g_bank;
+static zrand_shared g_shared;
+static zrand_leapfrog g_leap;
+static uint32_t g_hash_seed;
+static int32_t g_hash_x;
+
+static void fill_pcg32(uint8_t *buf, size_t len) 
+{
+    for (size_t i = 0; i < len; i += 4) 
+    {
+        uint32_t v = zrand_rng_u32(&g_rng);
+        memcpy(buf + i, &v, 4);
+    }
+}
+
+static void fill_pcg64(uint8_t *buf, size_t len) 
+{
+    for (size_t i = 0; i < len; i += 8) 
+    {
+        uint64_t v = zrand_rng_u64(&g_rng);
+        memcpy(buf + i, &v, 8);
+    }
+}
+
+static void fill_bytes(uint8_t *buf, size_t len) 
+{
+    zrand_rng_bytes(&g_rng, buf, len);
+}
+
+static void fill_f64(uint8_t *buf, size_t len) 
+{
+    // The top 32 of the 53 significant bits, so every emitted bit is random.
+    for (size_t i = 0; i < len; i += 4) 
+    {
+        uint32_t v = (uint32_t)(zrand_rng_f64(&g_rng) * 4294967296.0);
+        memcpy(buf + i, &v, 4);
+    }
+}
+
+static void fill_mcg(uint8_t *buf, size_t len) 
+{
+    for (size_t i = 0; i < len; i += 4) 
+    {
+        uint32_t v = zrand_mcg_u32(&g_mcg);
+        memcpy(buf + i, &v, 4);
+    }
+}
+
+static void fill_tiny(uint8_t *buf, size_t len) 
+{
+    for (size_t i = 0; i < len; i += 2) 
+    {
+        uint16_t v = zrand_tiny_u16(&g_tiny);
+        memcpy(buf + i, &v, 2);
+    }
+}
+
+static void fill_bank(uint8_t *buf, size_t len) 
+{
+    // Lane-interleaved output of a 64-lane bank: the stream a SIMD consumer sees.
+    for (size_t i = 0; i < len; i += 64 * 4) 
+    {
+        zrand_rng_bank_u32(&g_bank, (uint32_t*)(buf + i));
+    }
+}
+
+static void fill_shared(uint8_t *buf, size_t len) 
+{
+    for (size_t i = 0; i < len; i += 8) 
+    {
+        uint64_t v = zrand_shared_u64(&g_shared);
+        memcpy(buf + i, &v, 8);
+    }
+}
+
+static void fill_leapfrog(uint8_t *buf, size_t len) 
+{
+    for (size_t i = 0; i < len; i += 4) 
+    {
+        uint32_t v = zrand_leapfrog_u32(&g_leap);
+        memcpy(buf + i, &v, 4);
+    }
+}
+
+static void fill_hash(uint8_t *buf, size_t len) 
+{
+    // Counter mode: consecutive coordinates through the stateless hash.
+    for (size_t i = 0; i < len; i += 4) 
+    {
+        uint32_t v = zrand_hash_u32(g_hash_seed, g_hash_x++);
+        memcpy(buf + i, &v, 4);
+    }
+}
+
+static void fill_global(uint8_t *buf, size_t len) 
+{
+    for (size_t i = 0; i < len; i += 4) 
+    {
+        uint32_t v = zrand_u32();
+        memcpy(buf + i, &v, 4);
+    }
+}
+
+typedef struct 
+{
+    const char *name;
+    fill_fn fill;
+    const char *desc;
+} engine;
+
+static const engine g_engines[] =
+{
+    { "pcg32",    fill_pcg32,    "zrand_rng_u32" },
+    { "pcg64",    fill_pcg64,    "zrand_rng_u64" },
+    { "bytes",    fill_bytes,    "zrand_rng_bytes" },
+    { "f64",      fill_f64,      "zrand_rng_f64, top 32 significand bits" },
+    { "mcg",      fill_mcg,      "zrand_mcg_u32 (8-byte engine)" },
+    { "tiny",     fill_tiny,     "zrand_tiny_u16 (4-byte engine, period 2^32)" },
+    { "bank",     fill_bank,     "zrand_rng_bank_u32, 64 lanes interleaved" },
+    { "shared",   fill_shared,   "zrand_shared_u64" },
+    { "leapfrog", fill_leapfrog, "zrand_leapfrog_u32, rank 1 of 3" },
+    { "hash",     fill_hash,     "zrand_hash_u32 over x = 0, 1, 2, ..." },
+    { "global",   fill_global,   "zrand_u32 (thread-local, seeded)" },
+};
+#define NENGINES (sizeof(g_engines) / sizeof(g_engines[0]))
+
+static int write_all(const uint8_t *buf, size_t len) 
+{
+    while (len > 0) 
+    {
+        ssize_t w = write(STDOUT_FILENO, buf, len);
+        if (w < 0) 
+        {
+            if (EINTR == errno) 
+            {
+                continue;
+            }
+            return -1;
+        }
+        buf += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+#ifdef __linux__
+// Returns 1 if the block was spliced, 0 if vmsplice is unavailable, -1 on error.
+static int splice_all(const uint8_t *buf, size_t len) 
+{
+    while (len > 0) 
+    {
+        struct iovec iov = { (void*)buf, len };
+        ssize_t w = vmsplice(STDOUT_FILENO, &iov, 1, 0);
+        if (w < 0) 
+        {
+            if (EINTR == errno) 
+            {
+                continue;
+            }
+            return (EINVAL == errno || EBADF == errno) ? 0 : -1;
+        }
+        buf += w;
+        len -= (size_t)w;
+    }
+    return 1;
+}
+#endif
+
+static void usage(const char *argv0) 
+{
+    fprintf(stderr, "usage: %s [--engine NAME] [--seed N] [--seq N] [--bytes N] [--no-vmsplice]\nengines:\n", argv0);
+    for (size_t i = 0; i < NENGINES; i++) 
+    {
+        fprintf(stderr, "  %-9s %s\n", g_engines[i].name, g_engines[i].desc);
+    }
+}
+
+int main(int argc, char **argv) 
+{
+    const engine *eng = &g_engines[0];
+    uint64_t seed = 42, seq = 54;
+    uint64_t limit = 0;
+    bool use_vmsplice = true;
+    for (int i = 1; i < argc; i++) 
+    {
+        if (0 == strcmp(argv[i], "--engine") && i + 1 < argc) 
+        {
+            const char *name = argv[++i];
+            eng = NULL;
+            for (size_t e = 0; e < NENGINES; e++) 
+            {
+                if (0 == strcmp(g_engines[e].name, name)) 
+                {
+                    eng = &g_engines[e];
+                }
+            }
+            if (!eng) 
+            {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        else if (0 == strcmp(argv[i], "--seed") && i + 1 < argc) 
+        {
+            seed = strtoull(argv[++i], NULL, 0);
+        }
+        else if (0 == strcmp(argv[i], "--seq") && i + 1 < argc) 
+        {
+            seq = strtoull(argv[++i], NULL, 0);
+        }
+        else if (0 == strcmp(argv[i], "--bytes") && i + 1 < argc) 
+        {
+            limit = strtoull(argv[++i], NULL, 0);
+        }
+        else if (0 == strcmp(argv[i], "--no-vmsplice")) 
+        {
+            use_vmsplice = false;
+        }
+        else 
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    zrand_rng_init(&g_rng, seed, seq);
+    zrand_mcg_init(&g_mcg, seed);
+    zrand_tiny_init(&g_tiny, (uint32_t)seed);
+    zrand_shared_init(&g_shared, seed);
+    zrand_leapfrog_init(&g_leap, &g_rng, 1, 3);
+    zrand_rng_init(zrand_local(), seed, seq);
+    g_hash_seed = (uint32_t)seed;
+    if (!zrand_rng_bank_init(&g_bank, 64, seed, false)) 
+    {
+        fprintf(stderr, "zrand_stream: out of memory\n");
+        return 1;
+    }
+
+    // A reader closing the pipe (e.g. `| head -c`) is a normal way to stop.
+    signal(SIGPIPE, SIG_IGN);
+
+    // With vmsplice the pipe references our pages until the reader consumes
+    // them. Blocks are as large as the pipe, so once block k+1 is fully
+    // spliced block k has been read; rotating three blocks leaves margin.
+    size_t block = BLOCK_BYTES;
+#ifdef __linux__
+    if (use_vmsplice) 
+    {
+        int sz = fcntl(STDOUT_FILENO, F_SETPIPE_SZ, (int)BLOCK_BYTES);
+        if (sz <= 0) 
+        {
+            sz = fcntl(STDOUT_FILENO, F_GETPIPE_SZ);
+        }
+        if (sz > 0) 
+        {
+            block = (size_t)sz;
+        }
+        else 
+        {
+            use_vmsplice = false;   // Not a pipe.
+        }
+    }
+#else
+    use_vmsplice = false;
+#endif
+
+    uint8_t *bufs = (uint8_t*)malloc(3 * (size_t)BLOCK_BYTES);
+    if (!bufs) 
+    {
+        fprintf(stderr, "zrand_stream: out of memory\n");
+        return 1;
+    }
+    uint64_t sent = 0;
+    for (unsigned k = 0; 0 == limit || sent < limit; k = (k + 1) % 3) 
+    {
+        uint8_t *buf = bufs + (size_t)k * BLOCK_BYTES;
+        size_t len = block;
+        if (limit && limit - sent < len) 
+        {
+            len = (size_t)(limit - sent);
+        }
+        // Engines fill whole words; round up inside the block, send only `len`.
+        eng->fill(buf, (len + 255) & ~(size_t)255);
+
+        int rc = -1;
+#ifdef __linux__
+        if (use_vmsplice) 
+        {
+            rc = splice_all(buf, len);
+            if (0 == rc) 
+            {
+                use_vmsplice = false;
+            }
+        }
+#endif
+        if (rc <= 0 && !use_vmsplice) 
+        {
+            rc = write_all(buf, len) ? -1 : 1;
+        }
+        if (rc < 0) 
+        {
+            if (EPIPE == errno) 
+            {
+                break;
+            }
+            perror("zrand_stream");
+            return 1;
+        }
+        sent += len;
+    }
+    free(bufs);
+    zrand_rng_bank_free(&g_bank);
+    return 0;
+}
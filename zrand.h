@@ -32,6 +32,12 @@
 #   include "zcommon.h"
 #endif
 
+#if defined(_MSC_VER)
+#   define ZRAND_ALIGNED(n) __declspec(align(n))
+#else
+#   define ZRAND_ALIGNED(n) __attribute__((aligned(n)))
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -46,6 +52,35 @@ typedef struct
     uint64_t inc;
 } zrand_rng;
 
+// Compact 8-byte generator: 64-bit MCG state with the PCG XSH-RR output.
+typedef struct 
+{
+    uint64_t state;
+} zrand_mcg;
+
+// Compact 4-byte generator: 32-bit LCG state with 16-bit PCG output.
+typedef struct 
+{
+    uint32_t state;
+} zrand_tiny;
+
+// Struct-of-arrays bank of PCG generators (one lane per entity).
+typedef struct 
+{
+    uint64_t *state;
+    uint64_t *inc;        // Per-lane increments, or NULL when lanes share `shared_inc`.
+    uint64_t shared_inc;
+    size_t count;
+} zrand_rng_bank;
+
+// Leapfrog view of a zrand_rng stream: yields every `stride`-th output.
+typedef struct 
+{
+    uint64_t state;
+    uint64_t mult;
+    uint64_t plus;
+} zrand_leapfrog;
+
 /// @section API Reference (C)
 ///
 /// @subsection Global Generation
@@ -114,6 +149,9 @@ void* zrand_choice(void *base, size_t nmemb, size_t size);
 /// Explicitly re-seeds the current thread's generator from OS entropy (`/dev/urandom` or `rand_s`).
 void     zrand_init(void); 
 
+/// Returns this thread's (seeded) generator. Resolve it once and pass it to the `zrand_rng_*` functions in hot loops to skip the per-call TLS lookup and seeding check. The pointer is only valid on the calling thread.
+zrand_rng *zrand_local(void);
+
 /// @endgroup
 
 // Instance API (deterministic).
@@ -126,6 +164,9 @@ void     zrand_init(void);
 /// Initializes a specific `zrand_rng` struct. `seq` (sequence) allows different streams from the same seed.
 void     zrand_rng_init(zrand_rng *rng, uint64_t seed, uint64_t seq);
 
+/// Jumps the generator `delta` 32-bit outputs ahead in O(log delta). Use `(uint64_t)-k` to step `k` outputs back.
+void     zrand_rng_advance(zrand_rng *rng, uint64_t delta);
+
 /// @endgroup
 /// @group Generation
 
@@ -144,529 +185,5770 @@ double   zrand_rng_f64(zrand_rng *rng);
 /// Helper to generate a gaussian double from a specific instance.
 double   zrand_rng_gaussian(zrand_rng *rng, double mean, double stddev);
 
+/// Helper to generate a float in `[0.0, 1.0)` from a specific instance.
+float    zrand_rng_f32(zrand_rng *rng);
+
+/// Helper to generate a boolean (50/50) from a specific instance.
+bool     zrand_rng_bool(zrand_rng *rng);
+
+/// Helper to generate a float in `[min, max)` from a specific instance.
+float    zrand_rng_range_f(zrand_rng *rng, float min, float max);
+
+/// Helper to run a probability check (0.0 to 1.0) on a specific instance.
+bool     zrand_rng_chance(zrand_rng *rng, double probability);
+
 /// @endgroup
+/// @group Utilities
 
-// Optional short names.
-#ifdef ZRAND_SHORT_NAMES
-#   define rand_init       zrand_init
-#   define rand_u32        zrand_u32
-#   define rand_u64        zrand_u64
-#   define rand_f32        zrand_f32
-#   define rand_f64        zrand_f64
-#   define rand_bool       zrand_bool
-#   define rand_range      zrand_range
-#   define rand_range_f    zrand_range_f
-#   define rand_chance     zrand_chance
-#   define rand_gaussian   zrand_gaussian
-#   define rand_bytes      zrand_bytes
-#   define rand_str        zrand_str
-#   define rand_uuid       zrand_uuid
-#   define rand_shuffle    zrand_shuffle
-#   define rand_choice     zrand_choice
-#endif
+/// Fills a buffer with random bytes from a specific instance.
+void     zrand_rng_bytes(zrand_rng *rng, void *buf, size_t len);
 
-#ifdef __cplusplus
-}
-#endif
+/// Fills a buffer with a random alphanumeric string from a specific instance.
+void     zrand_rng_str(zrand_rng *rng, char *buf, size_t len);
 
-// C++ API.
+/// Generates a **UUID v4** string from a specific instance. `buf` must be at least 37 bytes.
+void     zrand_rng_uuid(zrand_rng *rng, char *buf);
 
-#ifdef __cplusplus
-#include <string>
-#include <vector>
-#include <algorithm>
-#include <stdexcept>
-#include <limits> 
+/// Shuffles an array in-place (Fisher-Yates) using a specific instance.
+void     zrand_rng_shuffle(zrand_rng *rng, void *base, size_t nmemb, size_t size);
 
-namespace z_rand 
-{
-    /// @section API Reference (C++)
-    ///
-    /// The C++ wrapper is defined in the **`z_rand`** namespace.
-    ///
-    /// @table Global Shortcuts
-    /// @row `z_rand::init()` | Wraps `zrand_init`.
-    /// @row `z_rand::u32()`, `u64()` | Returns random integers.
-    /// @row `z_rand::f32()`, `f64()` | Returns random floating point numbers.
-    /// @row `z_rand::boolean()` | Returns boolean.
-    /// @row `z_rand::chance(prob)` | Returns true based on probability.
-    /// @row `z_rand::range(min, max)` | Returns value in range (overloaded for `int` and `float`).
-    /// @row `z_rand::gaussian(mean, std)`| Returns normally distributed value.
-    /// @row `z_rand::uuid()` | Returns a standard `std::string` containing a UUID v4.
-    /// @row `z_rand::string(len)` | Returns a standard `std::string` of random alphanumeric characters.
-    /// @row `z_rand::shuffle(vector)` | Shuffles a `std::vector` (or `z_vec::vector`) in-place.
-    /// @row `z_rand::choice(vector)` | Returns a random element (const ref) from the vector.
-    /// @endgroup
-    
-    // Global shortcuts.
-    inline void init()
-    {
-        ::zrand_init();
-    }
+/// Returns a `void*` pointer to a random element, picked with a specific instance.
+void*    zrand_rng_choice(zrand_rng *rng, void *base, size_t nmemb, size_t size);
 
-    inline uint32_t u32()
-    {
-        return ::zrand_u32();
-    }
+/// @endgroup
+/// @group Generator Bank
+///
+/// `zrand_rng_bank` keeps `count` PCG states in struct-of-arrays layout so a whole population can be stepped in lockstep (AVX2/AVX-512 when compiled for those targets). Lane `i` produces the same values as a standalone `zrand_rng` with the same state.
 
-    inline uint64_t u64()
-    {
-        return ::zrand_u64();
-    }
+/// Allocates a bank. With `per_lane_streams`, lane `i` runs on stream `i` from a state seeded with a SplitMix64 hash of `(seed, i)`. Otherwise all lanes share one stream (8 bytes per lane) and start `S` outputs apart, where `S` is an odd, well-mixed spacing in `[2^63 / count, 2^64 / count)`. A power-of-two spacing would leave interleaved lanes correlated. Returns `false` on allocation failure.
+bool     zrand_rng_bank_init(zrand_rng_bank *bank, size_t count, uint64_t seed, bool per_lane_streams);
 
-    inline float f32()
-    {
-        return ::zrand_f32();
-    }
+/// Sets up a shared-stream bank over caller storage (`state` holds `count` values and must outlive the bank; do not call `zrand_rng_bank_free`). Lane 0 starts at `rng`'s position on its stream and the lanes are spaced as in `zrand_rng_bank_init`.
+void     zrand_rng_bank_init_shared(zrand_rng_bank *bank, uint64_t *state, size_t count, const zrand_rng *rng);
 
-    inline double f64()
-    {
-        return ::zrand_f64();
-    }
+/// Frees the bank's arrays.
+void     zrand_rng_bank_free(zrand_rng_bank *bank);
 
-    inline bool boolean()
-    {
-        return ::zrand_bool();
-    }
-    
-    inline bool chance(double prob)
-    {
-        return ::zrand_chance(prob);
-    }
-    
-    inline int32_t range(int32_t min, int32_t max)
-    {
-        return ::zrand_range(min, max);
-    }
+/// Steps every lane once, writing lane `i`'s output to `out[i]`.
+void     zrand_rng_bank_u32(zrand_rng_bank *bank, uint32_t *out);
 
-    inline float range(float min, float max)
-    {
-        return ::zrand_range_f(min, max);
-    }
-    
-    inline double gaussian(double mean, double stddev)
-    {
-        return ::zrand_gaussian(mean, stddev);
-    }
+/// Steps every lane once, writing floats in `[0.0, 1.0)` to `out[i]`.
+void     zrand_rng_bank_f32(zrand_rng_bank *bank, float *out);
 
-    inline std::string uuid() 
-    {
-        char buf[37];
-        ::zrand_uuid(buf);
-        return std::string(buf);
-    }
+/// Steps only lanes with `mask[i] != 0`; other lanes and their `out[i]` are left untouched.
+void     zrand_rng_bank_u32_masked(zrand_rng_bank *bank, const uint8_t *mask, uint32_t *out);
 
-    inline std::string string(size_t len) 
-    {
-        std::string s; 
-        s.resize(len);
-        ::zrand_str(&s[0], len); 
-        return s;
-    }
+/// Steps a single lane.
+uint32_t zrand_rng_bank_lane_u32(zrand_rng_bank *bank, size_t lane);
 
-    template<typename T>
-    inline void shuffle(std::vector<T> &v) 
-    {
-        if (!v.empty())
-        {
-            ::zrand_shuffle(v.data(), v.size(), sizeof(T));
-        }
-    }
-    
-    template<typename T>
-    inline const T &choice(const std::vector<T>& v) 
-    {
-        const void *ptr = ::zrand_choice((void*)v.data(), v.size(), sizeof(T));
-        return *(const T*)ptr;
-    }
-    
-    /// @subsection Deterministic Generator
-    ///
-    /// The `z_rand::generator` class wraps the C struct state (`zrand_rng`). It provides methods matching the global API but operates on its own internal state.
-    ///
-    /// @example cpp
-    /// // Seed 1234, Sequence 1.
-    /// z_rand::generator rng(1234);
-    ///
-    /// int hp = rng.range(50, 100);
-    /// bool has_key = rng.chance(0.25);
-    /// @endexample
+/// Copies lane `lane` out as a standalone `zrand_rng`.
+void     zrand_rng_bank_get(const zrand_rng_bank *bank, size_t lane, zrand_rng *out);
 
-    // Generator instance (for reproducible seeds).
-    class generator 
-    {
-        zrand_rng rng;
-     public:
-        using result_type = uint32_t;
-        static constexpr result_type min()
-        {
-            return 0;
-        }
+/// @endgroup
+/// @group Compact Generators
+///
+/// Smaller per-entity engines that keep the PCG output permutation. `zrand_mcg` (8 bytes) drops the stream increment and has a period of 2^62; quality matches PCG's `pcg32_fast` family. `zrand_tiny` (4 bytes) has a period of 2^32 and 16-bit outputs, meant for visual jitter, not statistics. For a shared-increment 8-byte layout over many entities, see `zrand_rng_bank`.
 
-        static constexpr result_type max()
-        {
-            return 0xFFFFFFFF;
-        }
-        
-        result_type operator()()
-        {
-            return ::zrand_rng_u32(&rng);
-        }
+/// Seeds an 8-byte generator.
+void     zrand_mcg_init(zrand_mcg *rng, uint64_t seed);
 
-        generator() 
-        { 
-            ::zrand_rng_init(&rng, ::zrand_u64(), ::zrand_u64()); 
-        }
+/// Returns a 32-bit value from an 8-byte generator.
+uint32_t zrand_mcg_u32(zrand_mcg *rng);
 
-        generator(uint64_t seed, uint64_t seq = 1) 
-        { 
-            ::zrand_rng_init(&rng, seed, seq); 
-        }
+/// Returns a float in `[0.0, 1.0)` from an 8-byte generator.
+float    zrand_mcg_f32(zrand_mcg *rng);
 
-        uint32_t u32()
-        {
-            return operator()();
-        }
+/// Returns `int32_t` in `[min, max]` (inclusive, bias-free) from an 8-byte generator.
+int32_t  zrand_mcg_range(zrand_mcg *rng, int32_t min, int32_t max);
 
-        uint64_t u64()
-        {
-            return ::zrand_rng_u64(&rng);
-        }
+/// Seeds a 4-byte generator.
+void     zrand_tiny_init(zrand_tiny *rng, uint32_t seed);
 
-        double f64()
-        {
-            return ::zrand_rng_f64(&rng);
-        }
+/// Returns a 16-bit value from a 4-byte generator.
+uint16_t zrand_tiny_u16(zrand_tiny *rng);
 
-        int32_t range(int32_t min, int32_t max)
-        {
-            return ::zrand_rng_range(&rng, min, max);
-        }
+/// Returns a float in `[0.0, 1.0)` with 16-bit resolution from a 4-byte generator.
+float    zrand_tiny_f32(zrand_tiny *rng);
 
-        bool chance(double p)
-        {
-            return f64() < p;
-        }
+/// Returns `int32_t` in `[min, max]` from a 4-byte generator. The span must not exceed 65536 values.
+int32_t  zrand_tiny_range(zrand_tiny *rng, int32_t min, int32_t max);
 
-        double gaussian(double m, double s)
-        {
-            return ::zrand_rng_gaussian(&rng, m, s);
-        }
-    };
+/// @endgroup
+/// @group Stream Partitioning
+///
+/// Split one logical stream across `nranks` processes or threads. Positions are counted in 32-bit outputs (`zrand_rng_u64` consumes two).
+
+/// Block partition: moves `rng` to the start of block `rank`, i.e. `rank * block_size` outputs ahead. A `block_size` of `0` splits the full 2^64 period evenly across `nranks`. Rank `r` may draw `block_size` outputs without overlapping rank `r + 1`. Blocks never overlap, but an even split with power-of-two `nranks` puts ranks exactly 2^64/nranks apart, and such offsets of one LCG yield correlated outputs: keep per-rank results separate, or use the leapfrog or `zrand_rng_bank` shared stream when outputs are interleaved.
+void     zrand_rng_partition(zrand_rng *rng, uint64_t rank, uint64_t nranks, uint64_t block_size);
+
+/// Leapfrog partition: rank `r` of `nranks` gets outputs `r`, `r + nranks`, `r + 2 * nranks`, ... of `rng`'s stream. `rng` is not modified.
+void     zrand_leapfrog_init(zrand_leapfrog *lf, const zrand_rng *rng, uint64_t rank, uint64_t nranks);
+
+/// Returns the next 32-bit output of a leapfrog stream.
+uint32_t zrand_leapfrog_u32(zrand_leapfrog *lf);
+
+/// Returns a 64-bit value built from the next two leapfrog outputs.
+uint64_t zrand_leapfrog_u64(zrand_leapfrog *lf);
+
+/// Returns a `double` in `[0.0, 1.0)` from a leapfrog stream.
+double   zrand_leapfrog_f64(zrand_leapfrog *lf);
+
+/// @endgroup
+
+/// @section Coordinate Hashing (Stateless)
+/// Deterministic values for any `(seed, x, y, z, w)` in any order, for procedural generation without shared or sequential state. Built on the PCG-RXS-M-XS 32-bit permutation ("PCG hash"); each extra dimension feeds the previous hash into the next round. The scalar functions are `static inline` so per-cell calls compile to a handful of instructions; the `_batch` and `_grid` versions hash eight coordinates per step with AVX2 when compiled for it, with results identical to the scalar functions.
+///
+/// @group Coordinate Hashing
+
+/// @private
+static inline uint32_t zrand__hash_round(uint32_t v) 
+{
+    uint32_t state = v * 747796405u + 2891336453u;
+    uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
 }
-#endif // __cplusplus
 
-#endif // ZRAND_H
+/// Hashes a 1D coordinate.
+static inline uint32_t zrand_hash_u32(uint32_t seed, int32_t x) 
+{
+    return zrand__hash_round(zrand__hash_round(seed) ^ (uint32_t)x);
+}
 
-#ifdef ZRAND_IMPLEMENTATION
-#ifndef ZRAND_IMPLEMENTATION_GUARD
-#define ZRAND_IMPLEMENTATION_GUARD
+/// Hashes a 2D coordinate.
+static inline uint32_t zrand_hash2_u32(uint32_t seed, int32_t x, int32_t y) 
+{
+    return zrand__hash_round(zrand_hash_u32(seed, x) ^ (uint32_t)y);
+}
 
-#include <stdlib.h>
-#include <string.h>
-#include <time.h>
+/// Hashes a 3D coordinate.
+static inline uint32_t zrand_hash3_u32(uint32_t seed, int32_t x, int32_t y, int32_t z) 
+{
+    return zrand__hash_round(zrand_hash2_u32(seed, x, y) ^ (uint32_t)z);
+}
 
-#ifndef ZMATH_IMPLEMENTATION
-#   define ZMATH_IMPLEMENTATION
-#   define ZMATH_NO_LIBC 
-#endif
-#if defined(__has_include) && __has_include("zmath.h")
-#   include "zmath.h"
-#else
-    // For now we assume the user has provided zmath.h or the compiler can find standard math.
-#   include <math.h>
-#   ifndef zmath_sqrt
-#       define zmath_sqrt sqrt
-#       define zmath_log  log
-#   endif
-#endif
+/// Hashes a 4D coordinate.
+static inline uint32_t zrand_hash4_u32(uint32_t seed, int32_t x, int32_t y, int32_t z, int32_t w) 
+{
+    return zrand__hash_round(zrand_hash3_u32(seed, x, y, z) ^ (uint32_t)w);
+}
 
-// OS entropy source.
-#ifdef _WIN32
+/// Maps a hash to a float in `[0.0, 1.0)`.
+static inline float zrand_hash_to_f32(uint32_t h) 
+{
+    return (h >> 8) * (1.0f / 16777216.0f);
+}
+
+/// Maps a hash to `int32_t` in `[min, max]` (multiply-shift; bias below 2^-32 per value).
+static inline int32_t zrand_hash_to_range(uint32_t h, int32_t min, int32_t max) 
+{
+    if (min >= max) 
+    {
+        return min;
+    }
+    uint64_t range = (uint64_t)((int64_t)max - (int64_t)min) + 1;
+    return (int32_t)((int64_t)min + (int64_t)(((uint64_t)h * range) >> 32));
+}
+
+/// Float in `[0.0, 1.0)` for a 1D coordinate.
+static inline float zrand_hash_f32(uint32_t seed, int32_t x) 
+{
+    return zrand_hash_to_f32(zrand_hash_u32(seed, x));
+}
+
+/// Float in `[0.0, 1.0)` for a 2D coordinate.
+static inline float zrand_hash2_f32(uint32_t seed, int32_t x, int32_t y) 
+{
+    return zrand_hash_to_f32(zrand_hash2_u32(seed, x, y));
+}
+
+/// Float in `[0.0, 1.0)` for a 3D coordinate.
+static inline float zrand_hash3_f32(uint32_t seed, int32_t x, int32_t y, int32_t z) 
+{
+    return zrand_hash_to_f32(zrand_hash3_u32(seed, x, y, z));
+}
+
+/// Float in `[0.0, 1.0)` for a 4D coordinate.
+static inline float zrand_hash4_f32(uint32_t seed, int32_t x, int32_t y, int32_t z, int32_t w) 
+{
+    return zrand_hash_to_f32(zrand_hash4_u32(seed, x, y, z, w));
+}
+
+/// Hashes `n` 1D coordinates: `out[i] = zrand_hash_u32(seed, x[i])`.
+void zrand_hash_u32_batch(uint32_t seed, const int32_t *x, uint32_t *out, size_t n);
+
+/// Hashes `n` 2D coordinates: `out[i] = zrand_hash2_u32(seed, x[i], y[i])`.
+void zrand_hash2_u32_batch(uint32_t seed, const int32_t *x, const int32_t *y, uint32_t *out, size_t n);
+
+/// Hashes `n` 3D coordinates: `out[i] = zrand_hash3_u32(seed, x[i], y[i], z[i])`.
+void zrand_hash3_u32_batch(uint32_t seed, const int32_t *x, const int32_t *y, const int32_t *z, uint32_t *out, size_t n);
+
+/// Fills a `w * h` row-major grid with `zrand_hash2_f32(seed, x0 + i, y0 + j)`.
+void zrand_hash2_f32_grid(uint32_t seed, int32_t x0, int32_t y0, size_t w, size_t h, float *out);
+
+/// @endgroup
+
+/// @section Noise (ZRAND_NOISE)
+/// Opt-in (`#define ZRAND_NOISE`). Coherent gradient and value noise whose permutation and value tables are seeded from a `zrand_rng`, so a world seed reproduces the same terrain everywhere. Simplex noise follows Gustavson's reference formulation. Outputs are roughly in `[-1, 1]`. The 2D grid functions evaluate 8 samples at a time with AVX2 when compiled for it.
+///
+/// @group Noise
+
+#ifdef ZRAND_NOISE
+
+/// Noise tables (about 3 KB). Initialize once, then share read-only between threads.
+typedef struct 
+{
+    int32_t perm[512];   // Permutation of 0..255, stored twice to avoid wrapping.
+    float values[256];   // Lattice values in [-1, 1] for value noise.
+} zrand_noise;
+
+/// Builds the tables from `rng` (consumes a few hundred draws).
+void  zrand_noise_init(zrand_noise *noise, zrand_rng *rng);
+
+/// 2D simplex noise.
+float zrand_noise_simplex2(const zrand_noise *noise, float x, float y);
+
+/// 3D simplex noise.
+float zrand_noise_simplex3(const zrand_noise *noise, float x, float y, float z);
+
+/// 4D simplex noise.
+float zrand_noise_simplex4(const zrand_noise *noise, float x, float y, float z, float w);
+
+/// 2D value noise (quintic interpolation).
+float zrand_noise_value2(const zrand_noise *noise, float x, float y);
+
+/// 3D value noise (quintic interpolation).
+float zrand_noise_value3(const zrand_noise *noise, float x, float y, float z);
+
+/// 4D value noise (quintic interpolation).
+float zrand_noise_value4(const zrand_noise *noise, float x, float y, float z, float w);
+
+/// Fractal Brownian motion over 2D simplex noise, normalized to roughly `[-1, 1]`. Typical values: `lacunarity` 2.0, `gain` 0.5.
+float zrand_noise_fbm2(const zrand_noise *noise, float x, float y, int octaves, float lacunarity, float gain);
+
+/// Fractal Brownian motion over 3D simplex noise, normalized to roughly `[-1, 1]`.
+float zrand_noise_fbm3(const zrand_noise *noise, float x, float y, float z, int octaves, float lacunarity, float gain);
+
+/// Fills a `w * h` row-major grid with `simplex2(x0 + i * step, y0 + j * step)`.
+void  zrand_noise_simplex2_grid(const zrand_noise *noise, float x0, float y0, float step, size_t w, size_t h, float *out);
+
+/// Fills a `w * h` row-major grid with `fbm2(x0 + i * step, y0 + j * step, ...)`.
+void  zrand_noise_fbm2_grid(const zrand_noise *noise, float x0, float y0, float step, size_t w, size_t h, 
+                            int octaves, float lacunarity, float gain, float *out);
+
+#endif // ZRAND_NOISE
+
+/// @endgroup
+
+/// @section Spatial Sampling (ZRAND_SAMPLING)
+/// Opt-in (`#define ZRAND_SAMPLING`, uses `<math.h>`). Point-set and geometric samplers that draw from an explicit `zrand_rng`, so placements are reproducible from a seed.
+///
+/// @group Poisson Disk / Blue Noise
+
+#ifdef ZRAND_SAMPLING
+
+/// Bridson Poisson-disk sampling in `[0, width) x [0, height)`: no two points closer than `radius`. `k` is the number of candidates per active point (30 is typical; `<= 0` uses 30). With `tileable`, distances wrap around the edges so the result tiles seamlessly. Writes up to `max_points` `(x, y)` pairs to `out_xy` and returns the count (0 on allocation failure). Runs in O(n) using a background grid.
+size_t zrand_poisson2(zrand_rng *rng, float width, float height, float radius, int k, bool tileable, 
+                      float *out_xy, size_t max_points);
+
+/// Bridson Poisson-disk sampling in a `width x height x depth` box. Writes `(x, y, z)` triples to `out_xyz`. Returns the count.
+size_t zrand_poisson3(zrand_rng *rng, float width, float height, float depth, float radius, int k, 
+                      float *out_xyz, size_t max_points);
+
+/// Generates a tileable `size x size` blue-noise threshold mask with void-and-cluster. `out[y * size + x]` receives the pixel's rank scaled to `[0, 1)`. Thresholding at `t` lights about `t * size^2` well-spread pixels. Cost is O(size^4), so it suits masks up to about 128x128 generated once. Returns `false` on allocation failure.
+bool   zrand_blue_noise_mask(zrand_rng *rng, size_t size, float *out);
+
+#endif // ZRAND_SAMPLING
+
+/// @endgroup
+/// @group Geometric Samplers
+/// Closed-form (no rejection loop) inverse-CDF samplers. Each draws a fixed number of `u32` from `rng`, so the stream position after `n` samples is predictable. Batch variants write structure-of-arrays output.
+
+#ifdef ZRAND_SAMPLING
+
+/// Uniform point inside the unit disk. Writes `out[0..1]`.
+void zrand_rng_disk(zrand_rng *rng, float out[2]);
+/// Uniform point on the unit circle.
+void zrand_rng_circle(zrand_rng *rng, float out[2]);
+/// Uniform point on the unit sphere (Archimedes: uniform `z`, uniform azimuth).
+void zrand_rng_sphere(zrand_rng *rng, float out[3]);
+/// Uniform point inside the unit ball.
+void zrand_rng_ball(zrand_rng *rng, float out[3]);
+/// Uniform unit direction within `half_angle` radians of the unit vector `axis` (uniform over the spherical cap).
+void zrand_rng_cone(zrand_rng *rng, const float axis[3], float half_angle, float out[3]);
+/// Uniform point on the triangle `(a, b, c)`, using the square-root barycentric mapping.
+void zrand_rng_triangle(zrand_rng *rng, const float a[3], const float b[3], const float c[3], float out[3]);
+
+/// Batch versions. Each writes `n` samples to separate coordinate arrays.
+void zrand_rng_disk_batch(zrand_rng *rng, float *xs, float *ys, size_t n);
+void zrand_rng_circle_batch(zrand_rng *rng, float *xs, float *ys, size_t n);
+void zrand_rng_sphere_batch(zrand_rng *rng, float *xs, float *ys, float *zs, size_t n);
+void zrand_rng_ball_batch(zrand_rng *rng, float *xs, float *ys, float *zs, size_t n);
+void zrand_rng_cone_batch(zrand_rng *rng, const float axis[3], float half_angle, 
+                          float *xs, float *ys, float *zs, size_t n);
+
+/// Area-weighted surface sampler for an indexed triangle mesh. Triangle selection is O(1) through Walker/Vose alias tables. The sampler keeps pointers to `verts` and `indices`, which must outlive it.
+typedef struct 
+{
+    const float *verts;      // xyz per vertex.
+    const uint32_t *indices; // 3 per triangle.
+    size_t tri_count;
+    float *prob;             // Alias acceptance threshold per triangle.
+    uint32_t *alias;         // Alias triangle per slot.
+    float total_area;
+} zrand_mesh_sampler;
+
+/// Builds the alias tables in O(tri_count). Returns `false` on allocation failure, an empty mesh or zero total area.
+bool zrand_mesh_sampler_init(zrand_mesh_sampler *s, const float *verts, const uint32_t *indices, size_t tri_count);
+/// Frees the alias tables.
+void zrand_mesh_sampler_free(zrand_mesh_sampler *s);
+/// Uniform point on the mesh surface. Returns the index of the chosen triangle.
+uint32_t zrand_mesh_sampler_point(const zrand_mesh_sampler *s, zrand_rng *rng, float out[3]);
+/// Writes `n` surface points to `xs`/`ys`/`zs`. `tris` may be NULL; otherwise it receives the triangle of each point.
+void zrand_mesh_sampler_batch(const zrand_mesh_sampler *s, zrand_rng *rng, 
+                              float *xs, float *ys, float *zs, uint32_t *tris, size_t n);
+
+#endif // ZRAND_SAMPLING
+
+/// @endgroup
+/// @group Rotations and Directions
+
+#ifdef ZRAND_SAMPLING
+
+/// Uniform random unit quaternion `(x, y, z, w)` (Shoemake, Graphics Gems III): three uniforms, no rejection. Uniform over SO(3), unlike Euler-angle sampling.
+void zrand_rng_quat(zrand_rng *rng, float q[4]);
+/// Writes `n` quaternions as separate `x`, `y`, `z`, `w` arrays.
+void zrand_rng_quat_batch(zrand_rng *rng, float *xs, float *ys, float *zs, float *ws, size_t n);
+/// Uniform random 3x3 rotation matrix (row-major, determinant +1), built from `zrand_rng_quat`.
+void zrand_rng_rotation3(zrand_rng *rng, float m[9]);
+
+/// Uniform random direction in `dim` dimensions, written to `out[0..dim-1]`. Dimensions 1 to 3 use closed forms. Higher dimensions normalize a Gaussian vector, taking both outputs of each polar Box-Muller step.
+void zrand_rng_unit_vector(zrand_rng *rng, float *out, size_t dim);
+/// Writes `n` unit vectors back to back (`out[i * dim + k]`).
+void zrand_rng_unit_vector_batch(zrand_rng *rng, float *out, size_t dim, size_t n);
+
+/// Haar-distributed random orthogonal `dim x dim` matrix (row-major), made by Gram-Schmidt orthonormalization of a Gaussian matrix. The determinant is +1 or -1 with equal probability. Works in place, with no allocation.
+void zrand_rng_orthogonal(zrand_rng *rng, float *out, size_t dim);
+/// Writes `count` matrices back to back (`dim * dim` floats each).
+void zrand_rng_orthogonal_batch(zrand_rng *rng, float *out, size_t dim, size_t count);
+
+#endif // ZRAND_SAMPLING
+
+/// @endgroup
+
+/// @section Stochastic Paths (ZRAND_PATHS)
+/// Opt-in (`#define ZRAND_PATHS`, uses `<math.h>`). Brownian, geometric Brownian and bridge paths for Monte Carlo pricing and diffusion. Paths advance in blocks of 64 that stay in L1, and each step's Gaussian increments are drawn as one batch with both Box-Muller outputs kept. The increments and path updates use zrand's own log, sin/cos and exp kernels (about 1 ulp), four lanes at a time with AVX2, and the uniforms behind them come from eight leapfrogged lanes of the generator's own stream. Scalar and SIMD builds produce the same paths. Draw order depends only on `npaths`, `nsteps` and `antithetic`, so path-major and time-major output from the same seed hold the same numbers.
+///
+/// @group Paths
+
+#ifdef ZRAND_PATHS
+
+/// Output layout for path generators. Every path has `nsteps + 1` points, including `t = 0`.
+typedef enum 
+{
+    ZRAND_PATH_MAJOR = 0,   // out[p * (nsteps + 1) + k]
+    ZRAND_TIME_MAJOR = 1    // out[k * npaths + p]
+} zrand_path_layout;
+
+/// Options shared by the path generators. Zero-initialize for path-major and no antithetics.
+typedef struct 
+{
+    zrand_path_layout layout;
+    bool antithetic;   // Paths 2i and 2i+1 use negated increments (variance reduction).
+} zrand_path_opts;
+
+/// Standard Brownian motion `W(0) = 0`, step `dt`, path-major. `out` holds `npaths * (nsteps + 1)` values.
+void zrand_rng_brownian_paths(zrand_rng *rng, size_t npaths, size_t nsteps, double dt, double *out);
+/// Arithmetic Brownian motion `dX = mu dt + sigma dW` from `x0`.
+void zrand_rng_brownian_paths_ex(zrand_rng *rng, size_t npaths, size_t nsteps, double dt, 
+                                 double x0, double mu, double sigma, const zrand_path_opts *opts, double *out);
+/// Geometric Brownian motion `dS = mu S dt + sigma S dW` from `s0`, stepped exactly in log space.
+void zrand_rng_gbm_paths(zrand_rng *rng, size_t npaths, size_t nsteps, double dt, 
+                         double s0, double mu, double sigma, const zrand_path_opts *opts, double *out);
+/// Brownian bridge with volatility `sigma` pinned to `a` at `t = 0` and `b` at `t = nsteps * dt`. Each step samples the exact conditional law given the current point and the endpoint.
+void zrand_rng_brownian_bridge(zrand_rng *rng, size_t npaths, size_t nsteps, double dt, 
+                               double a, double b, double sigma, const zrand_path_opts *opts, double *out);
+
+#endif // ZRAND_PATHS
+
+/// @endgroup
+
+/// @section Token Sampling (ZRAND_LOGITS)
+/// Opt-in (`#define ZRAND_LOGITS`, uses `<math.h>`). Draws an index from the softmax of a logit vector with temperature, top-k and top-p (nucleus) truncation, as in language-model decoding. The softmax is never materialized. One pass finds the maximum, a second sums `exp((logit - max) / T)` with a polynomial `exp` (8 lanes at a time with AVX2 when compiled for it), keeping one sum per 256-logit block. One uniform is then inverted by skipping whole blocks by their sums and rescanning a single block. Top-k is a bounded min-heap scan. Top-p runs a weighted quickselect over the tokens that can belong to the nucleus, those with probability at least `(1 - top_p) / (n - 1)`. Nothing is fully sorted.
+///
+/// @group Token Sampling
+
+#ifdef ZRAND_LOGITS
+
+/// Samples an index in `[0, n)` (`n >= 1`) from `softmax(logits / temperature)`. `temperature <= 0` returns the argmax without drawing; otherwise exactly one `zrand_rng_f64` is drawn. `top_k` keeps the `k` highest logits (`0` or `>= n`: no limit). `top_p` in `(0, 1)` then keeps the smallest set of most probable tokens whose mass reaches `top_p` (`>= 1`: no limit). Logits must be finite or `-INFINITY`; masked tokens are never drawn. Ties keep the lower index. Scratch lives on the stack up to 262144 logits and 256 candidates. If a larger scratch buffer cannot be allocated, the argmax is returned.
+size_t zrand_sample_logits(zrand_rng *rng, const float *logits, size_t n, float temperature, size_t top_k, float top_p);
+
+#endif // ZRAND_LOGITS
+
+/// @endgroup
+
+/// @section Producer Ring (ZRAND_PRODUCER)
+/// Opt-in (`#define ZRAND_PRODUCER`). A helper thread fills 64-byte aligned blocks of random `uint64_t` into a lock-free single-producer/single-consumer ring, so the consuming thread only pays for a load. Create one ring per consumer thread. When the ring is empty the consumer falls back to a private, OS-seeded PCG instance instead of waiting.
+///
+/// @group Producer Ring
+
+#ifdef ZRAND_PRODUCER
+
+#ifndef ZRAND_RING_BLOCK
+#   define ZRAND_RING_BLOCK 64 // uint64_t values per block (512 bytes).
+#endif
+
+/// Fills `out` with `n` random values. Called on the producer thread only.
+typedef void (*zrand_fill_fn)(void *ctx, uint64_t *out, size_t n);
+
+/// Opaque ring handle.
+typedef struct zrand_ring zrand_ring;
+
+/// Tuning counters for a ring.
+typedef struct 
+{
+    uint64_t popped;         // Values served from the ring.
+    uint64_t fallback;       // Values generated synchronously because the ring was empty.
+    uint64_t produced;       // Blocks published by the producer.
+    uint64_t producer_waits; // Times the producer found the ring full and backed off.
+    uint32_t occupancy;      // Blocks ready to be consumed right now.
+    uint32_t capacity;       // Total blocks in the ring.
+} zrand_ring_stats;
+
+/// Built-in backend: PCG stream. `ctx` must point to a `zrand_rng` owned by the ring.
+void zrand_fill_pcg(void *ctx, uint64_t *out, size_t n);
+
+/// Built-in backend: OS CSPRNG (`getrandom`, `/dev/urandom` or `rand_s`). `ctx` is unused.
+void zrand_fill_os(void *ctx, uint64_t *out, size_t n);
+
+/// Starts a producer thread for a ring of `nblocks` blocks. `fill`/`ctx` select the backend; pass `NULL` for an OS-seeded PCG stream. Returns `NULL` on failure.
+zrand_ring *zrand_ring_create(size_t nblocks, zrand_fill_fn fill, void *ctx);
+
+/// Stops the producer thread and frees the ring.
+void     zrand_ring_destroy(zrand_ring *ring);
+
+/// Pops a random 64-bit value (consumer thread only). Never blocks.
+uint64_t zrand_ring_pop_u64(zrand_ring *ring);
+
+/// Pops a `double` in `[0.0, 1.0)` (consumer thread only).
+double   zrand_ring_pop_f64(zrand_ring *ring);
+
+/// Reads the tuning counters. Consumer counters are exact when called from the consumer thread.
+void     zrand_ring_get_stats(zrand_ring *ring, zrand_ring_stats *out);
+
+#endif // ZRAND_PRODUCER
+
+/// @endgroup
+
+/// @section Shared Generator (ZRAND_SHARED)
+/// Opt-in (`#define ZRAND_SHARED`). One reproducible sequence that many threads can draw from without a lock. Output `i` is a keyed hash of the counter value `i` (SplitMix64 finalizer), so taking values is a single atomic `fetch_add`, and a batch of `k` values costs one `fetch_add` of `k`. The sequence of values is fixed by the seed; which thread receives which value depends on scheduling.
+///
+/// @group Shared Generator
+
+#ifdef ZRAND_SHARED
+
+/// Shared generator state, aligned to its own cache line.
+typedef struct 
+{
+    ZRAND_ALIGNED(64) uint64_t counter; // Next unreserved index (updated atomically).
+    uint64_t key;
+    uint8_t pad[48];
+} zrand_shared;
+
+/// Per-thread cursor over a reserved batch of a `zrand_shared` sequence.
+typedef struct 
+{
+    zrand_shared *shared;
+    uint64_t next;
+    uint64_t end;
+    uint32_t batch;
+} zrand_shared_cursor;
+
+/// Initializes a shared generator. Not thread-safe; call before sharing it.
+void     zrand_shared_init(zrand_shared *sh, uint64_t seed);
+
+/// Returns output number `index` of the sequence. Pure function; does not touch the counter.
+uint64_t zrand_shared_at(const zrand_shared *sh, uint64_t index);
+
+/// Reserves `k` consecutive indices and returns the first one.
+uint64_t zrand_shared_reserve(zrand_shared *sh, uint64_t k);
+
+/// Takes the next value from the sequence (one atomic `fetch_add`).
+uint64_t zrand_shared_u64(zrand_shared *sh);
+
+/// Reserves `n` values at once and writes them to `out`.
+void     zrand_shared_fill_u64(zrand_shared *sh, uint64_t *out, size_t n);
+
+/// Binds a per-thread cursor that reserves `batch` values at a time.
+void     zrand_shared_cursor_init(zrand_shared_cursor *cur, zrand_shared *sh, uint32_t batch);
+
+/// Takes the next value through a cursor; touches the shared counter once per batch.
+uint64_t zrand_shared_cursor_u64(zrand_shared_cursor *cur);
+
+#endif // ZRAND_SHARED
+
+/// @endgroup
+
+/// @section Parallel Monte Carlo (ZRAND_PARALLEL)
+/// Opt-in (`#define ZRAND_PARALLEL`). Splits `[0, n)` into chunks of `chunk` items and runs them on a pool of threads. Each chunk receives its own generator: the state is seeded with a SplitMix64 hash of `seed` and the chunk index, and the stream (`seq`) is the chunk index, so the values a chunk sees depend only on `(seed, chunk index)` and results are bit-identical for any thread count.
+///
+/// @group Parallel
+
+#ifdef ZRAND_PARALLEL
+
+/// Processes items `[begin, end)` of one chunk using `rng`.
+typedef void (*zrand_task_fn)(void *ctx, size_t begin, size_t end, zrand_rng *rng);
+
+/// Runs `fn` over all chunks using one thread per online CPU. Returns when every chunk is done.
+void zrand_parallel_for(size_t n, size_t chunk, uint64_t seed, zrand_task_fn fn, void *ctx);
+
+/// Same as `zrand_parallel_for` with an explicit thread count (`0` = one per online CPU).
+void zrand_parallel_for_ex(size_t n, size_t chunk, uint64_t seed, zrand_task_fn fn, void *ctx, unsigned nthreads);
+
+#endif // ZRAND_PARALLEL
+
+/// @endgroup
+
+/// @section Instrumentation (ZRAND_STATS, ZRAND_TRACE)
+/// Opt-in diagnostics for the global and `zrand_rng` APIs. Both are per-thread: each thread writes only its own cache-line-aligned block, so instrumenting never touches a line another thread writes. Without the defines the hooks compile to nothing.
+///
+/// @group API Ids
+
+/// Public entry points, as counted by `ZRAND_STATS` and tagged by `ZRAND_TRACE`. A global function and its `zrand_rng_*` counterpart share an id.
+typedef enum 
+{
+    ZRAND_API_U32,
+    ZRAND_API_U64,
+    ZRAND_API_F32,
+    ZRAND_API_F64,
+    ZRAND_API_BOOL,
+    ZRAND_API_CHANCE,
+    ZRAND_API_RANGE,
+    ZRAND_API_RANGE_F,
+    ZRAND_API_GAUSSIAN,
+    ZRAND_API_BYTES,
+    ZRAND_API_STR,
+    ZRAND_API_UUID,
+    ZRAND_API_SHUFFLE,
+    ZRAND_API_CHOICE,
+    ZRAND_API_COUNT
+} zrand_api_id;
+
+#if defined(ZRAND_STATS) || defined(ZRAND_TRACE)
+
+/// Returns the global function name of an API id (e.g. `"zrand_range"`).
+const char *zrand_api_name(zrand_api_id api);
+
+#endif
+
+/// @endgroup
+/// @group Counters (ZRAND_STATS)
+///
+/// Each thread counts its global API calls, engine steps, rejection-loop retries and reseeds. `zrand_stats_snapshot()` sums the blocks of all live threads plus the totals left by threads that have exited.
+
+#ifdef ZRAND_STATS
+
+/// Aggregated counters.
+typedef struct 
+{
+    uint64_t calls[ZRAND_API_COUNT]; // Global API calls, indexed by `zrand_api_id`.
+    uint64_t steps;            // Engine steps: PCG, bank lanes, buffered lanes, leapfrog, MCG, tiny.
+    uint64_t range_retries;    // Rejected draws in the `*_range` functions.
+    uint64_t gaussian_retries; // Rejected pairs in the polar Gaussian sampler.
+    uint64_t reseeds;          // OS reseeds of the thread-local generator (`zrand_init`).
+    uint64_t threads;          // Threads that have counted anything.
+} zrand_stats;
+
+/// Writes the sum over all threads to `out`. Counters are read without stopping their owners: while other threads draw, each field is a lower bound and the fields are not read at one instant.
+void        zrand_stats_snapshot(zrand_stats *out);
+
+#endif // ZRAND_STATS
+
+/// @endgroup
+/// @group Record / Replay (ZRAND_TRACE)
+///
+/// Logs every 32-bit draw made through the global API or a `zrand_rng` as `(api id, generator id, output)` into a per-thread ring of `ZRAND_TRACE_RING` records (default 4096). A full ring is drained by its owner; `zrand_trace_flush()` and `zrand_trace_stop()` drain every ring without stopping the writers (single-producer, single-consumer). Records are 8 bytes: the output, the API id, and a 24-bit generator id (`0` for the thread-local generator, otherwise derived from the `zrand_rng` address).
+///
+/// In replay mode the `n`-th thread to draw receives the draws recorded by the `n`-th recording thread, in order. When threads start concurrently that first-draw order is itself a race, so each thread can instead call `zrand_trace_bind(tag)` with a stable tag (a worker index, say) before its first draw: it then records and replays the stream keyed by that tag, whatever order the threads start in. Derived values (ranges, floats, Gaussians, UUIDs, shuffles) are rebuilt from the replayed words, so they come out identical. A draw whose API id differs from the next record, or that runs past the end, switches that thread back to live output and counts one divergence. Generators still step during replay, so instance streams stay in sync with the recording.
+///
+/// Start and stop a session while no other thread is drawing. The compact generators, banks, leapfrog views and the opt-in modules' own engines are not traced.
+
+#ifdef ZRAND_TRACE
+
+/// Starts recording to `path` (truncated). Returns `false` if a session is active or the file cannot be created.
+bool     zrand_trace_record(const char *path);
+
+/// Starts replaying the trace at `path`. Returns `false` if a session is active or the file is not a valid trace.
+bool     zrand_trace_replay(const char *path);
+
+/// Writes the records buffered by every thread to the trace file.
+void     zrand_trace_flush(void);
+
+/// Ends the session: flushes and closes a recording, or releases a replay.
+void     zrand_trace_stop(void);
+
+/// Returns the number of threads that diverged from the replayed trace in the current (or last) replay.
+uint64_t zrand_trace_divergences(void);
+
+/// Keys the calling thread's recorded and replayed stream by `tag` (below 2^31) instead of the order of its first draw, in this and later sessions. Call it before the thread's first draw; a later call starts a new stream from the next draw on. Returns `false` if `tag` is out of range.
+bool     zrand_trace_bind(uint32_t tag);
+
+#endif // ZRAND_TRACE
+
+/// @endgroup
+
+/// @section Recorded Streams (ZRAND_MMAP_STREAM)
+/// Opt-in (`#define ZRAND_MMAP_STREAM`). Pre-generates random 64-bit values to a file once, then reads them back through a read-only memory mapping, so benchmark input costs one load per value and is identical on every machine that reads the file. A file is a 64-byte header (magic `ZRSTRM01`, version, engine, seed, count) followed by `count` values in host byte order (little-endian on every supported target). POSIX mappings are advised `MADV_SEQUENTIAL`, plus `MADV_HUGEPAGE` where the kernel has it (huge pages for file mappings depend on the filesystem, e.g. a tmpfs mounted with `huge=`). On Windows the file is mapped with `MapViewOfFile`.
+///
+/// @group Recorded Streams
+
+#ifdef ZRAND_MMAP_STREAM
+
+/// Source a recorded stream is generated from, stored in the file header.
+typedef enum 
+{
+    ZRAND_MMAP_PCG = 1, // `zrand_rng_u64` of `zrand_rng_init(seed, 0)`; reproducible from the header.
+    ZRAND_MMAP_OS  = 2  // OS CSPRNG; only the file reproduces it, `seed` is informational.
+} zrand_mmap_engine;
+
+/// Reader over a mapped stream. Fields are read-only; `pos` and `wraps` advance as values are read.
+typedef struct 
+{
+    const uint64_t *data; // `count` recorded values, inside the mapping.
+    uint64_t count;
+    uint64_t pos;         // Index of the next value.
+    uint64_t wraps;       // Times reading passed the end and restarted at index 0.
+    uint64_t seed;
+    uint32_t engine;      // A `zrand_mmap_engine`.
+    void *map;            // Whole mapping (header + values).
+    size_t map_size;
+} zrand_mmap_stream;
+
+/// Writes `count` values (`count > 0`) from `engine` to `path` (truncated). Returns `false` on I/O failure, leaving no file behind.
+bool     zrand_mmap_stream_write(const char *path, zrand_mmap_engine engine, uint64_t seed, uint64_t count);
+
+/// Maps the stream at `path`. With `preload`, every page is faulted in now so the first pass does not pay for page faults. Returns `false` if the file cannot be mapped or is not a valid stream.
+bool     zrand_mmap_stream_open(zrand_mmap_stream *s, const char *path, bool preload);
+
+/// Unmaps the stream.
+void     zrand_mmap_stream_close(zrand_mmap_stream *s);
+
+/// Moves the reader to value `index % count`.
+void     zrand_mmap_stream_seek(zrand_mmap_stream *s, uint64_t index);
+
+/// Copies the next `n` values to `out`, wrapping at the end like `zrand_mmap_stream_next_u64`.
+void     zrand_mmap_stream_fill_u64(zrand_mmap_stream *s, uint64_t *out, size_t n);
+
+/// Returns the next recorded value. Past the last value the stream restarts at index 0 and `wraps` is incremented. `static inline`, so a read is a compare and a load.
+static inline uint64_t zrand_mmap_stream_next_u64(zrand_mmap_stream *s) 
+{
+    if (s->pos == s->count) 
+    {
+        s->pos = 0;
+        s->wraps++;
+    }
+    return s->data[s->pos++];
+}
+
+/// Returns the next recorded value as a `double` in `[0.0, 1.0)`.
+static inline double zrand_mmap_stream_next_f64(zrand_mmap_stream *s) 
+{
+    return (zrand_mmap_stream_next_u64(s) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+#endif // ZRAND_MMAP_STREAM
+
+/// @endgroup
+
+// Optional short names.
+#ifdef ZRAND_SHORT_NAMES
+#   define rand_init       zrand_init
+#   define rand_local      zrand_local
+#   define rand_u32        zrand_u32
+#   define rand_u64        zrand_u64
+#   define rand_f32        zrand_f32
+#   define rand_f64        zrand_f64
+#   define rand_bool       zrand_bool
+#   define rand_range      zrand_range
+#   define rand_range_f    zrand_range_f
+#   define rand_chance     zrand_chance
+#   define rand_gaussian   zrand_gaussian
+#   define rand_bytes      zrand_bytes
+#   define rand_str        zrand_str
+#   define rand_uuid       zrand_uuid
+#   define rand_shuffle    zrand_shuffle
+#   define rand_choice     zrand_choice
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+// C++ API.
+
+#ifdef __cplusplus
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <limits> 
+#include <type_traits>
+
+namespace z_rand 
+{
+    /// @section API Reference (C++)
+    ///
+    /// The C++ wrapper is defined in the **`z_rand`** namespace.
+    ///
+    /// @table Global Shortcuts
+    /// @row `z_rand::init()` | Wraps `zrand_init`.
+    /// @row `z_rand::local()` | Wraps `zrand_local` (this thread's `zrand_rng*`).
+    /// @row `z_rand::u32()`, `u64()` | Returns random integers.
+    /// @row `z_rand::f32()`, `f64()` | Returns random floating point numbers.
+    /// @row `z_rand::boolean()` | Returns boolean.
+    /// @row `z_rand::chance(prob)` | Returns true based on probability.
+    /// @row `z_rand::range(min, max)` | Returns value in range (overloaded for `int` and `float`).
+    /// @row `z_rand::gaussian(mean, std)`| Returns normally distributed value.
+    /// @row `z_rand::uuid()` | Returns a standard `std::string` containing a UUID v4.
+    /// @row `z_rand::string(len)` | Returns a standard `std::string` of random alphanumeric characters.
+    /// @row `z_rand::shuffle(vector)` | Shuffles a `std::vector` (or `z_vec::vector`) in-place.
+    /// @row `z_rand::choice(vector)` | Returns a random element (const ref) from the vector.
+    /// @endgroup
+    
+    // Global shortcuts.
+    inline void init()
+    {
+        ::zrand_init();
+    }
+
+    inline zrand_rng *local()
+    {
+        return ::zrand_local();
+    }
+
+    inline uint32_t u32()
+    {
+        return ::zrand_u32();
+    }
+
+    inline uint64_t u64()
+    {
+        return ::zrand_u64();
+    }
+
+    inline float f32()
+    {
+        return ::zrand_f32();
+    }
+
+    inline double f64()
+    {
+        return ::zrand_f64();
+    }
+
+    inline bool boolean()
+    {
+        return ::zrand_bool();
+    }
+    
+    inline bool chance(double prob)
+    {
+        return ::zrand_chance(prob);
+    }
+    
+    inline int32_t range(int32_t min, int32_t max)
+    {
+        return ::zrand_range(min, max);
+    }
+
+    inline float range(float min, float max)
+    {
+        return ::zrand_range_f(min, max);
+    }
+    
+    inline double gaussian(double mean, double stddev)
+    {
+        return ::zrand_gaussian(mean, stddev);
+    }
+
+    inline std::string uuid() 
+    {
+        char buf[37];
+        ::zrand_uuid(buf);
+        return std::string(buf);
+    }
+
+    inline std::string string(size_t len) 
+    {
+        std::string s; 
+        s.resize(len);
+        ::zrand_str(&s[0], len); 
+        return s;
+    }
+
+    template<typename T>
+    inline void shuffle(std::vector<T> &v) 
+    {
+        if (!v.empty())
+        {
+            ::zrand_shuffle(v.data(), v.size(), sizeof(T));
+        }
+    }
+    
+    template<typename T>
+    inline const T &choice(const std::vector<T>& v) 
+    {
+        const void *ptr = ::zrand_choice((void*)v.data(), v.size(), sizeof(T));
+        return *(const T*)ptr;
+    }
+    
+#ifdef ZRAND_PARALLEL
+    /// @subsection Parallel Monte Carlo
+    ///
+    /// `z_rand::parallel_for(n, chunk, seed, fn)` wraps `zrand_parallel_for`. `fn` is called as `fn(begin, end, zrand_rng *rng)` and may run concurrently on several threads.
+    template<typename F>
+    inline void parallel_for(size_t n, size_t chunk, uint64_t seed, F &&fn, unsigned nthreads = 0)
+    {
+        struct tramp
+        {
+            static void call(void *ctx, size_t begin, size_t end, zrand_rng *rng)
+            {
+                (*(typename std::remove_reference<F>::type*)ctx)(begin, end, rng);
+            }
+        };
+        ::zrand_parallel_for_ex(n, chunk, seed, &tramp::call, (void*)&fn, nthreads);
+    }
+#endif
+
+    /// @subsection Deterministic Generator
+    ///
+    /// The `z_rand::generator` class wraps the C struct state (`zrand_rng`). It provides methods matching the global API (`u32`, `f32`, `boolean`, `range`, `chance`, `gaussian`, `bytes`, `uuid`, `string`, `shuffle`, `choice`) but operates on its own internal state. `get()` exposes the underlying `zrand_rng*` for the C API.
+    ///
+    /// @example cpp
+    /// // Seed 1234, Sequence 1.
+    /// z_rand::generator rng(1234);
+    ///
+    /// int hp = rng.range(50, 100);
+    /// bool has_key = rng.chance(0.25);
+    /// @endexample
+
+    // Generator instance (for reproducible seeds).
+    class generator 
+    {
+        zrand_rng rng;
+     public:
+        using result_type = uint32_t;
+        static constexpr result_type min()
+        {
+            return 0;
+        }
+
+        static constexpr result_type max()
+        {
+            return 0xFFFFFFFF;
+        }
+        
+        result_type operator()()
+        {
+            return ::zrand_rng_u32(&rng);
+        }
+
+        generator() 
+        { 
+            ::zrand_rng_init(&rng, ::zrand_u64(), ::zrand_u64()); 
+        }
+
+        generator(uint64_t seed, uint64_t seq = 1) 
+        { 
+            ::zrand_rng_init(&rng, seed, seq); 
+        }
+
+        uint32_t u32()
+        {
+            return operator()();
+        }
+
+        uint64_t u64()
+        {
+            return ::zrand_rng_u64(&rng);
+        }
+
+        double f64()
+        {
+            return ::zrand_rng_f64(&rng);
+        }
+
+        int32_t range(int32_t min, int32_t max)
+        {
+            return ::zrand_rng_range(&rng, min, max);
+        }
+
+        float f32()
+        {
+            return ::zrand_rng_f32(&rng);
+        }
+
+        bool boolean()
+        {
+            return ::zrand_rng_bool(&rng);
+        }
+
+        float range(float min, float max)
+        {
+            return ::zrand_rng_range_f(&rng, min, max);
+        }
+
+        bool chance(double p)
+        {
+            return ::zrand_rng_chance(&rng, p);
+        }
+
+        double gaussian(double m, double s)
+        {
+            return ::zrand_rng_gaussian(&rng, m, s);
+        }
+
+        void bytes(void *buf, size_t len)
+        {
+            ::zrand_rng_bytes(&rng, buf, len);
+        }
+
+        std::string uuid()
+        {
+            char buf[37];
+            ::zrand_rng_uuid(&rng, buf);
+            return std::string(buf);
+        }
+
+        std::string string(size_t len)
+        {
+            std::string s;
+            s.resize(len);
+            ::zrand_rng_str(&rng, &s[0], len);
+            return s;
+        }
+
+        template<typename T>
+        void shuffle(std::vector<T> &v)
+        {
+            if (!v.empty())
+            {
+                ::zrand_rng_shuffle(&rng, v.data(), v.size(), sizeof(T));
+            }
+        }
+
+        template<typename T>
+        const T &choice(const std::vector<T> &v)
+        {
+            const void *ptr = ::zrand_rng_choice(&rng, (void*)v.data(), v.size(), sizeof(T));
+            return *(const T*)ptr;
+        }
+
+        void advance(uint64_t delta)
+        {
+            ::zrand_rng_advance(&rng, delta);
+        }
+
+        void partition(uint64_t rank, uint64_t nranks, uint64_t block_size = 0)
+        {
+            ::zrand_rng_partition(&rng, rank, nranks, block_size);
+        }
+
+        zrand_rng *get()
+        {
+            return &rng;
+        }
+    };
+}
+#endif // __cplusplus
+
+#endif // ZRAND_H
+
+#ifdef ZRAND_IMPLEMENTATION
+#ifndef ZRAND_IMPLEMENTATION_GUARD
+#define ZRAND_IMPLEMENTATION_GUARD
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef ZMATH_IMPLEMENTATION
+#   define ZMATH_IMPLEMENTATION
+#   define ZMATH_NO_LIBC 
+#endif
+#if defined(__has_include) && __has_include("zmath.h")
+#   include "zmath.h"
+#else
+    // For now we assume the user has provided zmath.h or the compiler can find standard math.
+#   include <math.h>
+#   ifndef zmath_sqrt
+#       define zmath_sqrt sqrt
+#       define zmath_log  log
+#   endif
+#endif
+
+// OS entropy source.
+#ifdef _WIN32
 #   define _CRT_RAND_S
 #   include <stdlib.h>
     static uint64_t zrand__os_seed(void) 
     {
-        unsigned int s1, s2;
-        rand_s(&s1); 
-        rand_s(&s2);
-        return ((uint64_t)s1 << 32) | s2;
+        unsigned int s1, s2;
+        rand_s(&s1); 
+        rand_s(&s2);
+        return ((uint64_t)s1 << 32) | s2;
+    }
+#else
+#   include <stdio.h>
+    static uint64_t zrand__os_seed(void) 
+    {
+        uint64_t seed = 0;
+        FILE *f = fopen("/dev/urandom", "rb");
+        if (f) 
+        {
+            size_t n = fread(&seed, sizeof(seed), 1, f);
+            fclose(f);
+            if (1 == n)
+            {
+                return seed;
+            }
+        }
+        return (uint64_t)time(NULL) ^ (uintptr_t)&seed;
+    }
+#endif
+
+// Bulk OS entropy (the producer's OS backend, recorded OS streams).
+#if defined(ZRAND_PRODUCER) || defined(ZRAND_MMAP_STREAM)
+#if defined(__linux__)
+#   include <sys/random.h>
+#endif
+
+static void zrand__os_fill(void *buf, size_t len) 
+{
+    uint8_t *p = (uint8_t*)buf;
+#if defined(__linux__)
+    while (len > 0) 
+    {
+        ssize_t got = getrandom(p, len, 0);
+        if (got <= 0) 
+        {
+            break;
+        }
+        p += got;
+        len -= (size_t)got;
+    }
+#elif !defined(_WIN32)
+    FILE *f = fopen("/dev/urandom", "rb");
+    if (f) 
+    {
+        size_t got = fread(p, 1, len, f);
+        fclose(f);
+        p += got;
+        len -= got;
+    }
+#endif
+    // Windows, or the entropy source failed: `rand_s` / the seeding fallback.
+    while (len > 0) 
+    {
+        uint64_t v = zrand__os_seed();
+        size_t k = len < sizeof(v) ? len : sizeof(v);
+        memcpy(p, &v, k);
+        p += k;
+        len -= k;
+    }
+}
+#endif
+
+// Thread local state.
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#   include <threads.h>
+#   define ZRAND_TLS _Thread_local
+#elif defined(_MSC_VER)
+#   define ZRAND_TLS __declspec(thread)
+#elif defined(__GNUC__)
+#   define ZRAND_TLS __thread
+#else
+#   define ZRAND_TLS
+#endif
+
+// Define ZRAND_TLS_INITIAL_EXEC when zrand is built into a shared library
+// that is loaded at startup (not dlopen'ed later): the thread-local state is
+// then addressed with a fixed offset instead of a __tls_get_addr call.
+#if defined(ZRAND_TLS_INITIAL_EXEC) && (defined(__GNUC__) || defined(__clang__))
+#   define ZRAND_TLS_MODEL __attribute__((tls_model("initial-exec")))
+#else
+#   define ZRAND_TLS_MODEL
+#endif
+
+// Per-thread instrumentation (ZRAND_STATS, ZRAND_TRACE).
+// Each feature keeps one 64-byte-aligned heap block per thread, linked into
+// a registry under `zrand__hooks_lock`. Blocks are written by their owner
+// only; other threads read them with relaxed or acquire loads. A thread-exit
+// callback (pthread key / FLS) folds the block back and frees it.
+
+#if defined(ZRAND_STATS) || defined(ZRAND_TRACE)
+#   define ZRAND__HOOKS
+#endif
+
+#ifdef ZRAND__HOOKS
+
+#if defined(_WIN32)
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   include <windows.h>
+    static SRWLOCK zrand__hooks_lock = SRWLOCK_INIT;
+    static INIT_ONCE zrand__hooks_once = INIT_ONCE_STATIC_INIT;
+    static DWORD zrand__hooks_key = FLS_OUT_OF_INDEXES;
+#   define ZRAND__HOOKS_LOCK()   AcquireSRWLockExclusive(&zrand__hooks_lock)
+#   define ZRAND__HOOKS_UNLOCK() ReleaseSRWLockExclusive(&zrand__hooks_lock)
+#else
+#   include <pthread.h>
+    static pthread_mutex_t zrand__hooks_lock = PTHREAD_MUTEX_INITIALIZER;
+    static pthread_once_t zrand__hooks_once = PTHREAD_ONCE_INIT;
+    static pthread_key_t zrand__hooks_key;
+    static bool zrand__hooks_key_ok = false;
+#   define ZRAND__HOOKS_LOCK()   pthread_mutex_lock(&zrand__hooks_lock)
+#   define ZRAND__HOOKS_UNLOCK() pthread_mutex_unlock(&zrand__hooks_lock)
+#endif
+
+static ZRAND_TLS bool zrand__hooks_attached ZRAND_TLS_MODEL = false;
+
+static inline uint64_t zrand__hook_load(const uint64_t *p) 
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+#else
+    return *(const volatile uint64_t*)p;
+#endif
+}
+
+static inline uint64_t zrand__hook_load_acq(const uint64_t *p) 
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#else
+    // x86/x64 only: TSO gives acquire/release for aligned accesses.
+    uint64_t v = *(const volatile uint64_t*)p;
+    _ReadWriteBarrier();
+    return v;
+#endif
+}
+
+static inline void zrand__hook_store_rel(uint64_t *p, uint64_t v) 
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#else
+    _ReadWriteBarrier();
+    *(volatile uint64_t*)p = v;
+#endif
+}
+
+const char *zrand_api_name(zrand_api_id api) 
+{
+    static const char *names[ZRAND_API_COUNT] = 
+    {
+        "zrand_u32", "zrand_u64", "zrand_f32", "zrand_f64", "zrand_bool", "zrand_chance", "zrand_range",
+        "zrand_range_f", "zrand_gaussian", "zrand_bytes", "zrand_str", "zrand_uuid", "zrand_shuffle", "zrand_choice"
+    };
+    return ((unsigned)api < ZRAND_API_COUNT) ? names[api] : "?";
+}
+
+static void zrand__hooks_thread_exit(void);
+
+#if defined(_WIN32)
+static void WINAPI zrand__hooks_fls_cb(void *p) 
+{
+    if (p) 
+    {
+        zrand__hooks_thread_exit();
+    }
+}
+
+static BOOL CALLBACK zrand__hooks_once_cb(PINIT_ONCE once, PVOID param, PVOID *ctx) 
+{
+    (void)once; (void)param; (void)ctx;
+    zrand__hooks_key = FlsAlloc(zrand__hooks_fls_cb);
+    return TRUE;
+}
+
+static bool zrand__hooks_set_key(void) 
+{
+    InitOnceExecuteOnce(&zrand__hooks_once, zrand__hooks_once_cb, NULL, NULL);
+    return FLS_OUT_OF_INDEXES != zrand__hooks_key && FlsSetValue(zrand__hooks_key, (void*)&zrand__hooks_key);
+}
+#else
+static void zrand__hooks_key_cb(void *p) 
+{
+    (void)p;
+    zrand__hooks_thread_exit();
+}
+
+static void zrand__hooks_once_cb(void) 
+{
+    zrand__hooks_key_ok = (0 == pthread_key_create(&zrand__hooks_key, zrand__hooks_key_cb));
+}
+
+static bool zrand__hooks_set_key(void) 
+{
+    pthread_once(&zrand__hooks_once, zrand__hooks_once_cb);
+    return zrand__hooks_key_ok && 0 == pthread_setspecific(zrand__hooks_key, (void*)&zrand__hooks_key);
+}
+#endif
+
+// Arms the thread-exit callback for this thread. Without it a registered
+// block would dangle once the thread is gone, so callers fall back on failure.
+static bool zrand__hooks_attach(void) 
+{
+    if (!zrand__hooks_attached) 
+    {
+        zrand__hooks_attached = zrand__hooks_set_key();
+    }
+    return zrand__hooks_attached;
+}
+
+// Returns a zeroed, 64-byte-aligned block; `*raw` receives the pointer to free.
+static void *zrand__hooks_alloc(size_t size, void **raw) 
+{
+    *raw = malloc(size + 63);
+    if (!*raw) 
+    {
+        return NULL;
+    }
+    void *p = (void*)(((uintptr_t)*raw + 63) & ~(uintptr_t)63);
+    memset(p, 0, size);
+    return p;
+}
+
+#endif // ZRAND__HOOKS
+
+// Instrumentation counters (ZRAND_STATS).
+// Owners update with a relaxed load + store (no locked instruction).
+
+#ifdef ZRAND_STATS
+
+// Counter slots: the per-API call counts, then the engine-level counters.
+enum 
+{
+    ZRAND__STAT_STEPS = ZRAND_API_COUNT,
+    ZRAND__STAT_RANGE_RETRIES,
+    ZRAND__STAT_GAUSSIAN_RETRIES,
+    ZRAND__STAT_RESEEDS,
+    ZRAND__STAT_WORDS
+};
+
+typedef struct zrand__stat_block 
+{
+    ZRAND_ALIGNED(64) uint64_t w[ZRAND__STAT_WORDS];
+    struct zrand__stat_block *prev;
+    struct zrand__stat_block *next;
+    void *raw;
+} zrand__stat_block;
+
+static zrand__stat_block *zrand__stats_live = NULL;
+static uint64_t zrand__stats_retired[ZRAND__STAT_WORDS];
+static uint64_t zrand__stats_threads = 0;
+// Shared fallback when a block cannot be set up; counts may be lost, never corrupted.
+static zrand__stat_block zrand__stats_spare;
+static ZRAND_TLS zrand__stat_block *zrand__stats_tls ZRAND_TLS_MODEL = NULL;
+
+static inline void zrand__stat_bump(uint64_t *p, uint64_t n) 
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(p, __atomic_load_n(p, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+#else
+    *(volatile uint64_t*)p += n;
+#endif
+}
+
+static void zrand__stats_retire(void) 
+{
+    zrand__stat_block *b = zrand__stats_tls;
+    zrand__stats_tls = NULL;
+    if (!b || &zrand__stats_spare == b) 
+    {
+        return;
+    }
+    ZRAND__HOOKS_LOCK();
+    for (int i = 0; i < ZRAND__STAT_WORDS; i++) 
+    {
+        zrand__stats_retired[i] += b->w[i];
+    }
+    if (b->prev) 
+    {
+        b->prev->next = b->next;
+    }
+    else
+    {
+        zrand__stats_live = b->next;
+    }
+    if (b->next) 
+    {
+        b->next->prev = b->prev;
+    }
+    ZRAND__HOOKS_UNLOCK();
+    free(b->raw);
+}
+
+static zrand__stat_block *zrand__stats_register(void) 
+{
+    void *raw;
+    zrand__stat_block *b = (zrand__stat_block*)zrand__hooks_alloc(sizeof(zrand__stat_block), &raw);
+    if (!b || !zrand__hooks_attach()) 
+    {
+        free(raw);
+        zrand__stats_tls = &zrand__stats_spare;
+        return zrand__stats_tls;
+    }
+    b->raw = raw;
+    ZRAND__HOOKS_LOCK();
+    b->next = zrand__stats_live;
+    if (zrand__stats_live) 
+    {
+        zrand__stats_live->prev = b;
+    }
+    zrand__stats_live = b;
+    zrand__stats_threads++;
+    ZRAND__HOOKS_UNLOCK();
+    zrand__stats_tls = b;
+    return b;
+}
+
+static inline zrand__stat_block *zrand__stats_local(void) 
+{
+    zrand__stat_block *b = zrand__stats_tls;
+    return b ? b : zrand__stats_register();
+}
+
+#   define ZRAND__STAT(slot, n) zrand__stat_bump(&zrand__stats_local()->w[slot], (uint64_t)(n))
+
+void zrand_stats_snapshot(zrand_stats *out) 
+{
+    uint64_t sum[ZRAND__STAT_WORDS];
+    ZRAND__HOOKS_LOCK();
+    memcpy(sum, zrand__stats_retired, sizeof(sum));
+    for (zrand__stat_block *b = zrand__stats_live; b; b = b->next) 
+    {
+        for (int i = 0; i < ZRAND__STAT_WORDS; i++) 
+        {
+            sum[i] += zrand__hook_load(&b->w[i]);
+        }
+    }
+    for (int i = 0; i < ZRAND__STAT_WORDS; i++) 
+    {
+        sum[i] += zrand__hook_load(&zrand__stats_spare.w[i]);
+    }
+    out->threads = zrand__stats_threads;
+    ZRAND__HOOKS_UNLOCK();
+    memcpy(out->calls, sum, sizeof(out->calls));
+    out->steps = sum[ZRAND__STAT_STEPS];
+    out->range_retries = sum[ZRAND__STAT_RANGE_RETRIES];
+    out->gaussian_retries = sum[ZRAND__STAT_GAUSSIAN_RETRIES];
+    out->reseeds = sum[ZRAND__STAT_RESEEDS];
+}
+
+#else
+#   define ZRAND__STAT(slot, n) ((void)0)
+#endif // ZRAND_STATS
+
+// PCG implementation details.
+
+static uint32_t zrand__pcg32(zrand_rng *rng) 
+{
+    ZRAND__STAT(ZRAND__STAT_STEPS, 1);
+    uint64_t oldstate = rng->state;
+    rng->state = oldstate * 6364136223846793005ULL + (rng->inc | 1);
+    uint32_t xorshifted = (uint32_t)(((oldstate >> 18u) ^ oldstate) >> 27u);
+    uint32_t rot = (uint32_t)(oldstate >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+void zrand_rng_init(zrand_rng *rng, uint64_t seed, uint64_t seq) 
+{
+    rng->state = 0U;
+    rng->inc = (seq << 1u) | 1u;
+    zrand__pcg32(rng);
+    rng->state += seed;
+    zrand__pcg32(rng);
+}
+
+// LCG jump-ahead (Brown, "Random Number Generation with Arbitrary Strides").
+// Computes the multiplier and increment of `delta` combined LCG steps.
+static void zrand__lcg_jump(uint64_t delta, uint64_t mult, uint64_t plus, uint64_t *out_mult, uint64_t *out_plus) 
+{
+    uint64_t acc_mult = 1u;
+    uint64_t acc_plus = 0u;
+    while (delta > 0) 
+    {
+        if (delta & 1) 
+        {
+            acc_mult *= mult;
+            acc_plus = acc_plus * mult + plus;
+        }
+        plus = (mult + 1) * plus;
+        mult *= mult;
+        delta >>= 1;
+    }
+    *out_mult = acc_mult;
+    *out_plus = acc_plus;
+}
+
+void zrand_rng_advance(zrand_rng *rng, uint64_t delta) 
+{
+    uint64_t mult, plus;
+    zrand__lcg_jump(delta, 6364136223846793005ULL, rng->inc | 1, &mult, &plus);
+    rng->state = rng->state * mult + plus;
+}
+
+// 2^64 / n without overflowing (0 for n <= 1).
+static uint64_t zrand__even_block(uint64_t n) 
+{
+    if (n <= 1) 
+    {
+        return 0;
+    }
+    uint64_t block = ((uint64_t)-1) / n;
+    if (((uint64_t)-1) % n == n - 1) 
+    {
+        block++;
+    }
+    return block;
+}
+
+// SplitMix64 finalizer. Derives per-lane or per-chunk seeds (PCG streams that
+// share a state seed and differ only in the increment are correlated) and
+// finishes zrand_shared's counter-based outputs.
+static uint64_t zrand__mix64(uint64_t z) 
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void zrand_rng_partition(zrand_rng *rng, uint64_t rank, uint64_t nranks, uint64_t block_size) 
+{
+    if (0 == block_size) 
+    {
+        block_size = zrand__even_block(nranks);
+    }
+    zrand_rng_advance(rng, rank * block_size);
+}
+
+void zrand_leapfrog_init(zrand_leapfrog *lf, const zrand_rng *rng, uint64_t rank, uint64_t nranks) 
+{
+    zrand_rng start = *rng;
+    zrand_rng_advance(&start, rank);
+    lf->state = start.state;
+    zrand__lcg_jump(nranks ? nranks : 1, 6364136223846793005ULL, rng->inc | 1, &lf->mult, &lf->plus);
+}
+
+uint32_t zrand_leapfrog_u32(zrand_leapfrog *lf) 
+{
+    ZRAND__STAT(ZRAND__STAT_STEPS, 1);
+    uint64_t oldstate = lf->state;
+    lf->state = oldstate * lf->mult + lf->plus;
+    uint32_t xorshifted = (uint32_t)(((oldstate >> 18u) ^ oldstate) >> 27u);
+    uint32_t rot = (uint32_t)(oldstate >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+uint64_t zrand_leapfrog_u64(zrand_leapfrog *lf) 
+{
+    uint64_t hi = zrand_leapfrog_u32(lf);
+    return (hi << 32) | zrand_leapfrog_u32(lf);
+}
+
+double zrand_leapfrog_f64(zrand_leapfrog *lf) 
+{
+    return (zrand_leapfrog_u64(lf) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Thread local state.
+
+static ZRAND_TLS zrand_rng zrand_global ZRAND_TLS_MODEL = {0x853C49E6748FEA9BULL, 0xDA3E39CB94B95BDBULL};
+static ZRAND_TLS bool zrand_seeded ZRAND_TLS_MODEL = false;
+
+static inline zrand_rng* zrand__get(void) 
+{
+    if (!zrand_seeded) 
+    {
+        zrand_init();
+    }
+    return &zrand_global;
+}
+
+// Draw tracing (ZRAND_TRACE).
+// Every traced 32-bit draw passes through ZRAND__TRACE(gen, api, value). In
+// record mode the owner appends to its ring and publishes `head` with a
+// release store; the drainer (owner when full, or flush/stop on any thread,
+// always under the lock) writes [tail, head) out and publishes `tail`.
+// File: "ZRTRACE1", u32 version, u32 record size, then blocks of
+// { u32 stream, u32 count, count x u64 record }. The stream is the thread's
+// first-draw ordinal, or ZRAND__TRACE_BOUND | tag for a bound thread.
+// Record: output | api << 32 | generator id << 40.
+
+#ifdef ZRAND_TRACE
+
+#include <stdio.h>
+
+#ifndef ZRAND_TRACE_RING
+#   define ZRAND_TRACE_RING 4096
+#endif
+#if (ZRAND_TRACE_RING) & ((ZRAND_TRACE_RING) - 1)
+#   error "zrand.h: ZRAND_TRACE_RING must be a power of two."
+#endif
+
+enum { ZRAND__TRACE_OFF, ZRAND__TRACE_RECORD, ZRAND__TRACE_REPLAY };
+
+#define ZRAND__TRACE_BOUND 0x80000000u
+
+typedef struct zrand__trace_ring 
+{
+    uint64_t head;              // Next slot to fill (owner only).
+    uint32_t session;           // Session `stream` belongs to.
+    uint32_t stream;            // First-draw ordinal in the session, or bound tag.
+    const uint64_t *replay;     // Replay: this thread's recorded draws.
+    size_t replay_len;
+    size_t replay_pos;          // `replay_len + 1` once diverged.
+    struct zrand__trace_ring *prev;
+    struct zrand__trace_ring *next;
+    void *raw;
+    ZRAND_ALIGNED(64) uint64_t tail; // Next slot to drain (drainer, under the lock).
+    ZRAND_ALIGNED(64) uint64_t rec[ZRAND_TRACE_RING];
+} zrand__trace_ring;
+
+static int zrand__trace_mode = ZRAND__TRACE_OFF;
+static uint32_t zrand__trace_session = 0;
+static uint32_t zrand__trace_ordinals = 0;
+static FILE *zrand__trace_file = NULL;
+static zrand__trace_ring *zrand__trace_live = NULL;
+static uint64_t *zrand__trace_data = NULL;
+static uint32_t *zrand__trace_ids = NULL; // Replay: stream ids, sorted.
+static size_t *zrand__trace_off = NULL;
+static size_t *zrand__trace_len = NULL;
+static uint32_t zrand__trace_nstreams = 0;
+static uint64_t zrand__trace_diverged = 0;
+static ZRAND_TLS zrand__trace_ring *zrand__trace_tls ZRAND_TLS_MODEL = NULL;
+static ZRAND_TLS uint32_t zrand__trace_tag ZRAND_TLS_MODEL = 0; // ZRAND__TRACE_BOUND | tag once bound.
+
+static void zrand__trace_drain(zrand__trace_ring *r) 
+{
+    uint64_t head = zrand__hook_load_acq(&r->head);
+    uint64_t tail = r->tail;
+    if (head == tail || !zrand__trace_file) 
+    {
+        return;
+    }
+    size_t n = (size_t)(head - tail);
+    size_t first = (size_t)(tail & (ZRAND_TRACE_RING - 1));
+    size_t run = (ZRAND_TRACE_RING - first < n) ? ZRAND_TRACE_RING - first : n;
+    uint32_t hdr[2] = { r->stream, (uint32_t)n };
+    fwrite(hdr, sizeof(hdr), 1, zrand__trace_file);
+    fwrite(r->rec + first, sizeof(uint64_t), run, zrand__trace_file);
+    fwrite(r->rec, sizeof(uint64_t), n - run, zrand__trace_file);
+    zrand__hook_store_rel(&r->tail, head);
+}
+
+// Index of stream `id` in the replayed trace (`zrand__trace_nstreams` if absent).
+static uint32_t zrand__trace_find(uint32_t id) 
+{
+    uint32_t lo = 0, hi = zrand__trace_nstreams;
+    while (lo < hi) 
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (zrand__trace_ids[mid] < id) 
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return (lo < zrand__trace_nstreams && zrand__trace_ids[lo] == id) ? lo : zrand__trace_nstreams;
+}
+
+// Binds the calling thread's ring to the current session (lock held).
+static void zrand__trace_join(zrand__trace_ring *r) 
+{
+    r->session = zrand__trace_session;
+    r->stream = zrand__trace_tag ? zrand__trace_tag : zrand__trace_ordinals++;
+    r->replay = NULL;
+    r->replay_len = 0;
+    r->replay_pos = 0;
+    uint32_t s = (ZRAND__TRACE_REPLAY == zrand__trace_mode) ? zrand__trace_find(r->stream) : zrand__trace_nstreams;
+    if (s < zrand__trace_nstreams) 
+    {
+        r->replay = zrand__trace_data + zrand__trace_off[s];
+        r->replay_len = zrand__trace_len[s];
+    }
+}
+
+static zrand__trace_ring *zrand__trace_enter(zrand__trace_ring *r) 
+{
+    void *raw = NULL;
+    if (!r) 
+    {
+        r = (zrand__trace_ring*)zrand__hooks_alloc(sizeof(zrand__trace_ring), &raw);
+        if (!r || !zrand__hooks_attach()) 
+        {
+            free(raw);
+            return NULL;
+        }
+        r->raw = raw;
+    }
+    ZRAND__HOOKS_LOCK();
+    if (raw) 
+    {
+        r->next = zrand__trace_live;
+        if (zrand__trace_live) 
+        {
+            zrand__trace_live->prev = r;
+        }
+        zrand__trace_live = r;
+    }
+    zrand__trace_join(r);
+    ZRAND__HOOKS_UNLOCK();
+    zrand__trace_tls = r;
+    return r;
+}
+
+static uint32_t zrand__trace_hook(const zrand_rng *gen, int api, uint32_t v) 
+{
+    zrand__trace_ring *r = zrand__trace_tls;
+    if (!r || r->session != zrand__trace_session) 
+    {
+        r = zrand__trace_enter(r);
+        if (!r) 
+        {
+            return v;
+        }
+    }
+    if (ZRAND__TRACE_RECORD == zrand__trace_mode) 
+    {
+        uint64_t head = r->head;
+        if (ZRAND_TRACE_RING == head - zrand__hook_load_acq(&r->tail)) 
+        {
+            ZRAND__HOOKS_LOCK();
+            zrand__trace_drain(r);
+            ZRAND__HOOKS_UNLOCK();
+        }
+        uint32_t id = 0;
+        if (gen && &zrand_global != gen) 
+        {
+            id = (((uint32_t)((uintptr_t)gen >> 4) * 2654435761u) >> 8) | 1u;
+        }
+        r->rec[head & (ZRAND_TRACE_RING - 1)] = v | ((uint64_t)((uint32_t)api | (id << 8)) << 32);
+        zrand__hook_store_rel(&r->head, head + 1);
+        return v;
+    }
+    if (r->replay_pos < r->replay_len && (uint8_t)(r->replay[r->replay_pos] >> 32) == (uint8_t)api) 
+    {
+        return (uint32_t)r->replay[r->replay_pos++];
+    }
+    if (r->replay_pos <= r->replay_len) 
+    {
+        r->replay_pos = r->replay_len + 1;
+        ZRAND__HOOKS_LOCK();
+        zrand__trace_diverged++;
+        ZRAND__HOOKS_UNLOCK();
+    }
+    return v;
+}
+
+static inline uint32_t zrand__traced(const zrand_rng *gen, int api, uint32_t v) 
+{
+    return (ZRAND__TRACE_OFF != zrand__trace_mode) ? zrand__trace_hook(gen, api, v) : v;
+}
+
+#   define ZRAND__TRACE(gen, api, v) zrand__traced((gen), (api), (v))
+
+static void zrand__trace_retire(void) 
+{
+    zrand__trace_ring *r = zrand__trace_tls;
+    zrand__trace_tls = NULL;
+    if (!r) 
+    {
+        return;
+    }
+    ZRAND__HOOKS_LOCK();
+    zrand__trace_drain(r);
+    if (r->prev) 
+    {
+        r->prev->next = r->next;
+    }
+    else
+    {
+        zrand__trace_live = r->next;
+    }
+    if (r->next) 
+    {
+        r->next->prev = r->prev;
+    }
+    ZRAND__HOOKS_UNLOCK();
+    free(r->raw);
+}
+
+bool zrand_trace_record(const char *path) 
+{
+    static const char magic[8] = { 'Z', 'R', 'T', 'R', 'A', 'C', 'E', '1' };
+    const uint32_t hdr[2] = { 1, sizeof(uint64_t) };
+    ZRAND__HOOKS_LOCK();
+    FILE *f = (ZRAND__TRACE_OFF == zrand__trace_mode) ? fopen(path, "wb") : NULL;
+    if (f && (1 != fwrite(magic, sizeof(magic), 1, f) || 1 != fwrite(hdr, sizeof(hdr), 1, f))) 
+    {
+        fclose(f);
+        f = NULL;
+    }
+    if (f) 
+    {
+        zrand__trace_file = f;
+        zrand__trace_session++;
+        zrand__trace_ordinals = 0;
+        zrand__trace_mode = ZRAND__TRACE_RECORD;
+    }
+    ZRAND__HOOKS_UNLOCK();
+    return NULL != f;
+}
+
+static int zrand__trace_id_cmp(const void *a, const void *b) 
+{
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Splits a trace image into one contiguous record array per stream.
+static bool zrand__trace_index(const uint8_t *img, size_t size) 
+{
+    uint32_t hdr[2];
+    if (size < 16 || 0 != memcmp(img, "ZRTRACE1", 8)) 
+    {
+        return false;
+    }
+    memcpy(hdr, img + 8, sizeof(hdr));
+    if (1 != hdr[0] || sizeof(uint64_t) != hdr[1]) 
+    {
+        return false;
+    }
+    // Pass 1: validate blocks. Blocks are never empty, and first-draw
+    // ordinals are dense with every thread writing at least one block, so an
+    // ordinal at or past the block count is corrupt.
+    uint64_t nordinals = 0;
+    size_t nblocks = 0;
+    size_t total = 0;
+    for (size_t pos = 16; pos < size; ) 
+    {
+        uint32_t blk[2];
+        if (size - pos < sizeof(blk)) 
+        {
+            return false;
+        }
+        memcpy(blk, img + pos, sizeof(blk));
+        pos += sizeof(blk);
+        if (0 == blk[1] || (size - pos) / sizeof(uint64_t) < blk[1]) 
+        {
+            return false;
+        }
+        pos += (size_t)blk[1] * sizeof(uint64_t);
+        if (!(blk[0] & ZRAND__TRACE_BOUND)) 
+        {
+            nordinals = (blk[0] >= nordinals) ? (uint64_t)blk[0] + 1 : nordinals;
+        }
+        nblocks++;
+        total += blk[1];
+    }
+    if (nordinals > nblocks) 
+    {
+        return false;
+    }
+    // Pass 2: the sorted, distinct stream ids.
+    zrand__trace_ids = (uint32_t*)malloc((nblocks ? nblocks : 1) * sizeof(uint32_t));
+    if (!zrand__trace_ids) 
+    {
+        return false;
+    }
+    size_t b = 0;
+    for (size_t pos = 16; pos < size; b++) 
+    {
+        uint32_t blk[2];
+        memcpy(blk, img + pos, sizeof(blk));
+        zrand__trace_ids[b] = blk[0];
+        pos += sizeof(blk) + (size_t)blk[1] * sizeof(uint64_t);
+    }
+    qsort(zrand__trace_ids, nblocks, sizeof(uint32_t), zrand__trace_id_cmp);
+    size_t nstreams = 0;
+    for (b = 0; b < nblocks; b++) 
+    {
+        if (0 == nstreams || zrand__trace_ids[nstreams - 1] != zrand__trace_ids[b]) 
+        {
+            zrand__trace_ids[nstreams++] = zrand__trace_ids[b];
+        }
+    }
+    zrand__trace_nstreams = (uint32_t)nstreams;
+    zrand__trace_data = (uint64_t*)malloc((total ? total : 1) * sizeof(uint64_t));
+    zrand__trace_off = (size_t*)calloc(nstreams ? nstreams : 1, sizeof(size_t));
+    zrand__trace_len = (size_t*)calloc(nstreams ? nstreams : 1, sizeof(size_t));
+    if (!zrand__trace_data || !zrand__trace_off || !zrand__trace_len) 
+    {
+        return false;
+    }
+    // Pass 3: per-stream lengths and offsets. Pass 4: gather.
+    for (size_t pos = 16; pos < size; ) 
+    {
+        uint32_t blk[2];
+        memcpy(blk, img + pos, sizeof(blk));
+        zrand__trace_len[zrand__trace_find(blk[0])] += blk[1];
+        pos += sizeof(blk) + (size_t)blk[1] * sizeof(uint64_t);
+    }
+    for (size_t t = 1; t < nstreams; t++) 
+    {
+        zrand__trace_off[t] = zrand__trace_off[t - 1] + zrand__trace_len[t - 1];
+    }
+    memset(zrand__trace_len, 0, (nstreams ? nstreams : 1) * sizeof(size_t));
+    for (size_t pos = 16; pos < size; ) 
+    {
+        uint32_t blk[2];
+        memcpy(blk, img + pos, sizeof(blk));
+        pos += sizeof(blk);
+        uint32_t t = zrand__trace_find(blk[0]);
+        memcpy(zrand__trace_data + zrand__trace_off[t] + zrand__trace_len[t], img + pos, (size_t)blk[1] * sizeof(uint64_t));
+        zrand__trace_len[t] += blk[1];
+        pos += (size_t)blk[1] * sizeof(uint64_t);
+    }
+    return true;
+}
+
+static void zrand__trace_release(void) 
+{
+    free(zrand__trace_data);
+    free(zrand__trace_ids);
+    free(zrand__trace_off);
+    free(zrand__trace_len);
+    zrand__trace_data = NULL;
+    zrand__trace_ids = NULL;
+    zrand__trace_off = NULL;
+    zrand__trace_len = NULL;
+    zrand__trace_nstreams = 0;
+}
+
+bool zrand_trace_replay(const char *path) 
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) 
+    {
+        return false;
+    }
+    uint8_t *img = NULL;
+    long size = -1;
+    if (0 == fseek(f, 0, SEEK_END) && (size = ftell(f)) >= 0 && 0 == fseek(f, 0, SEEK_SET)) 
+    {
+        img = (uint8_t*)malloc(size ? (size_t)size : 1);
+    }
+    bool ok = img && (size_t)size == fread(img, 1, (size_t)size, f);
+    fclose(f);
+
+    ZRAND__HOOKS_LOCK();
+    ok = ok && ZRAND__TRACE_OFF == zrand__trace_mode;
+    if (ok) 
+    {
+        ok = zrand__trace_index(img, (size_t)size);
+        if (!ok) 
+        {
+            zrand__trace_release();
+        }
+    }
+    if (ok) 
+    {
+        zrand__trace_session++;
+        zrand__trace_ordinals = 0;
+        zrand__trace_diverged = 0;
+        zrand__trace_mode = ZRAND__TRACE_REPLAY;
+    }
+    ZRAND__HOOKS_UNLOCK();
+    free(img);
+    return ok;
+}
+
+void zrand_trace_flush(void) 
+{
+    ZRAND__HOOKS_LOCK();
+    for (zrand__trace_ring *r = zrand__trace_live; r; r = r->next) 
+    {
+        zrand__trace_drain(r);
+    }
+    if (zrand__trace_file) 
+    {
+        fflush(zrand__trace_file);
+    }
+    ZRAND__HOOKS_UNLOCK();
+}
+
+void zrand_trace_stop(void) 
+{
+    ZRAND__HOOKS_LOCK();
+    for (zrand__trace_ring *r = zrand__trace_live; r; r = r->next) 
+    {
+        zrand__trace_drain(r);
+    }
+    if (zrand__trace_file) 
+    {
+        fclose(zrand__trace_file);
+        zrand__trace_file = NULL;
+    }
+    zrand__trace_release();
+    zrand__trace_mode = ZRAND__TRACE_OFF;
+    ZRAND__HOOKS_UNLOCK();
+}
+
+uint64_t zrand_trace_divergences(void) 
+{
+    ZRAND__HOOKS_LOCK();
+    uint64_t n = zrand__trace_diverged;
+    ZRAND__HOOKS_UNLOCK();
+    return n;
+}
+
+bool zrand_trace_bind(uint32_t tag) 
+{
+    if (tag & ZRAND__TRACE_BOUND) 
+    {
+        return false;
+    }
+    zrand__trace_tag = ZRAND__TRACE_BOUND | tag;
+    // Already drawing in this session: close the old stream's records and
+    // switch to the tagged stream.
+    zrand__trace_ring *r = zrand__trace_tls;
+    if (r) 
+    {
+        ZRAND__HOOKS_LOCK();
+        if (r->session == zrand__trace_session) 
+        {
+            zrand__trace_drain(r);
+            zrand__trace_join(r);
+        }
+        ZRAND__HOOKS_UNLOCK();
+    }
+    return true;
+}
+
+#else
+#   define ZRAND__TRACE(gen, api, v) ((void)(api), (v))
+#endif // ZRAND_TRACE
+
+#ifdef ZRAND__HOOKS
+static void zrand__hooks_thread_exit(void) 
+{
+#ifdef ZRAND_STATS
+    zrand__stats_retire();
+#endif
+#ifdef ZRAND_TRACE
+    zrand__trace_retire();
+#endif
+    zrand__hooks_attached = false;
+}
+#endif
+
+// Every traced draw from a zrand_rng goes through zrand__draw(); `api` tags
+// the public entry point that made it.
+static inline uint32_t zrand__draw(zrand_rng *rng, int api) 
+{
+    return ZRAND__TRACE(rng, api, zrand__pcg32(rng));
+}
+
+// Multi-lane PCG kernels.
+// zrand__pcg32_soa() steps `n` independent streams once each and writes the
+// outputs to out[i]. Increments come from inc[i] or, when `inc` is NULL, from
+// `shared_inc`. The SIMD versions produce exactly the scalar values.
+
+static inline uint32_t zrand__pcg32_step(uint64_t *state, uint64_t inc) 
+{
+    uint64_t oldstate = *state;
+    *state = oldstate * 6364136223846793005ULL + inc;
+    uint32_t xorshifted = (uint32_t)(((oldstate >> 18u) ^ oldstate) >> 27u);
+    uint32_t rot = (uint32_t)(oldstate >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+#if defined(ZRAND_NO_SIMD)
+    // Scalar kernels only, even when the target has AVX2/AVX-512.
+#elif defined(__AVX512F__) && defined(__AVX512DQ__) && defined(__AVX512VL__)
+#   include <immintrin.h>
+#   define ZRAND__AVX512
+static inline __m256i zrand__pcg32_x8_mul(__m512i *s, __m512i mul, __m512i c) 
+{
+    __m512i old = *s;
+    *s = _mm512_add_epi64(_mm512_mullo_epi64(old, mul), c);
+    __m512i xs = _mm512_srli_epi64(_mm512_xor_si512(_mm512_srli_epi64(old, 18), old), 27);
+    __m256i rot = _mm512_cvtepi64_epi32(_mm512_srli_epi64(old, 59));
+    return _mm256_rorv_epi32(_mm512_cvtepi64_epi32(xs), rot);
+}
+
+static inline __m256i zrand__pcg32_x8(__m512i *s, __m512i c) 
+{
+    return zrand__pcg32_x8_mul(s, _mm512_set1_epi64((long long)6364136223846793005ULL), c);
+}
+#elif defined(__AVX2__)
+#   include <immintrin.h>
+#   define ZRAND__AVX2
+// `mul_lo` and `mul_hi` hold the multiplier's 32-bit halves in every lane.
+static inline __m128i zrand__pcg32_x4_mul(__m256i *s, __m256i mul_lo, __m256i mul_hi, __m256i c) 
+{
+    const __m256i mask = _mm256_set1_epi64x(31);
+    __m256i old = *s;
+
+    // 64x64 multiply from three 32x32 products.
+    __m256i lo = _mm256_mul_epu32(old, mul_lo);
+    __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(old, 32), mul_lo),
+                                     _mm256_mul_epu32(old, mul_hi));
+    *s = _mm256_add_epi64(_mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32)), c);
+
+    // Output permutation; only the low dword of each 64-bit lane is meaningful.
+    __m256i xs = _mm256_srli_epi64(_mm256_xor_si256(_mm256_srli_epi64(old, 18), old), 27);
+    __m256i rot = _mm256_srli_epi64(old, 59);
+    __m256i lrot = _mm256_and_si256(_mm256_sub_epi64(_mm256_setzero_si256(), rot), mask);
+    __m256i r = _mm256_or_si256(_mm256_srlv_epi32(xs, rot), _mm256_sllv_epi32(xs, lrot));
+    r = _mm256_permutevar8x32_epi32(r, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+    return _mm256_castsi256_si128(r);
+}
+
+static inline __m128i zrand__pcg32_x4(__m256i *s, __m256i c) 
+{
+    return zrand__pcg32_x4_mul(s, _mm256_set1_epi64x(0x4C957F2DLL), _mm256_set1_epi64x(0x5851F42DLL), c);
+}
+#endif
+
+static void zrand__pcg32_soa(uint64_t *state, const uint64_t *inc, uint64_t shared_inc, uint32_t *out, size_t n) 
+{
+    ZRAND__STAT(ZRAND__STAT_STEPS, n);
+    size_t i = 0;
+#if defined(ZRAND__AVX512)
+    const __m512i sc = _mm512_set1_epi64((long long)shared_inc);
+    for (; i + 8 <= n; i += 8) 
+    {
+        __m512i s = _mm512_loadu_si512((const void*)(state + i));
+        __m512i c = inc ? _mm512_loadu_si512((const void*)(inc + i)) : sc;
+        __m256i r = zrand__pcg32_x8(&s, c);
+        _mm512_storeu_si512((void*)(state + i), s);
+        _mm256_storeu_si256((__m256i*)(out + i), r);
+    }
+#elif defined(ZRAND__AVX2)
+    const __m256i sc = _mm256_set1_epi64x((long long)shared_inc);
+    for (; i + 4 <= n; i += 4) 
+    {
+        __m256i s = _mm256_loadu_si256((const __m256i*)(state + i));
+        __m256i c = inc ? _mm256_loadu_si256((const __m256i*)(inc + i)) : sc;
+        __m128i r = zrand__pcg32_x4(&s, c);
+        _mm256_storeu_si256((__m256i*)(state + i), s);
+        _mm_storeu_si128((__m128i*)(out + i), r);
+    }
+#endif
+    for (; i < n; i++) 
+    {
+        out[i] = zrand__pcg32_step(&state[i], inc ? inc[i] : shared_inc);
+    }
+}
+
+// Buffered mode (ZRAND_BUFFERED).
+// The core global generators pop from a per-thread block of precomputed
+// outputs. The block is refilled by stepping several independent PCG lanes
+// in lockstep. The sequence is NOT the same as the scalar generator's.
+
+#ifdef ZRAND_BUFFERED
+
+#ifndef ZRAND_BUFFER_SIZE
+#   define ZRAND_BUFFER_SIZE 256
+#endif
+#define ZRAND_BUFFER_LANES 8
+#if ZRAND_BUFFER_SIZE <= 0 || ZRAND_BUFFER_SIZE % ZRAND_BUFFER_LANES
+#   error "ZRAND_BUFFER_SIZE must be a positive multiple of ZRAND_BUFFER_LANES (8)."
+#endif
+
+typedef struct 
+{
+    ZRAND_ALIGNED(64) uint32_t out[ZRAND_BUFFER_SIZE];
+    uint64_t state[ZRAND_BUFFER_LANES];
+    uint64_t inc[ZRAND_BUFFER_LANES];
+    uint32_t avail;
+    bool ready;
+} zrand__buffer;
+
+static ZRAND_TLS zrand__buffer zrand_buf ZRAND_TLS_MODEL;
+
+// Steps the lanes for n / LANES rounds, writing lane `l` of round `r` to
+// out[r * LANES + l]. Lane state stays in registers across rounds.
+static void zrand__pcg32_lanes(uint64_t *state, const uint64_t *inc, uint32_t *out, size_t n) 
+{
+#if defined(ZRAND__AVX512)
+    __m512i s = _mm512_loadu_si512((const void*)state);
+    const __m512i c = _mm512_loadu_si512((const void*)inc);
+    for (size_t i = 0; i + ZRAND_BUFFER_LANES <= n; i += ZRAND_BUFFER_LANES) 
+    {
+        _mm256_storeu_si256((__m256i*)(out + i), zrand__pcg32_x8(&s, c));
+    }
+    _mm512_storeu_si512((void*)state, s);
+#elif defined(ZRAND__AVX2)
+    __m256i s0 = _mm256_loadu_si256((const __m256i*)state);
+    __m256i s1 = _mm256_loadu_si256((const __m256i*)(state + 4));
+    const __m256i c0 = _mm256_loadu_si256((const __m256i*)inc);
+    const __m256i c1 = _mm256_loadu_si256((const __m256i*)(inc + 4));
+    for (size_t i = 0; i + ZRAND_BUFFER_LANES <= n; i += ZRAND_BUFFER_LANES) 
+    {
+        _mm_storeu_si128((__m128i*)(out + i), zrand__pcg32_x4(&s0, c0));
+        _mm_storeu_si128((__m128i*)(out + i + 4), zrand__pcg32_x4(&s1, c1));
+    }
+    _mm256_storeu_si256((__m256i*)state, s0);
+    _mm256_storeu_si256((__m256i*)(state + 4), s1);
+#else
+    uint64_t s[ZRAND_BUFFER_LANES];
+    memcpy(s, state, sizeof(s));
+    for (size_t i = 0; i + ZRAND_BUFFER_LANES <= n; i += ZRAND_BUFFER_LANES) 
+    {
+        for (size_t l = 0; l < ZRAND_BUFFER_LANES; l++) 
+        {
+            out[i + l] = zrand__pcg32_step(&s[l], inc[l]);
+        }
+    }
+    memcpy(state, s, sizeof(s));
+#endif
+}
+
+static void zrand__buffer_refill(void) 
+{
+    if (!zrand_buf.ready) 
+    {
+        // Each lane gets its own stream, seeded from the scalar generator.
+        zrand_rng *g = zrand__get();
+        for (int l = 0; l < ZRAND_BUFFER_LANES; l++) 
+        {
+            zrand_rng lane;
+            // Seeding draws are internal: untraced, so a replay never consumes them.
+            uint64_t seed = ((uint64_t)zrand__pcg32(g) << 32) | zrand__pcg32(g);
+            uint64_t seq = ((uint64_t)zrand__pcg32(g) << 32) | zrand__pcg32(g);
+            zrand_rng_init(&lane, seed, seq + (uint64_t)l);
+            zrand_buf.state[l] = lane.state;
+            zrand_buf.inc[l] = lane.inc;
+        }
+        zrand_buf.ready = true;
+    }
+    ZRAND__STAT(ZRAND__STAT_STEPS, ZRAND_BUFFER_SIZE);
+    zrand__pcg32_lanes(zrand_buf.state, zrand_buf.inc, zrand_buf.out, ZRAND_BUFFER_SIZE);
+    zrand_buf.avail = ZRAND_BUFFER_SIZE;
+}
+
+static inline uint32_t zrand__next32(int api) 
+{
+    if (0 == zrand_buf.avail) 
+    {
+        zrand__buffer_refill();
+    }
+    return ZRAND__TRACE(NULL, api, zrand_buf.out[ZRAND_BUFFER_SIZE - zrand_buf.avail--]);
+}
+
+static inline uint64_t zrand__next64(int api) 
+{
+    uint64_t hi = zrand__next32(api);
+    return (hi << 32) | zrand__next32(api);
+}
+
+#endif // ZRAND_BUFFERED
+
+// Instance implementation.
+// The public functions share these helpers so that every draw is traced under
+// the API that was called, not the one it is built on.
+
+static inline uint64_t zrand__u64(zrand_rng *rng, int api) 
+{
+    uint64_t hi = zrand__draw(rng, api);
+    return (hi << 32) | zrand__draw(rng, api);
+}
+
+static inline float zrand__f32(zrand_rng *rng, int api) 
+{
+    return (zrand__draw(rng, api) >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline double zrand__f64(zrand_rng *rng, int api) 
+{
+    return (zrand__u64(rng, api) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static int32_t zrand__range(zrand_rng *rng, int32_t min, int32_t max, int api) 
+{
+    if (min >= max) 
+    {
+        return min;
+    }
+    // Unsigned span avoids signed overflow; the full 2^32 range needs no rejection.
+    uint32_t span = (uint32_t)max - (uint32_t)min;
+    if (UINT32_MAX == span) 
+    {
+        return (int32_t)zrand__draw(rng, api);
+    }
+    uint32_t range = span + 1;
+    uint32_t x, limit = (uint32_t) - 1;
+    uint32_t bucket_size = limit / range;
+    uint32_t rejection_limit = bucket_size * range;
+    x = zrand__draw(rng, api);
+    while (x >= rejection_limit) 
+    {
+        ZRAND__STAT(ZRAND__STAT_RANGE_RETRIES, 1);
+        x = zrand__draw(rng, api);
+    }
+    return (int32_t)((uint32_t)min + x / bucket_size);
+}
+
+uint32_t zrand_rng_u32(zrand_rng *rng) 
+{ 
+    return zrand__draw(rng, ZRAND_API_U32); 
+}
+
+uint64_t zrand_rng_u64(zrand_rng *rng) 
+{ 
+    return zrand__u64(rng, ZRAND_API_U64); 
+}
+
+float zrand_rng_f32(zrand_rng *rng) 
+{ 
+    return zrand__f32(rng, ZRAND_API_F32); 
+}
+
+double zrand_rng_f64(zrand_rng *rng) 
+{ 
+    return zrand__f64(rng, ZRAND_API_F64); 
+}
+
+bool zrand_rng_bool(zrand_rng *rng) 
+{ 
+    return (zrand__draw(rng, ZRAND_API_BOOL) & 1); 
+}
+
+bool zrand_rng_chance(zrand_rng *rng, double probability) 
+{ 
+    return zrand__f64(rng, ZRAND_API_CHANCE) < probability; 
+}
+
+int32_t zrand_rng_range(zrand_rng *rng, int32_t min, int32_t max) 
+{
+    return zrand__range(rng, min, max, ZRAND_API_RANGE);
+}
+
+float zrand_rng_range_f(zrand_rng *rng, float min, float max) 
+{
+    return min + zrand__f32(rng, ZRAND_API_RANGE_F) * (max - min);
+}
+
+static double zrand__box_muller(zrand_rng *rng, double mean, double stddev) 
+{
+    double u, v, s;
+    for (;;) 
+    { 
+        u = (zrand__f64(rng, ZRAND_API_GAUSSIAN) * 2) - 1; 
+        v = (zrand__f64(rng, ZRAND_API_GAUSSIAN) * 2) - 1; 
+        s = u * u + v * v; 
+        if (s < 1 && s != 0) 
+        {
+            break;
+        }
+        ZRAND__STAT(ZRAND__STAT_GAUSSIAN_RETRIES, 1);
+    }
+    
+    s = zmath_sqrt((-2.0 * zmath_log(s)) / s);
+    return mean + (stddev * u * s); 
+}
+
+double zrand_rng_gaussian(zrand_rng *rng, double mean, double stddev) 
+{ 
+    return zrand__box_muller(rng, mean, stddev); 
+}
+
+static void zrand__bytes(zrand_rng *rng, void *buf, size_t len, int api) 
+{
+    uint8_t *p = (uint8_t*)buf;
+    while (len >= 4) 
+    { 
+        uint32_t v = zrand__draw(rng, api);
+        memcpy(p, &v, 4); 
+        p += 4; 
+        len -= 4; 
+    }
+    if (len > 0) 
+    { 
+        uint32_t rem = zrand__draw(rng, api); 
+        uint8_t *r = (uint8_t*)&rem; 
+        while (len--) 
+        {
+            *p++ = *r++; 
+        }
+    }
+}
+
+void zrand_rng_bytes(zrand_rng *rng, void *buf, size_t len) 
+{
+    zrand__bytes(rng, buf, len, ZRAND_API_BYTES);
+}
+
+static const char ZRAND_ALPHANUM[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+void zrand_rng_str(zrand_rng *rng, char *buf, size_t len) 
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        buf[i] = ZRAND_ALPHANUM[zrand__draw(rng, ZRAND_API_STR) % (sizeof(ZRAND_ALPHANUM) - 1)];
+    }
+    buf[len] = '\0';
+}
+
+void zrand_rng_uuid(zrand_rng *rng, char *buf) 
+{
+    static const char *hex = "0123456789abcdef";
+    uint8_t b[16]; 
+    zrand__bytes(rng, b, 16, ZRAND_API_UUID);
+    
+    // Variant and version bits.
+    b[6] = (b[6] & 0x0F) | 0x40; 
+    b[8] = (b[8] & 0x3F) | 0x80;
+    
+    int k = 0;
+    for (int i = 0; i < 16; i++) 
+    {
+        if (4 == i || 6 == i ||
+            8 == i || 10 == i) 
+        {
+            buf[k++] = '-';
+        }
+        buf[k++] = hex[(b[i] >> 4) & 0xF]; 
+        buf[k++] = hex[b[i] & 0xF];
+    }
+    buf[k] = '\0';
+}
+
+void zrand_rng_shuffle(zrand_rng *rng, void *base, size_t nmemb, size_t size) 
+{
+    if (nmemb <= 1) 
+    {
+        return;
+    }
+    char *arr = (char*)base; 
+    char temp[256]; 
+    char *swap_buf = (size > sizeof(temp)) ? (char*)malloc(size) : temp;
+    if (!swap_buf) 
+    {
+        return;
+    }
+
+    for (size_t i = nmemb - 1; i > 0; i--) 
+    {
+        size_t j = zrand__range(rng, 0, (int32_t)i, ZRAND_API_SHUFFLE);
+        if (i != j) 
+        {
+            memcpy(swap_buf, arr + i * size, size);
+            memcpy(arr + i * size, arr + j * size, size);
+            memcpy(arr + j * size, swap_buf, size);
+        }
+    }
+    if (swap_buf != temp) free(swap_buf);
+}
+
+void* zrand_rng_choice(zrand_rng *rng, void *base, size_t nmemb, size_t size) 
+{
+    if (0 == nmemb) 
+    {
+        return NULL;
+    }
+    return (char*)base + (zrand__range(rng, 0, (int32_t)nmemb - 1, ZRAND_API_CHOICE) * size);
+}
+
+// Compact generators implementation.
+
+void zrand_mcg_init(zrand_mcg *rng, uint64_t seed) 
+{
+    // MCG states must be odd (PCG seeds them with `seed | 3`).
+    rng->state = seed | 3u;
+    (void)zrand_mcg_u32(rng);
+}
+
+uint32_t zrand_mcg_u32(zrand_mcg *rng) 
+{
+    ZRAND__STAT(ZRAND__STAT_STEPS, 1);
+    return zrand__pcg32_step(&rng->state, 0);
+}
+
+float zrand_mcg_f32(zrand_mcg *rng) 
+{
+    return (zrand_mcg_u32(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+int32_t zrand_mcg_range(zrand_mcg *rng, int32_t min, int32_t max) 
+{
+    if (min >= max) 
+    {
+        return min;
+    }
+    uint32_t span = (uint32_t)max - (uint32_t)min;
+    if (UINT32_MAX == span) 
+    {
+        return (int32_t)zrand_mcg_u32(rng);
+    }
+    uint32_t range = span + 1;
+    uint32_t x, bucket_size = ((uint32_t)-1) / range;
+    uint32_t rejection_limit = bucket_size * range;
+    x = zrand_mcg_u32(rng);
+    while (x >= rejection_limit) 
+    {
+        ZRAND__STAT(ZRAND__STAT_RANGE_RETRIES, 1);
+        x = zrand_mcg_u32(rng);
+    }
+    return (int32_t)((uint32_t)min + x / bucket_size);
+}
+
+void zrand_tiny_init(zrand_tiny *rng, uint32_t seed) 
+{
+    rng->state = 0u;
+    (void)zrand_tiny_u16(rng);
+    rng->state += seed;
+    (void)zrand_tiny_u16(rng);
+}
+
+uint16_t zrand_tiny_u16(zrand_tiny *rng) 
+{
+    // 32-bit LCG with the XSH-RR 32 -> 16 output (pcg_oneseq_32_xsh_rr_16).
+    ZRAND__STAT(ZRAND__STAT_STEPS, 1);
+    uint32_t oldstate = rng->state;
+    rng->state = oldstate * 747796405u + 2891336453u;
+    uint16_t xorshifted = (uint16_t)(((oldstate >> 10u) ^ oldstate) >> 12u);
+    uint32_t rot = oldstate >> 28u;
+    return (uint16_t)((xorshifted >> rot) | (xorshifted << ((-rot) & 15)));
+}
+
+float zrand_tiny_f32(zrand_tiny *rng) 
+{
+    return zrand_tiny_u16(rng) * (1.0f / 65536.0f);
+}
+
+int32_t zrand_tiny_range(zrand_tiny *rng, int32_t min, int32_t max) 
+{
+    if (min >= max) 
+    {
+        return min;
+    }
+    uint32_t span = (uint32_t)max - (uint32_t)min;
+    uint32_t range = span >= 65535u ? 65536u : span + 1;
+    uint32_t x, bucket_size = 65536u / range;
+    uint32_t rejection_limit = bucket_size * range;
+    x = zrand_tiny_u16(rng);
+    while (x >= rejection_limit) 
+    {
+        ZRAND__STAT(ZRAND__STAT_RANGE_RETRIES, 1);
+        x = zrand_tiny_u16(rng);
+    }
+    return (int32_t)((uint32_t)min + x / bucket_size);
+}
+
+// Coordinate hashing (batch versions).
+// The AVX2 paths hash eight coordinates per round; the scalar loops finish
+// the tails (and everything in other builds).
+
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+// zrand__hash_round on eight lanes.
+static inline __m256i zrand__hash_round_x8(__m256i v) 
+{
+    __m256i state = _mm256_add_epi32(_mm256_mullo_epi32(v, _mm256_set1_epi32(747796405)), _mm256_set1_epi32((int)2891336453u));
+    __m256i shift = _mm256_add_epi32(_mm256_srli_epi32(state, 28), _mm256_set1_epi32(4));
+    __m256i word = _mm256_mullo_epi32(_mm256_xor_si256(_mm256_srlv_epi32(state, shift), state), _mm256_set1_epi32(277803737));
+    return _mm256_xor_si256(_mm256_srli_epi32(word, 22), word);
+}
+
+// zrand_hash_to_f32 on eight lanes; (h >> 8) and the scale are exact in float.
+static inline __m256 zrand__hash_to_f32_x8(__m256i h) 
+{
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(h, 8)), _mm256_set1_ps(1.0f / 16777216.0f));
+}
+#endif
+
+void zrand_hash_u32_batch(uint32_t seed, const int32_t *x, uint32_t *out, size_t n) 
+{
+    uint32_t k = zrand__hash_round(seed);
+    size_t i = 0;
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+    const __m256i vk = _mm256_set1_epi32((int)k);
+    for (; i + 8 <= n; i += 8) 
+    {
+        __m256i vx = _mm256_loadu_si256((const __m256i*)(x + i));
+        _mm256_storeu_si256((__m256i*)(out + i), zrand__hash_round_x8(_mm256_xor_si256(vk, vx)));
+    }
+#endif
+    for (; i < n; i++) 
+    {
+        out[i] = zrand__hash_round(k ^ (uint32_t)x[i]);
+    }
+}
+
+void zrand_hash2_u32_batch(uint32_t seed, const int32_t *x, const int32_t *y, uint32_t *out, size_t n) 
+{
+    uint32_t k = zrand__hash_round(seed);
+    size_t i = 0;
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+    const __m256i vk = _mm256_set1_epi32((int)k);
+    for (; i + 8 <= n; i += 8) 
+    {
+        __m256i vx = _mm256_loadu_si256((const __m256i*)(x + i));
+        __m256i vy = _mm256_loadu_si256((const __m256i*)(y + i));
+        __m256i h = zrand__hash_round_x8(_mm256_xor_si256(vk, vx));
+        _mm256_storeu_si256((__m256i*)(out + i), zrand__hash_round_x8(_mm256_xor_si256(h, vy)));
+    }
+#endif
+    for (; i < n; i++) 
+    {
+        out[i] = zrand__hash_round(zrand__hash_round(k ^ (uint32_t)x[i]) ^ (uint32_t)y[i]);
+    }
+}
+
+void zrand_hash3_u32_batch(uint32_t seed, const int32_t *x, const int32_t *y, const int32_t *z, uint32_t *out, size_t n) 
+{
+    uint32_t k = zrand__hash_round(seed);
+    size_t i = 0;
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+    const __m256i vk = _mm256_set1_epi32((int)k);
+    for (; i + 8 <= n; i += 8) 
+    {
+        __m256i vx = _mm256_loadu_si256((const __m256i*)(x + i));
+        __m256i vy = _mm256_loadu_si256((const __m256i*)(y + i));
+        __m256i vz = _mm256_loadu_si256((const __m256i*)(z + i));
+        __m256i h = zrand__hash_round_x8(_mm256_xor_si256(vk, vx));
+        h = zrand__hash_round_x8(_mm256_xor_si256(h, vy));
+        _mm256_storeu_si256((__m256i*)(out + i), zrand__hash_round_x8(_mm256_xor_si256(h, vz)));
+    }
+#endif
+    for (; i < n; i++) 
+    {
+        uint32_t h = zrand__hash_round(zrand__hash_round(k ^ (uint32_t)x[i]) ^ (uint32_t)y[i]);
+        out[i] = zrand__hash_round(h ^ (uint32_t)z[i]);
+    }
+}
+
+void zrand_hash2_f32_grid(uint32_t seed, int32_t x0, int32_t y0, size_t w, size_t h, float *out) 
+{
+    // Column hashes do not depend on the row, so compute them once.
+    // Coordinates are added as uint32_t: a grid may wrap past INT32_MAX.
+    uint32_t k = zrand__hash_round(seed);
+    uint32_t cols[256];
+    for (size_t i0 = 0; i0 < w; i0 += 256) 
+    {
+        size_t cw = (w - i0 < 256) ? w - i0 : 256;
+        size_t i = 0;
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+        const __m256i vk = _mm256_set1_epi32((int)k);
+        const __m256i step = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        for (; i + 8 <= cw; i += 8) 
+        {
+            __m256i vx = _mm256_add_epi32(_mm256_set1_epi32((int)((uint32_t)x0 + (uint32_t)(i0 + i))), step);
+            _mm256_storeu_si256((__m256i*)(cols + i), zrand__hash_round_x8(_mm256_xor_si256(vk, vx)));
+        }
+#endif
+        for (; i < cw; i++) 
+        {
+            cols[i] = zrand__hash_round(k ^ ((uint32_t)x0 + (uint32_t)(i0 + i)));
+        }
+        for (size_t j = 0; j < h; j++) 
+        {
+            uint32_t yj = (uint32_t)y0 + (uint32_t)j;
+            float *row = out + j * w + i0;
+            i = 0;
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+            const __m256i vy = _mm256_set1_epi32((int)yj);
+            for (; i + 8 <= cw; i += 8) 
+            {
+                __m256i c = _mm256_loadu_si256((const __m256i*)(cols + i));
+                _mm256_storeu_ps(row + i, zrand__hash_to_f32_x8(zrand__hash_round_x8(_mm256_xor_si256(c, vy))));
+            }
+#endif
+            for (; i < cw; i++) 
+            {
+                row[i] = zrand_hash_to_f32(zrand__hash_round(cols[i] ^ yj));
+            }
+        }
+    }
+}
+
+// Generator bank implementation.
+
+bool zrand_rng_bank_init(zrand_rng_bank *bank, size_t count, uint64_t seed, bool per_lane_streams) 
+{
+    memset(bank, 0, sizeof(*bank));
+    if (0 == count) 
+    {
+        return true;
+    }
+    bank->state = (uint64_t*)malloc(count * sizeof(uint64_t));
+    bank->inc = per_lane_streams ? (uint64_t*)malloc(count * sizeof(uint64_t)) : NULL;
+    if (!bank->state || (per_lane_streams && !bank->inc)) 
+    {
+        zrand_rng_bank_free(bank);
+        return false;
+    }
+    bank->count = count;
+
+    zrand_rng rng;
+    if (per_lane_streams) 
+    {
+        for (size_t i = 0; i < count; i++) 
+        {
+            zrand_rng_init(&rng, zrand__mix64(seed + (i + 1) * 0x9E3779B97F4A7C15ULL), (uint64_t)i);
+            bank->state[i] = rng.state;
+            bank->inc[i] = rng.inc | 1;
+        }
+        return true;
+    }
+
+    zrand_rng_init(&rng, seed, 0);
+    zrand_rng_bank_init_shared(bank, bank->state, count, &rng);
+    return true;
+}
+
+void zrand_rng_bank_init_shared(zrand_rng_bank *bank, uint64_t *state, size_t count, const zrand_rng *rng) 
+{
+    bank->state = state;
+    bank->inc = NULL;
+    bank->shared_inc = rng->inc | 1;
+    bank->count = count;
+    // One stream, lanes spaced over the period. A spacing near a multiple of a
+    // large power of two makes a^S close to a small power of a, so lane j is
+    // nearly lane 0 shifted by j steps and interleaved lanes correlate. Pick
+    // an odd spacing with well-mixed bits in [2^63 / count, 2^64 / count).
+    uint64_t half = (count > 1) ? zrand__even_block(count) >> 1 : ((uint64_t)1 << 63);
+    uint64_t spacing = (half + 0x9E3779B97F4A7C15ULL % half) | 1;
+    uint64_t mult, plus;
+    zrand__lcg_jump(spacing, 6364136223846793005ULL, bank->shared_inc, &mult, &plus);
+    uint64_t st = rng->state;
+    for (size_t i = 0; i < count; i++) 
+    {
+        state[i] = st;
+        st = st * mult + plus;
+    }
+}
+
+void zrand_rng_bank_free(zrand_rng_bank *bank) 
+{
+    free(bank->state);
+    free(bank->inc);
+    memset(bank, 0, sizeof(*bank));
+}
+
+void zrand_rng_bank_u32(zrand_rng_bank *bank, uint32_t *out) 
+{
+    zrand__pcg32_soa(bank->state, bank->inc, bank->shared_inc, out, bank->count);
+}
+
+void zrand_rng_bank_f32(zrand_rng_bank *bank, float *out) 
+{
+    uint32_t tmp[256];
+    for (size_t i = 0; i < bank->count; i += 256) 
+    {
+        size_t k = (bank->count - i < 256) ? bank->count - i : 256;
+        zrand__pcg32_soa(bank->state + i, bank->inc ? bank->inc + i : NULL, bank->shared_inc, tmp, k);
+        for (size_t j = 0; j < k; j++) 
+        {
+            out[i + j] = (tmp[j] >> 8) * (1.0f / 16777216.0f);
+        }
+    }
+}
+
+void zrand_rng_bank_u32_masked(zrand_rng_bank *bank, const uint8_t *mask, uint32_t *out) 
+{
+    // Step a copy of each block in lockstep, then keep only the masked lanes.
+    uint64_t st[256];
+    uint32_t tmp[256];
+    for (size_t i = 0; i < bank->count; i += 256) 
+    {
+        size_t k = (bank->count - i < 256) ? bank->count - i : 256;
+        memcpy(st, bank->state + i, k * sizeof(uint64_t));
+        zrand__pcg32_soa(st, bank->inc ? bank->inc + i : NULL, bank->shared_inc, tmp, k);
+        for (size_t j = 0; j < k; j++) 
+        {
+            bool m = 0 != mask[i + j];
+            bank->state[i + j] = m ? st[j] : bank->state[i + j];
+            out[i + j] = m ? tmp[j] : out[i + j];
+        }
+    }
+}
+
+uint32_t zrand_rng_bank_lane_u32(zrand_rng_bank *bank, size_t lane) 
+{
+    ZRAND__STAT(ZRAND__STAT_STEPS, 1);
+    return zrand__pcg32_step(&bank->state[lane], bank->inc ? bank->inc[lane] : bank->shared_inc);
+}
+
+void zrand_rng_bank_get(const zrand_rng_bank *bank, size_t lane, zrand_rng *out) 
+{
+    out->state = bank->state[lane];
+    out->inc = bank->inc ? bank->inc[lane] : bank->shared_inc;
+}
+
+// Global API implementation (thin wrappers over the thread-local instance).
+
+void zrand_init(void) 
+{
+    uint64_t seed = zrand__os_seed();
+    uint64_t seq = (uint64_t)(uintptr_t)&zrand_global; 
+    zrand_rng_init(&zrand_global, seed, seq);
+    zrand_seeded = true;
+    ZRAND__STAT(ZRAND__STAT_RESEEDS, 1);
+#ifdef ZRAND_BUFFERED
+    zrand_buf.avail = 0;
+    zrand_buf.ready = false;
+#endif
+}
+
+zrand_rng *zrand_local(void) 
+{
+    return zrand__get();
+}
+
+#ifdef ZRAND_BUFFERED
+
+uint32_t zrand_u32(void)
+{
+    ZRAND__STAT(ZRAND_API_U32, 1);
+    return zrand__next32(ZRAND_API_U32);
+}
+
+uint64_t zrand_u64(void) 
+{ 
+    ZRAND__STAT(ZRAND_API_U64, 1);
+    return zrand__next64(ZRAND_API_U64); 
+}
+
+float zrand_f32(void) 
+{ 
+    ZRAND__STAT(ZRAND_API_F32, 1);
+    return (zrand__next32(ZRAND_API_F32) >> 8) * (1.0f / 16777216.0f); 
+}
+
+double zrand_f64(void) 
+{ 
+    ZRAND__STAT(ZRAND_API_F64, 1);
+    return (zrand__next64(ZRAND_API_F64) >> 11) * (1.0 / 9007199254740992.0); 
+}
+
+bool zrand_bool(void) 
+{ 
+    ZRAND__STAT(ZRAND_API_BOOL, 1);
+    return (zrand__next32(ZRAND_API_BOOL) & 1); 
+}
+
+bool zrand_chance(double probability) 
+{ 
+    ZRAND__STAT(ZRAND_API_CHANCE, 1);
+    return (zrand__next64(ZRAND_API_CHANCE) >> 11) * (1.0 / 9007199254740992.0) < probability; 
+}
+
+int32_t zrand_range(int32_t min, int32_t max) 
+{
+    ZRAND__STAT(ZRAND_API_RANGE, 1);
+    if (min >= max) 
+    {
+        return min;
+    }
+    // Unsigned span avoids signed overflow; the full 2^32 range needs no rejection.
+    uint32_t span = (uint32_t)max - (uint32_t)min;
+    if (UINT32_MAX == span) 
+    {
+        return (int32_t)zrand__next32(ZRAND_API_RANGE);
+    }
+    uint32_t range = span + 1;
+    uint32_t x, limit = (uint32_t) - 1;
+    uint32_t bucket_size = limit / range;
+    uint32_t rejection_limit = bucket_size * range;
+    x = zrand__next32(ZRAND_API_RANGE);
+    while (x >= rejection_limit) 
+    {
+        ZRAND__STAT(ZRAND__STAT_RANGE_RETRIES, 1);
+        x = zrand__next32(ZRAND_API_RANGE);
+    }
+    return (int32_t)((uint32_t)min + x / bucket_size);
+}
+
+float zrand_range_f(float min, float max) 
+{
+    ZRAND__STAT(ZRAND_API_RANGE_F, 1);
+    return min + (zrand__next32(ZRAND_API_RANGE_F) >> 8) * (1.0f / 16777216.0f) * (max - min);
+}
+
+#else
+
+uint32_t zrand_u32(void)
+{
+    ZRAND__STAT(ZRAND_API_U32, 1);
+    return zrand__draw(zrand__get(), ZRAND_API_U32);
+}
+
+uint64_t zrand_u64(void) 
+{ 
+    ZRAND__STAT(ZRAND_API_U64, 1);
+    return zrand_rng_u64(zrand__get()); 
+}
+
+float zrand_f32(void) 
+{ 
+    ZRAND__STAT(ZRAND_API_F32, 1);
+    return zrand_rng_f32(zrand__get()); 
+}
+
+double zrand_f64(void) 
+{ 
+    ZRAND__STAT(ZRAND_API_F64, 1);
+    return zrand_rng_f64(zrand__get()); 
+}
+
+bool zrand_bool(void) 
+{ 
+    ZRAND__STAT(ZRAND_API_BOOL, 1);
+    return zrand_rng_bool(zrand__get()); 
+}
+
+bool zrand_chance(double probability) 
+{ 
+    ZRAND__STAT(ZRAND_API_CHANCE, 1);
+    return zrand_rng_chance(zrand__get(), probability); 
+}
+
+int32_t zrand_range(int32_t min, int32_t max) 
+{
+    ZRAND__STAT(ZRAND_API_RANGE, 1);
+    return zrand_rng_range(zrand__get(), min, max);
+}
+
+float zrand_range_f(float min, float max) 
+{
+    ZRAND__STAT(ZRAND_API_RANGE_F, 1);
+    return zrand_rng_range_f(zrand__get(), min, max);
+}
+
+#endif // ZRAND_BUFFERED
+
+double zrand_gaussian(double mean, double stddev) 
+{ 
+    ZRAND__STAT(ZRAND_API_GAUSSIAN, 1);
+    return zrand__box_muller(zrand__get(), mean, stddev); 
+}
+
+void zrand_bytes(void *buf, size_t len) 
+{
+    ZRAND__STAT(ZRAND_API_BYTES, 1);
+    zrand_rng_bytes(zrand__get(), buf, len);
+}
+
+void zrand_str(char *buf, size_t len) 
+{
+    ZRAND__STAT(ZRAND_API_STR, 1);
+    zrand_rng_str(zrand__get(), buf, len);
+}
+
+void zrand_uuid(char *buf) 
+{
+    ZRAND__STAT(ZRAND_API_UUID, 1);
+    zrand_rng_uuid(zrand__get(), buf);
+}
+
+void zrand_shuffle(void *base, size_t nmemb, size_t size) 
+{
+    ZRAND__STAT(ZRAND_API_SHUFFLE, 1);
+    zrand_rng_shuffle(zrand__get(), base, nmemb, size);
+}
+
+void* zrand_choice(void *base, size_t nmemb, size_t size) 
+{
+    ZRAND__STAT(ZRAND_API_CHOICE, 1);
+    return zrand_rng_choice(zrand__get(), base, nmemb, size);
+}
+
+// Noise implementation.
+
+#ifdef ZRAND_NOISE
+
+static const float ZRAND__GRAD2[8][2] = 
+{
+    {1, 1}, {-1, 1}, {1, -1}, {-1, -1}, {1, 0}, {-1, 0}, {0, 1}, {0, -1}
+};
+
+static const float ZRAND__GRAD3[12][3] = 
+{
+    {1, 1, 0}, {-1, 1, 0}, {1, -1, 0}, {-1, -1, 0},
+    {1, 0, 1}, {-1, 0, 1}, {1, 0, -1}, {-1, 0, -1},
+    {0, 1, 1}, {0, -1, 1}, {0, 1, -1}, {0, -1, -1}
+};
+
+static const float ZRAND__GRAD4[32][4] = 
+{
+    {0, 1, 1, 1}, {0, 1, 1, -1}, {0, 1, -1, 1}, {0, 1, -1, -1},
+    {0, -1, 1, 1}, {0, -1, 1, -1}, {0, -1, -1, 1}, {0, -1, -1, -1},
+    {1, 0, 1, 1}, {1, 0, 1, -1}, {1, 0, -1, 1}, {1, 0, -1, -1},
+    {-1, 0, 1, 1}, {-1, 0, 1, -1}, {-1, 0, -1, 1}, {-1, 0, -1, -1},
+    {1, 1, 0, 1}, {1, 1, 0, -1}, {1, -1, 0, 1}, {1, -1, 0, -1},
+    {-1, 1, 0, 1}, {-1, 1, 0, -1}, {-1, -1, 0, 1}, {-1, -1, 0, -1},
+    {1, 1, 1, 0}, {1, 1, -1, 0}, {1, -1, 1, 0}, {1, -1, -1, 0},
+    {-1, 1, 1, 0}, {-1, 1, -1, 0}, {-1, -1, 1, 0}, {-1, -1, -1, 0}
+};
+
+#define ZRAND__F2 0.36602540378f  // (sqrt(3) - 1) / 2
+#define ZRAND__G2 0.21132486540f  // (3 - sqrt(3)) / 6
+#define ZRAND__F3 (1.0f / 3.0f)
+#define ZRAND__G3 (1.0f / 6.0f)
+#define ZRAND__F4 0.30901699437f  // (sqrt(5) - 1) / 4
+#define ZRAND__G4 0.13819660112f  // (5 - sqrt(5)) / 20
+
+static inline int zrand__floor(float v) 
+{
+    int i = (int)v;
+    return i - (v < (float)i);
+}
+
+static inline float zrand__fade(float t) 
+{
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+static inline float zrand__lerp(float a, float b, float t) 
+{
+    return a + t * (b - a);
+}
+
+void zrand_noise_init(zrand_noise *noise, zrand_rng *rng) 
+{
+    for (int i = 0; i < 256; i++) 
+    {
+        noise->perm[i] = i;
+        noise->values[i] = zrand_rng_f32(rng) * 2.0f - 1.0f;
+    }
+    zrand_rng_shuffle(rng, noise->perm, 256, sizeof(int32_t));
+    for (int i = 0; i < 256; i++) 
+    {
+        noise->perm[i + 256] = noise->perm[i];
+    }
+}
+
+float zrand_noise_simplex2(const zrand_noise *noise, float x, float y) 
+{
+    const int32_t *perm = noise->perm;
+    float s = (x + y) * ZRAND__F2;
+    int i = zrand__floor(x + s);
+    int j = zrand__floor(y + s);
+    float t = (float)(i + j) * ZRAND__G2;
+    float x0 = x - ((float)i - t);
+    float y0 = y - ((float)j - t);
+
+    int i1 = x0 > y0;
+    int j1 = 1 - i1;
+    float x1 = x0 - (float)i1 + ZRAND__G2;
+    float y1 = y0 - (float)j1 + ZRAND__G2;
+    float x2 = x0 - 1.0f + 2.0f * ZRAND__G2;
+    float y2 = y0 - 1.0f + 2.0f * ZRAND__G2;
+
+    int ii = i & 255;
+    int jj = j & 255;
+    const float *g0 = ZRAND__GRAD2[perm[ii + perm[jj]] & 7];
+    const float *g1 = ZRAND__GRAD2[perm[ii + i1 + perm[jj + j1]] & 7];
+    const float *g2 = ZRAND__GRAD2[perm[ii + 1 + perm[jj + 1]] & 7];
+
+    float n = 0.0f;
+    float t0 = 0.5f - x0 * x0 - y0 * y0;
+    if (t0 > 0.0f) 
+    {
+        t0 *= t0;
+        n += t0 * t0 * (g0[0] * x0 + g0[1] * y0);
+    }
+    float t1 = 0.5f - x1 * x1 - y1 * y1;
+    if (t1 > 0.0f) 
+    {
+        t1 *= t1;
+        n += t1 * t1 * (g1[0] * x1 + g1[1] * y1);
+    }
+    float t2 = 0.5f - x2 * x2 - y2 * y2;
+    if (t2 > 0.0f) 
+    {
+        t2 *= t2;
+        n += t2 * t2 * (g2[0] * x2 + g2[1] * y2);
+    }
+    return 70.0f * n;
+}
+
+float zrand_noise_simplex3(const zrand_noise *noise, float x, float y, float z) 
+{
+    const int32_t *perm = noise->perm;
+    float s = (x + y + z) * ZRAND__F3;
+    int i = zrand__floor(x + s);
+    int j = zrand__floor(y + s);
+    int k = zrand__floor(z + s);
+    float t = (float)(i + j + k) * ZRAND__G3;
+    float x0 = x - ((float)i - t);
+    float y0 = y - ((float)j - t);
+    float z0 = z - ((float)k - t);
+
+    // Which simplex of the cube we are in.
+    int i1, j1, k1, i2, j2, k2;
+    if (x0 >= y0) 
+    {
+        if (y0 >= z0)      { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+        else if (x0 >= z0) { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; }
+        else               { i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; }
+    }
+    else 
+    {
+        if (y0 < z0)       { i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; }
+        else if (x0 < z0)  { i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; }
+        else               { i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+    }
+
+    float c[4][3] = 
+    {
+        {x0, y0, z0},
+        {x0 - i1 + ZRAND__G3, y0 - j1 + ZRAND__G3, z0 - k1 + ZRAND__G3},
+        {x0 - i2 + 2.0f * ZRAND__G3, y0 - j2 + 2.0f * ZRAND__G3, z0 - k2 + 2.0f * ZRAND__G3},
+        {x0 - 1.0f + 3.0f * ZRAND__G3, y0 - 1.0f + 3.0f * ZRAND__G3, z0 - 1.0f + 3.0f * ZRAND__G3}
+    };
+
+    int ii = i & 255, jj = j & 255, kk = k & 255;
+    int gi[4] = 
+    {
+        perm[ii + perm[jj + perm[kk]]] % 12,
+        perm[ii + i1 + perm[jj + j1 + perm[kk + k1]]] % 12,
+        perm[ii + i2 + perm[jj + j2 + perm[kk + k2]]] % 12,
+        perm[ii + 1 + perm[jj + 1 + perm[kk + 1]]] % 12
+    };
+
+    float n = 0.0f;
+    for (int q = 0; q < 4; q++) 
+    {
+        float tq = 0.6f - c[q][0] * c[q][0] - c[q][1] * c[q][1] - c[q][2] * c[q][2];
+        if (tq > 0.0f) 
+        {
+            const float *g = ZRAND__GRAD3[gi[q]];
+            tq *= tq;
+            n += tq * tq * (g[0] * c[q][0] + g[1] * c[q][1] + g[2] * c[q][2]);
+        }
+    }
+    return 32.0f * n;
+}
+
+float zrand_noise_simplex4(const zrand_noise *noise, float x, float y, float z, float w) 
+{
+    const int32_t *perm = noise->perm;
+    float s = (x + y + z + w) * ZRAND__F4;
+    int i = zrand__floor(x + s);
+    int j = zrand__floor(y + s);
+    int k = zrand__floor(z + s);
+    int l = zrand__floor(w + s);
+    float t = (float)(i + j + k + l) * ZRAND__G4;
+    float p0[4] = {x - ((float)i - t), y - ((float)j - t), z - ((float)k - t), w - ((float)l - t)};
+
+    // Rank the coordinates to find the simplex traversal order.
+    int rank[4] = {0, 0, 0, 0};
+    for (int a = 0; a < 4; a++) 
+    {
+        for (int b = a + 1; b < 4; b++) 
+        {
+            if (p0[a] > p0[b]) 
+            {
+                rank[a]++;
+            }
+            else 
+            {
+                rank[b]++;
+            }
+        }
+    }
+
+    int ii = i & 255, jj = j & 255, kk = k & 255, ll = l & 255;
+    float n = 0.0f;
+    for (int q = 0; q < 5; q++) 
+    {
+        // Corner q is offset by 1 on every axis whose rank is >= 4 - q.
+        int o[4];
+        float c[4];
+        for (int a = 0; a < 4; a++) 
+        {
+            o[a] = (q > 0) && rank[a] >= 4 - q;
+            c[a] = p0[a] - (float)o[a] + (float)q * ZRAND__G4;
+        }
+        float tq = 0.6f - c[0] * c[0] - c[1] * c[1] - c[2] * c[2] - c[3] * c[3];
+        if (tq > 0.0f) 
+        {
+            int gi = perm[ii + o[0] + perm[jj + o[1] + perm[kk + o[2] + perm[ll + o[3]]]]] & 31;
+            const float *g = ZRAND__GRAD4[gi];
+            tq *= tq;
+            n += tq * tq * (g[0] * c[0] + g[1] * c[1] + g[2] * c[2] + g[3] * c[3]);
+        }
+    }
+    return 27.0f * n;
+}
+
+float zrand_noise_value2(const zrand_noise *noise, float x, float y) 
+{
+    const int32_t *perm = noise->perm;
+    int xi = zrand__floor(x), yi = zrand__floor(y);
+    float fx = zrand__fade(x - (float)xi), fy = zrand__fade(y - (float)yi);
+    int x0 = xi & 255, y0 = yi & 255;
+    float v00 = noise->values[perm[x0 + perm[y0]]];
+    float v10 = noise->values[perm[x0 + 1 + perm[y0]]];
+    float v01 = noise->values[perm[x0 + perm[y0 + 1]]];
+    float v11 = noise->values[perm[x0 + 1 + perm[y0 + 1]]];
+    return zrand__lerp(zrand__lerp(v00, v10, fx), zrand__lerp(v01, v11, fx), fy);
+}
+
+float zrand_noise_value3(const zrand_noise *noise, float x, float y, float z) 
+{
+    const int32_t *perm = noise->perm;
+    int xi = zrand__floor(x), yi = zrand__floor(y), zi = zrand__floor(z);
+    float f[3] = {zrand__fade(x - (float)xi), zrand__fade(y - (float)yi), zrand__fade(z - (float)zi)};
+    int x0 = xi & 255, y0 = yi & 255, z0 = zi & 255;
+    float v[8];
+    for (int c = 0; c < 8; c++) 
+    {
+        int dx = c & 1, dy = (c >> 1) & 1, dz = (c >> 2) & 1;
+        v[c] = noise->values[perm[x0 + dx + perm[y0 + dy + perm[z0 + dz]]]];
+    }
+    float a = zrand__lerp(zrand__lerp(v[0], v[1], f[0]), zrand__lerp(v[2], v[3], f[0]), f[1]);
+    float b = zrand__lerp(zrand__lerp(v[4], v[5], f[0]), zrand__lerp(v[6], v[7], f[0]), f[1]);
+    return zrand__lerp(a, b, f[2]);
+}
+
+float zrand_noise_value4(const zrand_noise *noise, float x, float y, float z, float w) 
+{
+    const int32_t *perm = noise->perm;
+    int xi = zrand__floor(x), yi = zrand__floor(y), zi = zrand__floor(z), wi = zrand__floor(w);
+    float f[4] = {zrand__fade(x - (float)xi), zrand__fade(y - (float)yi), 
+                  zrand__fade(z - (float)zi), zrand__fade(w - (float)wi)};
+    int x0 = xi & 255, y0 = yi & 255, z0 = zi & 255, w0 = wi & 255;
+    float v[16];
+    for (int c = 0; c < 16; c++) 
+    {
+        int dx = c & 1, dy = (c >> 1) & 1, dz = (c >> 2) & 1, dw = (c >> 3) & 1;
+        v[c] = noise->values[perm[x0 + dx + perm[y0 + dy + perm[z0 + dz + perm[w0 + dw]]]]];
+    }
+    // Collapse one axis at a time.
+    for (int axis = 0, span = 16; axis < 4; axis++, span >>= 1) 
+    {
+        for (int c = 0; c < span / 2; c++) 
+        {
+            v[c] = zrand__lerp(v[2 * c], v[2 * c + 1], f[axis]);
+        }
+    }
+    return v[0];
+}
+
+float zrand_noise_fbm2(const zrand_noise *noise, float x, float y, int octaves, float lacunarity, float gain) 
+{
+    float sum = 0.0f, amp = 1.0f, norm = 0.0f, freq = 1.0f;
+    for (int o = 0; o < octaves; o++) 
+    {
+        sum += amp * zrand_noise_simplex2(noise, x * freq, y * freq);
+        norm += amp;
+        amp *= gain;
+        freq *= lacunarity;
+    }
+    return norm > 0.0f ? sum / norm : 0.0f;
+}
+
+float zrand_noise_fbm3(const zrand_noise *noise, float x, float y, float z, int octaves, float lacunarity, float gain) 
+{
+    float sum = 0.0f, amp = 1.0f, norm = 0.0f, freq = 1.0f;
+    for (int o = 0; o < octaves; o++) 
+    {
+        sum += amp * zrand_noise_simplex3(noise, x * freq, y * freq, z * freq);
+        norm += amp;
+        amp *= gain;
+        freq *= lacunarity;
+    }
+    return norm > 0.0f ? sum / norm : 0.0f;
+}
+
+// Adds amp * simplex2(x0 + i * dx, y) to out[i] for i < n.
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+static void zrand__simplex2_row(const zrand_noise *noise, float x0, float dx, float y, size_t n, float amp, float *out) 
+{
+    const int32_t *perm = noise->perm;
+    const __m256 gx = _mm256_setr_ps(1, -1, 1, -1, 1, -1, 0, 0);
+    const __m256 gy = _mm256_setr_ps(1, 1, -1, -1, 0, 0, 1, -1);
+    const __m256 f2 = _mm256_set1_ps(ZRAND__F2);
+    const __m256 g2 = _mm256_set1_ps(ZRAND__G2);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256i m255 = _mm256_set1_epi32(255);
+    const __m256i m7 = _mm256_set1_epi32(7);
+    const __m256i ione = _mm256_set1_epi32(1);
+    const __m256 vamp = _mm256_set1_ps(amp * 70.0f);
+    const __m256 yv = _mm256_set1_ps(y);
+    const __m256 lane = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) 
+    {
+        __m256 xv = _mm256_add_ps(_mm256_set1_ps(x0), _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps((float)i), lane), _mm256_set1_ps(dx)));
+        __m256 s = _mm256_mul_ps(_mm256_add_ps(xv, yv), f2);
+        __m256 fi = _mm256_floor_ps(_mm256_add_ps(xv, s));
+        __m256 fj = _mm256_floor_ps(_mm256_add_ps(yv, s));
+        __m256 t = _mm256_mul_ps(_mm256_add_ps(fi, fj), g2);
+        __m256 x0v = _mm256_sub_ps(xv, _mm256_sub_ps(fi, t));
+        __m256 y0v = _mm256_sub_ps(yv, _mm256_sub_ps(fj, t));
+
+        __m256 mx = _mm256_cmp_ps(x0v, y0v, _CMP_GT_OQ);
+        __m256 i1 = _mm256_and_ps(mx, one);
+        __m256 j1 = _mm256_sub_ps(one, i1);
+        __m256 x1v = _mm256_add_ps(_mm256_sub_ps(x0v, i1), g2);
+        __m256 y1v = _mm256_add_ps(_mm256_sub_ps(y0v, j1), g2);
+        __m256 x2v = _mm256_add_ps(_mm256_sub_ps(x0v, one), _mm256_add_ps(g2, g2));
+        __m256 y2v = _mm256_add_ps(_mm256_sub_ps(y0v, one), _mm256_add_ps(g2, g2));
+
+        __m256i ii = _mm256_and_si256(_mm256_cvtps_epi32(fi), m255);
+        __m256i jj = _mm256_and_si256(_mm256_cvtps_epi32(fj), m255);
+        __m256i ii1 = _mm256_cvtps_epi32(i1);
+        __m256i jj1 = _mm256_cvtps_epi32(j1);
+
+        __m256i h0 = _mm256_i32gather_epi32(perm, _mm256_add_epi32(ii, _mm256_i32gather_epi32(perm, jj, 4)), 4);
+        __m256i h1 = _mm256_i32gather_epi32(perm, _mm256_add_epi32(_mm256_add_epi32(ii, ii1), 
+                         _mm256_i32gather_epi32(perm, _mm256_add_epi32(jj, jj1), 4)), 4);
+        __m256i h2 = _mm256_i32gather_epi32(perm, _mm256_add_epi32(_mm256_add_epi32(ii, ione), 
+                         _mm256_i32gather_epi32(perm, _mm256_add_epi32(jj, ione), 4)), 4);
+
+        __m256 acc = zero;
+        __m256 xs[3] = {x0v, x1v, x2v};
+        __m256 ys[3] = {y0v, y1v, y2v};
+        __m256i hs[3] = {h0, h1, h2};
+        for (int c = 0; c < 3; c++) 
+        {
+            __m256i g = _mm256_and_si256(hs[c], m7);
+            __m256 dot = _mm256_add_ps(_mm256_mul_ps(_mm256_permutevar8x32_ps(gx, g), xs[c]), 
+                                       _mm256_mul_ps(_mm256_permutevar8x32_ps(gy, g), ys[c]));
+            __m256 tc = _mm256_sub_ps(_mm256_sub_ps(half, _mm256_mul_ps(xs[c], xs[c])), _mm256_mul_ps(ys[c], ys[c]));
+            tc = _mm256_max_ps(tc, zero);
+            tc = _mm256_mul_ps(tc, tc);
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_mul_ps(tc, tc), dot));
+        }
+        __m256 prev = _mm256_loadu_ps(out + i);
+        _mm256_storeu_ps(out + i, _mm256_add_ps(prev, _mm256_mul_ps(acc, vamp)));
+    }
+    for (; i < n; i++) 
+    {
+        out[i] += amp * zrand_noise_simplex2(noise, x0 + (float)i * dx, y);
+    }
+}
+#else
+static void zrand__simplex2_row(const zrand_noise *noise, float x0, float dx, float y, size_t n, float amp, float *out) 
+{
+    for (size_t i = 0; i < n; i++) 
+    {
+        out[i] += amp * zrand_noise_simplex2(noise, x0 + (float)i * dx, y);
+    }
+}
+#endif
+
+void zrand_noise_simplex2_grid(const zrand_noise *noise, float x0, float y0, float step, size_t w, size_t h, float *out) 
+{
+    memset(out, 0, w * h * sizeof(float));
+    for (size_t j = 0; j < h; j++) 
+    {
+        zrand__simplex2_row(noise, x0, step, y0 + (float)j * step, w, 1.0f, out + j * w);
+    }
+}
+
+void zrand_noise_fbm2_grid(const zrand_noise *noise, float x0, float y0, float step, size_t w, size_t h, 
+                           int octaves, float lacunarity, float gain, float *out) 
+{
+    memset(out, 0, w * h * sizeof(float));
+    float amp = 1.0f, norm = 0.0f, freq = 1.0f;
+    for (int o = 0; o < octaves; o++) 
+    {
+        norm += amp;
+        for (size_t j = 0; j < h; j++) 
+        {
+            float y = (y0 + (float)j * step) * freq;
+            zrand__simplex2_row(noise, x0 * freq, step * freq, y, w, amp, out + j * w);
+        }
+        amp *= gain;
+        freq *= lacunarity;
+    }
+    if (norm > 0.0f) 
+    {
+        float inv = 1.0f / norm;
+        for (size_t i = 0; i < w * h; i++) 
+        {
+            out[i] *= inv;
+        }
+    }
+}
+
+#endif // ZRAND_NOISE
+
+// Spatial sampling implementation.
+
+#ifdef ZRAND_SAMPLING
+
+#include <math.h>
+
+#define ZRAND__TAU 6.28318530717958647692f
+
+// 2D grid cells hold the (x, y) of their point, so a neighbourhood check
+// reads short runs of adjacent cells instead of chasing point indices. A
+// border of two cells (empty, or wrapped copies when tileable) removes the
+// bounds tests. Empty cells hold a far-away point: its squared distance to
+// any candidate stays finite and never conflicts.
+#define ZRAND__POISSON_EMPTY 1e18f
+
+static void zrand__poisson2_put(float *cells, size_t stride, int gw, int gh, float width, float height, 
+                                bool tileable, int gx, int gy, float x, float y) 
+{
+    float *c = cells + 2 * ((size_t)(gy + 2) * stride + (size_t)(gx + 2));
+    c[0] = x;
+    c[1] = y;
+    if (!tileable || (gx >= 2 && gx < gw - 2 && gy >= 2 && gy < gh - 2)) 
+    {
+        return;
+    }
+    // Near an edge: copy the point, shifted by the domain size, into every
+    // border cell it wraps to.
+    for (int oy = -2; oy <= 2; oy++) 
+    {
+        for (int ox = -2; ox <= 2; ox++) 
+        {
+            int wx = gx + ox * gw;
+            int wy = gy + oy * gh;
+            if ((0 == ox && 0 == oy) || wx < -2 || wx >= gw + 2 || wy < -2 || wy >= gh + 2) 
+            {
+                continue;
+            }
+            c = cells + 2 * ((size_t)(wy + 2) * stride + (size_t)(wx + 2));
+            c[0] = x + (float)ox * width;
+            c[1] = y + (float)oy * height;
+        }
+    }
+}
+
+// True when no point of the 5x5 block around cell (gx, gy) is within `r2`
+// of (x, y). The nearest rows go first: most rejections are decided there.
+static bool zrand__poisson2_free(const float *cells, size_t stride, int gx, int gy, float x, float y, float r2) 
+{
+    static const int rows[5] = { 0, -1, 1, -2, 2 };
+    const float *center = cells + 2 * ((size_t)(gy + 2) * stride + (size_t)(gx + 2));
+    for (int r = 0; r < 5; r++) 
+    {
+        const float *c = center + 2 * (ptrdiff_t)rows[r] * (ptrdiff_t)stride;
+        bool hit = false;
+        for (int dx = -2; dx <= 2; dx++) 
+        {
+            float ddx = c[2 * dx] - x;
+            float ddy = c[2 * dx + 1] - y;
+            hit |= ddx * ddx + ddy * ddy < r2;
+        }
+        if (hit) 
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t zrand_poisson2(zrand_rng *rng, float width, float height, float radius, int k, bool tileable, 
+                      float *out_xy, size_t max_points) 
+{
+    if (radius <= 0.0f || width <= 0.0f || height <= 0.0f || 0 == max_points) 
+    {
+        return 0;
+    }
+    if (k <= 0) 
+    {
+        k = 30;
+    }
+    // Cells of side r / sqrt(2) hold at most one point each.
+    float cell = radius * 0.70710678f;
+    int gw = (int)ceilf(width / cell);
+    int gh = (int)ceilf(height / cell);
+    if (tileable) 
+    {
+        // Wrapped neighbourhoods need cells that exactly divide the domain.
+        cell = (width / gw < height / gh) ? width / gw : height / gh;
+        gw = (int)(width / cell + 0.5f);
+        gh = (int)(height / cell + 0.5f);
+        cell = width / gw;
+    }
+    float inv_cell = 1.0f / cell;
+    float r2 = radius * radius;
+
+    size_t stride = (size_t)gw + 4;
+    size_t ncells = stride * ((size_t)gh + 4);
+    float *cells = (float*)malloc(ncells * 2 * sizeof(float));
+    float *active = (float*)malloc(max_points * 2 * sizeof(float));
+    if (!cells || !active) 
+    {
+        free(cells);
+        free(active);
+        return 0;
+    }
+    for (size_t i = 0; i < 2 * ncells; i++) 
+    {
+        cells[i] = ZRAND__POISSON_EMPTY;
+    }
+
+    float x = zrand_rng_f32(rng) * width;
+    float y = zrand_rng_f32(rng) * height;
+    int gx0 = (int)(x * inv_cell);
+    int gy0 = (int)(y * inv_cell);
+    out_xy[0] = x;
+    out_xy[1] = y;
+    zrand__poisson2_put(cells, stride, gw, gh, width, height, tileable, 
+                        gx0 < gw ? gx0 : gw - 1, gy0 < gh ? gy0 : gh - 1, x, y);
+    // The active list holds coordinates, not indices, to save a dependent load.
+    active[0] = x;
+    active[1] = y;
+    size_t nactive = 1;
+    size_t count = 1;
+
+    while (nactive > 0 && count < max_points) 
+    {
+        size_t slot = (size_t)zrand_rng_range(rng, 0, (int32_t)nactive - 1);
+        float sx = active[2 * slot];
+        float sy = active[2 * slot + 1];
+        bool placed = false;
+        for (int attempt = 0; attempt < k && !placed; attempt++) 
+        {
+            // Uniform by area in the annulus [r, 2r): rejection from the
+            // enclosing square keeps 3pi/16 (about 59%) of the pairs and
+            // needs no trigonometry or square root.
+            float ox, oy, d2;
+            do 
+            {
+                ox = (zrand_rng_f32(rng) * 4.0f - 2.0f) * radius;
+                oy = (zrand_rng_f32(rng) * 4.0f - 2.0f) * radius;
+                d2 = ox * ox + oy * oy;
+            } while (d2 < r2 || d2 >= 4.0f * r2);
+            float cx = sx + ox;
+            float cy = sy + oy;
+            if (tileable) 
+            {
+                cx = cx - width * floorf(cx / width);
+                cy = cy - height * floorf(cy / height);
+            }
+            if (cx < 0.0f || cy < 0.0f || cx >= width || cy >= height) 
+            {
+                continue;
+            }
+            int gx = (int)(cx * inv_cell);
+            int gy = (int)(cy * inv_cell);
+            gx = gx < gw ? gx : gw - 1;
+            gy = gy < gh ? gy : gh - 1;
+
+            if (zrand__poisson2_free(cells, stride, gx, gy, cx, cy, r2)) 
+            {
+                out_xy[2 * count] = cx;
+                out_xy[2 * count + 1] = cy;
+                zrand__poisson2_put(cells, stride, gw, gh, width, height, tileable, gx, gy, cx, cy);
+                active[2 * nactive] = cx;
+                active[2 * nactive + 1] = cy;
+                nactive++;
+                count++;
+                placed = true;
+            }
+        }
+        if (!placed) 
+        {
+            // Exhausted: swap-remove from the active list.
+            nactive--;
+            active[2 * slot] = active[2 * nactive];
+            active[2 * slot + 1] = active[2 * nactive + 1];
+        }
+    }
+    free(cells);
+    free(active);
+    return count;
+}
+
+// 3D cells keep x, y and z in three separate grids, each with the same
+// two-cell border, so the five cells of a row are contiguous in each grid
+// and AVX2 checks a row with one load per axis. Planes and rows go nearest
+// first.
+static bool zrand__poisson3_free(const float *cells, size_t ncells, size_t stride, size_t plane, 
+                                 int gx, int gy, int gz, float x, float y, float z, float r2) 
+{
+    static const int order[5] = { 0, -1, 1, -2, 2 };
+    // Index of the first cell of the centre row.
+    size_t center = (size_t)(gz + 2) * plane + (size_t)(gy + 2) * stride + (size_t)gx;
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+    const __m256 vx = _mm256_set1_ps(x), vy = _mm256_set1_ps(y), vz = _mm256_set1_ps(z);
+    const __m256 vr2 = _mm256_set1_ps(r2);
+#endif
+    for (int pz = 0; pz < 5; pz++) 
+    {
+        for (int r = 0; r < 5; r++) 
+        {
+            const float *cx = cells + center + (ptrdiff_t)order[pz] * (ptrdiff_t)plane + (ptrdiff_t)order[r] * (ptrdiff_t)stride;
+            const float *cy = cx + ncells;
+            const float *cz = cy + ncells;
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+            // Eight lanes, of which the row's five count. Same operation
+            // order as the scalar loop, so both builds agree exactly.
+            __m256 ddx = _mm256_sub_ps(_mm256_loadu_ps(cx), vx);
+            __m256 ddy = _mm256_sub_ps(_mm256_loadu_ps(cy), vy);
+            __m256 ddz = _mm256_sub_ps(_mm256_loadu_ps(cz), vz);
+            __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ddx, ddx), _mm256_mul_ps(ddy, ddy)), _mm256_mul_ps(ddz, ddz));
+            bool hit = 0 != (_mm256_movemask_ps(_mm256_cmp_ps(d2, vr2, _CMP_LT_OQ)) & 0x1F);
+#else
+            bool hit = false;
+            for (int i = 0; i < 5; i++) 
+            {
+                float ddx = cx[i] - x;
+                float ddy = cy[i] - y;
+                float ddz = cz[i] - z;
+                hit |= ddx * ddx + ddy * ddy + ddz * ddz < r2;
+            }
+#endif
+            if (hit) 
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void zrand__poisson3_put(float *cells, size_t ncells, size_t stride, size_t plane, 
+                                int gx, int gy, int gz, const float *c) 
+{
+    size_t i = (size_t)(gz + 2) * plane + (size_t)(gy + 2) * stride + (size_t)(gx + 2);
+    cells[i] = c[0];
+    cells[ncells + i] = c[1];
+    cells[2 * ncells + i] = c[2];
+}
+
+// Active points are bucketed by z slab and drawn from the lowest non-empty
+// slab, so the sampler sweeps the grid a few planes at a time instead of
+// touching all of it at random.
+#define ZRAND__POISSON_SLAB 8
+
+typedef struct 
+{
+    float *xyz;
+    size_t n, cap;
+} zrand__poisson_slab;
+
+static bool zrand__poisson_slab_push(zrand__poisson_slab *s, const float *c) 
+{
+    if (s->n == s->cap) 
+    {
+        size_t cap = s->cap ? 2 * s->cap : 64;
+        float *xyz = (float*)realloc(s->xyz, cap * 3 * sizeof(float));
+        if (!xyz) 
+        {
+            return false;
+        }
+        s->xyz = xyz;
+        s->cap = cap;
+    }
+    memcpy(s->xyz + 3 * s->n++, c, 3 * sizeof(float));
+    return true;
+}
+
+size_t zrand_poisson3(zrand_rng *rng, float width, float height, float depth, float radius, int k, 
+                      float *out_xyz, size_t max_points) 
+{
+    if (radius <= 0.0f || width <= 0.0f || height <= 0.0f || depth <= 0.0f || 0 == max_points) 
+    {
+        return 0;
+    }
+    if (k <= 0) 
+    {
+        k = 30;
+    }
+    float cell = radius * 0.57735027f; // r / sqrt(3)
+    float inv_cell = 1.0f / cell;
+    int gw = (int)ceilf(width * inv_cell);
+    int gh = (int)ceilf(height * inv_cell);
+    int gd = (int)ceilf(depth * inv_cell);
+    float r2 = radius * radius;
+
+    size_t stride = (size_t)gw + 4;
+    size_t plane = stride * ((size_t)gh + 4);
+    size_t ncells = plane * ((size_t)gd + 4);
+    int nslabs = (gd + ZRAND__POISSON_SLAB - 1) / ZRAND__POISSON_SLAB;
+    // Eight floats of slack for the last row's SIMD load.
+    float *cells = (float*)malloc((3 * ncells + 8) * sizeof(float));
+    zrand__poisson_slab *slabs = (zrand__poisson_slab*)calloc((size_t)nslabs, sizeof(zrand__poisson_slab));
+    if (!cells || !slabs) 
+    {
+        free(cells);
+        free(slabs);
+        return 0;
+    }
+    for (size_t i = 0; i < 3 * ncells + 8; i++) 
+    {
+        cells[i] = ZRAND__POISSON_EMPTY;
+    }
+
+    float c[3];
+    c[0] = zrand_rng_f32(rng) * width;
+    c[1] = zrand_rng_f32(rng) * height;
+    c[2] = zrand_rng_f32(rng) * depth;
+    int gx = (int)(c[0] * inv_cell), gy = (int)(c[1] * inv_cell), gz = (int)(c[2] * inv_cell);
+    gx = gx < gw ? gx : gw - 1;
+    gy = gy < gh ? gy : gh - 1;
+    gz = gz < gd ? gz : gd - 1;
+    memcpy(out_xyz, c, sizeof(c));
+    zrand__poisson3_put(cells, ncells, stride, plane, gx, gy, gz, c);
+    size_t count = 1;
+    int low = gz / ZRAND__POISSON_SLAB;
+    bool ok = zrand__poisson_slab_push(&slabs[low], c);
+
+    while (ok && low < nslabs && count < max_points) 
+    {
+        zrand__poisson_slab *s = &slabs[low];
+        if (0 == s->n) 
+        {
+            low++;
+            continue;
+        }
+        size_t slot = (size_t)zrand_rng_range(rng, 0, (int32_t)s->n - 1);
+        float sx = s->xyz[3 * slot];
+        float sy = s->xyz[3 * slot + 1];
+        float sz = s->xyz[3 * slot + 2];
+        bool placed = false;
+        for (int attempt = 0; attempt < k && !placed; attempt++) 
+        {
+            // Uniform by volume in the shell [r, 2r): rejection from the
+            // enclosing cube keeps 7pi/48 (about 46%) of the triples.
+            float ox, oy, oz, d2;
+            do 
+            {
+                ox = (zrand_rng_f32(rng) * 4.0f - 2.0f) * radius;
+                oy = (zrand_rng_f32(rng) * 4.0f - 2.0f) * radius;
+                oz = (zrand_rng_f32(rng) * 4.0f - 2.0f) * radius;
+                d2 = ox * ox + oy * oy + oz * oz;
+            } while (d2 < r2 || d2 >= 4.0f * r2);
+            c[0] = sx + ox;
+            c[1] = sy + oy;
+            c[2] = sz + oz;
+            if (c[0] < 0.0f || c[1] < 0.0f || c[2] < 0.0f || c[0] >= width || c[1] >= height || c[2] >= depth) 
+            {
+                continue;
+            }
+            gx = (int)(c[0] * inv_cell);
+            gy = (int)(c[1] * inv_cell);
+            gz = (int)(c[2] * inv_cell);
+            gx = gx < gw ? gx : gw - 1;
+            gy = gy < gh ? gy : gh - 1;
+            gz = gz < gd ? gz : gd - 1;
+
+            if (zrand__poisson3_free(cells, ncells, stride, plane, gx, gy, gz, c[0], c[1], c[2], r2)) 
+            {
+                memcpy(out_xyz + 3 * count, c, sizeof(c));
+                zrand__poisson3_put(cells, ncells, stride, plane, gx, gy, gz, c);
+                // A point can land one slab below the sweep; go back for it.
+                int slab = gz / ZRAND__POISSON_SLAB;
+                ok = zrand__poisson_slab_push(&slabs[slab], c);
+                low = slab < low ? slab : low;
+                count++;
+                placed = true;
+            }
+        }
+        if (!placed) 
+        {
+            // Exhausted: swap-remove from its slab.
+            s->n--;
+            memcpy(s->xyz + 3 * slot, s->xyz + 3 * s->n, sizeof(c));
+        }
+    }
+    for (int i = 0; i < nslabs; i++) 
+    {
+        free(slabs[i].xyz);
+    }
+    free(cells);
+    free(slabs);
+    return ok ? count : 0;
+}
+
+// Void-and-cluster (Ulichney 1993) on a torus with a Gaussian filter.
+
+static void zrand__vac_splat(float *energy, const float *kernel, size_t size, size_t px, size_t py, float sign) 
+{
+    for (size_t y = 0; y < size; y++) 
+    {
+        const float *krow = kernel + ((y + size - py) % size) * size;
+        float *erow = energy + y * size;
+        size_t shift = size - px;
+        for (size_t x = 0; x < size; x++) 
+        {
+            size_t kx = x + shift;
+            erow[x] += sign * krow[kx >= size ? kx - size : kx];
+        }
+    }
+}
+
+static size_t zrand__vac_find(const float *energy, const uint8_t *bits, size_t n, uint8_t want, bool tightest) 
+{
+    size_t best = 0;
+    bool found = false;
+    for (size_t i = 0; i < n; i++) 
+    {
+        if (bits[i] != want) 
+        {
+            continue;
+        }
+        if (!found || (tightest ? energy[i] > energy[best] : energy[i] < energy[best])) 
+        {
+            best = i;
+            found = true;
+        }
+    }
+    return best;
+}
+
+bool zrand_blue_noise_mask(zrand_rng *rng, size_t size, float *out) 
+{
+    if (0 == size) 
+    {
+        return true;
+    }
+    size_t n = size * size;
+    float *kernel = (float*)malloc(n * sizeof(float));
+    float *energy = (float*)calloc(n, sizeof(float));
+    float *proto_energy = (float*)malloc(n * sizeof(float));
+    uint8_t *bits = (uint8_t*)calloc(n, 1);
+    uint8_t *proto = (uint8_t*)malloc(n);
+    if (!kernel || !energy || !proto_energy || !bits || !proto) 
+    {
+        free(kernel); free(energy); free(proto_energy); free(bits); free(proto);
+        return false;
+    }
+
+    // Toroidal Gaussian, sigma = 1.5.
+    for (size_t y = 0; y < size; y++) 
+    {
+        for (size_t x = 0; x < size; x++) 
+        {
+            float dx = (float)(x <= size / 2 ? x : size - x);
+            float dy = (float)(y <= size / 2 ? y : size - y);
+            kernel[y * size + x] = expf(-(dx * dx + dy * dy) / (2.0f * 1.5f * 1.5f));
+        }
+    }
+
+    // Random initial pattern with ~10% ones.
+    size_t ones = n / 10 ? n / 10 : 1;
+    for (size_t placed = 0; placed < ones;) 
+    {
+        size_t i = (size_t)zrand_rng_range(rng, 0, (int32_t)n - 1);
+        if (!bits[i]) 
+        {
+            bits[i] = 1;
+            zrand__vac_splat(energy, kernel, size, i % size, i / size, 1.0f);
+            placed++;
+        }
+    }
+
+    // Relax into the prototype: move the tightest cluster into the largest void.
+    for (size_t iter = 0; iter < n; iter++) 
+    {
+        size_t c = zrand__vac_find(energy, bits, n, 1, true);
+        bits[c] = 0;
+        zrand__vac_splat(energy, kernel, size, c % size, c / size, -1.0f);
+        size_t v = zrand__vac_find(energy, bits, n, 0, false);
+        bits[v] = 1;
+        zrand__vac_splat(energy, kernel, size, v % size, v / size, 1.0f);
+        if (v == c) 
+        {
+            break;
+        }
+    }
+    memcpy(proto, bits, n);
+    memcpy(proto_energy, energy, n * sizeof(float));
+
+    // Phase 1: peel clusters off the prototype, ranks ones-1 .. 0.
+    for (size_t rank = ones; rank-- > 0;) 
+    {
+        size_t c = zrand__vac_find(energy, bits, n, 1, true);
+        bits[c] = 0;
+        zrand__vac_splat(energy, kernel, size, c % size, c / size, -1.0f);
+        out[c] = (float)rank;
+    }
+
+    // Phases 2 and 3: fill the largest voids, ranks ones .. n-1. The tightest
+    // cluster of zeros is the zero with the lowest energy from the ones.
+    memcpy(bits, proto, n);
+    memcpy(energy, proto_energy, n * sizeof(float));
+    for (size_t rank = ones; rank < n; rank++) 
+    {
+        size_t v = zrand__vac_find(energy, bits, n, 0, false);
+        bits[v] = 1;
+        zrand__vac_splat(energy, kernel, size, v % size, v / size, 1.0f);
+        out[v] = (float)rank;
+    }
+
+    float inv = 1.0f / (float)n;
+    for (size_t i = 0; i < n; i++) 
+    {
+        out[i] *= inv;
+    }
+    free(kernel); free(energy); free(proto_energy); free(bits); free(proto);
+    return true;
+}
+
+void zrand_rng_disk(zrand_rng *rng, float out[2]) 
+{
+    // Inverse CDF of the radius: P(r' < r) = r^2.
+    float r = sqrtf(zrand_rng_f32(rng));
+    float a = zrand_rng_f32(rng) * ZRAND__TAU;
+    out[0] = r * cosf(a);
+    out[1] = r * sinf(a);
+}
+
+void zrand_rng_circle(zrand_rng *rng, float out[2]) 
+{
+    float a = zrand_rng_f32(rng) * ZRAND__TAU;
+    out[0] = cosf(a);
+    out[1] = sinf(a);
+}
+
+static inline void zrand__sphere_from(float u, float v, float *x, float *y, float *z) 
+{
+    float cz = 1.0f - 2.0f * u;
+    float sxy = sqrtf(fmaxf(0.0f, 1.0f - cz * cz));
+    float a = v * ZRAND__TAU;
+    *x = sxy * cosf(a);
+    *y = sxy * sinf(a);
+    *z = cz;
+}
+
+void zrand_rng_sphere(zrand_rng *rng, float out[3]) 
+{
+    float u = zrand_rng_f32(rng);
+    float v = zrand_rng_f32(rng);
+    zrand__sphere_from(u, v, &out[0], &out[1], &out[2]);
+}
+
+void zrand_rng_ball(zrand_rng *rng, float out[3]) 
+{
+    zrand_rng_sphere(rng, out);
+    float r = cbrtf(zrand_rng_f32(rng));
+    out[0] *= r;
+    out[1] *= r;
+    out[2] *= r;
+}
+
+// Orthonormal basis (t, b) perpendicular to the unit vector n (Duff et al. 2017).
+static inline void zrand__basis(const float n[3], float t[3], float b[3]) 
+{
+    float sign = copysignf(1.0f, n[2]);
+    float a = -1.0f / (sign + n[2]);
+    float c = n[0] * n[1] * a;
+    t[0] = 1.0f + sign * n[0] * n[0] * a;
+    t[1] = sign * c;
+    t[2] = -sign * n[0];
+    b[0] = c;
+    b[1] = sign + n[1] * n[1] * a;
+    b[2] = -n[1];
+}
+
+static inline void zrand__cone_from(const float axis[3], const float t[3], const float b[3], float cos_max, 
+                                    float u, float v, float *x, float *y, float *z) 
+{
+    // Cap area is linear in cos(theta).
+    float ct = 1.0f - u * (1.0f - cos_max);
+    float st = sqrtf(fmaxf(0.0f, 1.0f - ct * ct));
+    float a = v * ZRAND__TAU;
+    float lx = st * cosf(a), ly = st * sinf(a);
+    *x = lx * t[0] + ly * b[0] + ct * axis[0];
+    *y = lx * t[1] + ly * b[1] + ct * axis[1];
+    *z = lx * t[2] + ly * b[2] + ct * axis[2];
+}
+
+void zrand_rng_cone(zrand_rng *rng, const float axis[3], float half_angle, float out[3]) 
+{
+    float t[3], b[3];
+    zrand__basis(axis, t, b);
+    float u = zrand_rng_f32(rng);
+    float v = zrand_rng_f32(rng);
+    zrand__cone_from(axis, t, b, cosf(half_angle), u, v, &out[0], &out[1], &out[2]);
+}
+
+void zrand_rng_triangle(zrand_rng *rng, const float a[3], const float b[3], const float c[3], float out[3]) 
+{
+    float s = sqrtf(zrand_rng_f32(rng));
+    float v = zrand_rng_f32(rng);
+    float wa = 1.0f - s, wb = s * (1.0f - v), wc = s * v;
+    for (int i = 0; i < 3; i++) 
+    {
+        out[i] = wa * a[i] + wb * b[i] + wc * c[i];
+    }
+}
+
+void zrand_rng_disk_batch(zrand_rng *rng, float *xs, float *ys, size_t n) 
+{
+    for (size_t i = 0; i < n; i++) 
+    {
+        float r = sqrtf(zrand_rng_f32(rng));
+        float a = zrand_rng_f32(rng) * ZRAND__TAU;
+        xs[i] = r * cosf(a);
+        ys[i] = r * sinf(a);
+    }
+}
+
+void zrand_rng_circle_batch(zrand_rng *rng, float *xs, float *ys, size_t n) 
+{
+    for (size_t i = 0; i < n; i++) 
+    {
+        float a = zrand_rng_f32(rng) * ZRAND__TAU;
+        xs[i] = cosf(a);
+        ys[i] = sinf(a);
+    }
+}
+
+void zrand_rng_sphere_batch(zrand_rng *rng, float *xs, float *ys, float *zs, size_t n) 
+{
+    for (size_t i = 0; i < n; i++) 
+    {
+        float u = zrand_rng_f32(rng);
+        float v = zrand_rng_f32(rng);
+        zrand__sphere_from(u, v, &xs[i], &ys[i], &zs[i]);
+    }
+}
+
+void zrand_rng_ball_batch(zrand_rng *rng, float *xs, float *ys, float *zs, size_t n) 
+{
+    for (size_t i = 0; i < n; i++) 
+    {
+        float u = zrand_rng_f32(rng);
+        float v = zrand_rng_f32(rng);
+        float r = cbrtf(zrand_rng_f32(rng));
+        zrand__sphere_from(u, v, &xs[i], &ys[i], &zs[i]);
+        xs[i] *= r;
+        ys[i] *= r;
+        zs[i] *= r;
+    }
+}
+
+void zrand_rng_cone_batch(zrand_rng *rng, const float axis[3], float half_angle, 
+                          float *xs, float *ys, float *zs, size_t n) 
+{
+    float t[3], b[3];
+    zrand__basis(axis, t, b);
+    float cos_max = cosf(half_angle);
+    for (size_t i = 0; i < n; i++) 
+    {
+        float u = zrand_rng_f32(rng);
+        float v = zrand_rng_f32(rng);
+        zrand__cone_from(axis, t, b, cos_max, u, v, &xs[i], &ys[i], &zs[i]);
+    }
+}
+
+static float zrand__tri_area(const float *verts, const uint32_t *tri) 
+{
+    const float *a = verts + 3 * tri[0], *b = verts + 3 * tri[1], *c = verts + 3 * tri[2];
+    float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+    float x = e1[1] * e2[2] - e1[2] * e2[1];
+    float y = e1[2] * e2[0] - e1[0] * e2[2];
+    float z = e1[0] * e2[1] - e1[1] * e2[0];
+    return 0.5f * sqrtf(x * x + y * y + z * z);
+}
+
+bool zrand_mesh_sampler_init(zrand_mesh_sampler *s, const float *verts, const uint32_t *indices, size_t tri_count) 
+{
+    memset(s, 0, sizeof(*s));
+    if (0 == tri_count || tri_count > UINT32_MAX) 
+    {
+        return false;
+    }
+    s->prob = (float*)malloc(tri_count * sizeof(float));
+    s->alias = (uint32_t*)malloc(tri_count * sizeof(uint32_t));
+    uint32_t *work = (uint32_t*)malloc(tri_count * sizeof(uint32_t));
+    double *scaled = (double*)malloc(tri_count * sizeof(double));
+    if (!s->prob || !s->alias || !work || !scaled) 
+    {
+        free(work);
+        free(scaled);
+        zrand_mesh_sampler_free(s);
+        return false;
+    }
+
+    double total = 0.0;
+    for (size_t i = 0; i < tri_count; i++) 
+    {
+        scaled[i] = zrand__tri_area(verts, indices + 3 * i);
+        total += scaled[i];
+    }
+    if (!(total > 0.0)) 
+    {
+        free(work);
+        free(scaled);
+        zrand_mesh_sampler_free(s);
+        return false;
+    }
+
+    // Vose: small entries fill from the front of `work`, large from the back.
+    size_t nsmall = 0, nlarge = tri_count;
+    for (size_t i = 0; i < tri_count; i++) 
+    {
+        scaled[i] *= (double)tri_count / total;
+        if (scaled[i] < 1.0) 
+        {
+            work[nsmall++] = (uint32_t)i;
+        }
+        else 
+        {
+            work[--nlarge] = (uint32_t)i;
+        }
+    }
+    size_t small_head = 0, large_head = nlarge;
+    while (small_head < nsmall && large_head < tri_count) 
+    {
+        uint32_t sm = work[small_head++];
+        uint32_t lg = work[large_head];
+        s->prob[sm] = (float)scaled[sm];
+        s->alias[sm] = lg;
+        scaled[lg] -= 1.0 - scaled[sm];
+        if (scaled[lg] < 1.0) 
+        {
+            // `lg` becomes small; reuse the slot it occupied at the large head.
+            large_head++;
+            work[--small_head] = lg;
+        }
+    }
+    // Leftovers are 1 up to rounding error.
+    for (size_t i = small_head; i < nsmall; i++) 
+    {
+        s->prob[work[i]] = 1.0f;
+        s->alias[work[i]] = work[i];
+    }
+    for (size_t i = large_head; i < tri_count; i++) 
+    {
+        s->prob[work[i]] = 1.0f;
+        s->alias[work[i]] = work[i];
+    }
+
+    free(work);
+    free(scaled);
+    s->verts = verts;
+    s->indices = indices;
+    s->tri_count = tri_count;
+    s->total_area = (float)total;
+    return true;
+}
+
+void zrand_mesh_sampler_free(zrand_mesh_sampler *s) 
+{
+    free(s->prob);
+    free(s->alias);
+    s->prob = NULL;
+    s->alias = NULL;
+    s->tri_count = 0;
+}
+
+uint32_t zrand_mesh_sampler_point(const zrand_mesh_sampler *s, zrand_rng *rng, float out[3]) 
+{
+    uint32_t slot = (uint32_t)(((uint64_t)zrand_rng_u32(rng) * s->tri_count) >> 32);
+    uint32_t tri = zrand_rng_f32(rng) < s->prob[slot] ? slot : s->alias[slot];
+    const uint32_t *idx = s->indices + 3 * (size_t)tri;
+    zrand_rng_triangle(rng, s->verts + 3 * idx[0], s->verts + 3 * idx[1], s->verts + 3 * idx[2], out);
+    return tri;
+}
+
+void zrand_mesh_sampler_batch(const zrand_mesh_sampler *s, zrand_rng *rng, 
+                              float *xs, float *ys, float *zs, uint32_t *tris, size_t n) 
+{
+    for (size_t i = 0; i < n; i++) 
+    {
+        float p[3];
+        uint32_t tri = zrand_mesh_sampler_point(s, rng, p);
+        xs[i] = p[0];
+        ys[i] = p[1];
+        zs[i] = p[2];
+        if (tris) 
+        {
+            tris[i] = tri;
+        }
+    }
+}
+
+void zrand_rng_quat(zrand_rng *rng, float q[4]) 
+{
+    float u1 = zrand_rng_f32(rng);
+    float a = zrand_rng_f32(rng) * ZRAND__TAU;
+    float b = zrand_rng_f32(rng) * ZRAND__TAU;
+    float s1 = sqrtf(1.0f - u1), s2 = sqrtf(u1);
+    q[0] = s1 * sinf(a);
+    q[1] = s1 * cosf(a);
+    q[2] = s2 * sinf(b);
+    q[3] = s2 * cosf(b);
+}
+
+void zrand_rng_quat_batch(zrand_rng *rng, float *xs, float *ys, float *zs, float *ws, size_t n) 
+{
+    for (size_t i = 0; i < n; i++) 
+    {
+        float q[4];
+        zrand_rng_quat(rng, q);
+        xs[i] = q[0];
+        ys[i] = q[1];
+        zs[i] = q[2];
+        ws[i] = q[3];
+    }
+}
+
+void zrand_rng_rotation3(zrand_rng *rng, float m[9]) 
+{
+    float q[4];
+    zrand_rng_quat(rng, q);
+    float x = q[0], y = q[1], z = q[2], w = q[3];
+    m[0] = 1.0f - 2.0f * (y * y + z * z);
+    m[1] = 2.0f * (x * y - z * w);
+    m[2] = 2.0f * (x * z + y * w);
+    m[3] = 2.0f * (x * y + z * w);
+    m[4] = 1.0f - 2.0f * (x * x + z * z);
+    m[5] = 2.0f * (y * z - x * w);
+    m[6] = 2.0f * (x * z - y * w);
+    m[7] = 2.0f * (y * z + x * w);
+    m[8] = 1.0f - 2.0f * (x * x + y * y);
+}
+
+// Fills `out[0..n-1]` with standard normals, two per polar Box-Muller step.
+static void zrand__gaussians(zrand_rng *rng, float *out, size_t n) 
+{
+    for (size_t i = 0; i < n; i += 2) 
+    {
+        float u, v, s;
+        do 
+        {
+            u = zrand_rng_f32(rng) * 2.0f - 1.0f;
+            v = zrand_rng_f32(rng) * 2.0f - 1.0f;
+            s = u * u + v * v;
+        } while (s >= 1.0f || 0.0f == s);
+        float k = sqrtf(-2.0f * logf(s) / s);
+        out[i] = u * k;
+        if (i + 1 < n) 
+        {
+            out[i + 1] = v * k;
+        }
+    }
+}
+
+void zrand_rng_unit_vector(zrand_rng *rng, float *out, size_t dim) 
+{
+    switch (dim) 
+    {
+        case 0: return;
+        case 1: out[0] = (zrand_rng_u32(rng) & 1) ? 1.0f : -1.0f; return;
+        case 2: zrand_rng_circle(rng, out); return;
+        case 3: zrand_rng_sphere(rng, out); return;
+        default: break;
+    }
+    double len2;
+    do 
+    {
+        zrand__gaussians(rng, out, dim);
+        len2 = 0.0;
+        for (size_t k = 0; k < dim; k++) 
+        {
+            len2 += (double)out[k] * out[k];
+        }
+    } while (len2 < 1e-30);
+    float inv = (float)(1.0 / sqrt(len2));
+    for (size_t k = 0; k < dim; k++) 
+    {
+        out[k] *= inv;
+    }
+}
+
+void zrand_rng_unit_vector_batch(zrand_rng *rng, float *out, size_t dim, size_t n) 
+{
+    for (size_t i = 0; i < n; i++) 
+    {
+        zrand_rng_unit_vector(rng, out + i * dim, dim);
+    }
+}
+
+void zrand_rng_orthogonal(zrand_rng *rng, float *out, size_t dim) 
+{
+    // Rows of an i.i.d. Gaussian matrix, orthonormalized in order (modified
+    // Gram-Schmidt, i.e. QR with a positive R diagonal), are Haar distributed.
+    for (size_t i = 0; i < dim; i++) 
+    {
+        float *row = out + i * dim;
+        double len2;
+        do 
+        {
+            zrand__gaussians(rng, row, dim);
+            for (size_t j = 0; j < i; j++) 
+            {
+                const float *prev = out + j * dim;
+                double d = 0.0;
+                for (size_t k = 0; k < dim; k++) 
+                {
+                    d += (double)row[k] * prev[k];
+                }
+                for (size_t k = 0; k < dim; k++) 
+                {
+                    row[k] -= (float)d * prev[k];
+                }
+            }
+            len2 = 0.0;
+            for (size_t k = 0; k < dim; k++) 
+            {
+                len2 += (double)row[k] * row[k];
+            }
+        } while (len2 < 1e-12);
+        float inv = (float)(1.0 / sqrt(len2));
+        for (size_t k = 0; k < dim; k++) 
+        {
+            row[k] *= inv;
+        }
+    }
+}
+
+void zrand_rng_orthogonal_batch(zrand_rng *rng, float *out, size_t dim, size_t count) 
+{
+    for (size_t i = 0; i < count; i++) 
+    {
+        zrand_rng_orthogonal(rng, out + i * dim * dim, dim);
+    }
+}
+
+#endif // ZRAND_SAMPLING
+
+// Stochastic paths implementation.
+
+#ifdef ZRAND_PATHS
+
+#include <math.h>
+
+#define ZRAND__PATH_BLOCK 64
+
+typedef enum { ZRAND__PATH_BM, ZRAND__PATH_GBM, ZRAND__PATH_BRIDGE } zrand__path_kind;
+
+// Gaussian increments and the path updates run without libm. log, sin/cos
+// and exp are the fdlibm kernels (about 1 ulp), written once as scalar code
+// and once for AVX2 with the same operations in the same order, so both
+// builds produce the same paths.
+
+#define ZRAND__LN2_HI 6.93147180369123816490e-01
+#define ZRAND__LN2_LO 1.90821492927058770002e-10
+#define ZRAND__ROUND_MAGIC 6755399441055744.0 // 1.5 * 2^52: adding it rounds to an integer.
+
+// log(u) for u in [2^-53, 1].
+static inline double zrand__log_unit(double u) 
+{
+    uint64_t bits;
+    memcpy(&bits, &u, sizeof(bits));
+    double k = (double)(bits >> 52) - 1023.0;
+    bits = (bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL;
+    double m;
+    memcpy(&m, &bits, sizeof(m));
+    if (m > 1.41421356237309504880) 
+    {
+        m *= 0.5;
+        k += 1.0;
+    }
+    double f = m - 1.0;
+    double s = f / (2.0 + f);
+    double z = s * s, w = z * z;
+    double t1 = w * (3.999999999940941908e-01 + w * (2.222219843214978396e-01 + w * 1.531383769920937332e-01));
+    double t2 = z * (6.666666666666735130e-01 + w * (2.857142874366239149e-01 + w * (1.818357216161805012e-01 + w * 1.479819860511658591e-01)));
+    double hfsq = 0.5 * f * f;
+    return k * ZRAND__LN2_HI - ((hfsq - (s * (hfsq + (t2 + t1)) + k * ZRAND__LN2_LO)) - f);
+}
+
+// sin(x) and cos(x) for |x| <= pi/4.
+static inline void zrand__sincos_small(double x, double *sn, double *cs) 
+{
+    double z = x * x;
+    double r = 8.33333333332248946124e-03 + z * (-1.98412698298579493134e-04 + z * (2.75573137070700676789e-06 + z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10)));
+    *sn = x + z * x * (-1.66666666666666324348e-01 + z * r);
+    double c = z * (4.16666666666666019037e-02 + z * (-1.38888888888741095749e-03 + z * (2.48015872894767294178e-05 + z * (-2.75573143513906633035e-07 + z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11)))));
+    double hz = 0.5 * z, w = 1.0 - hz;
+    *cs = w + (((1.0 - w) - hz) + z * c);
+}
+
+// exp(x), saturating outside [-708, 709] (the result stays finite and nonzero).
+static inline double zrand__exp(double x) 
+{
+    x = (x < -708.0) ? -708.0 : ((x > 709.0) ? 709.0 : x);
+    double kr = x * 1.44269504088896338700e+00 + ZRAND__ROUND_MAGIC;
+    double k = kr - ZRAND__ROUND_MAGIC;
+    double hi = x - k * ZRAND__LN2_HI, lo = k * ZRAND__LN2_LO;
+    double r = hi - lo, t = r * r;
+    double c = r - t * (1.66666666666666019037e-01 + t * (-2.77777777770155933842e-03 + t * (6.61375632143793436117e-05 + t * (-1.65339022054652515390e-06 + t * 4.13813679705723846039e-08))));
+    double y = 1.0 - ((lo - (r * c) / (2.0 - c)) - hi);
+    uint64_t bits = (uint64_t)((int64_t)k + 1023) << 52;
+    double scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return y * scale;
+}
+
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+static inline __m256d zrand__log_unit_x4(__m256d u) 
+{
+    const __m256i one_bits = _mm256_set1_epi64x(0x3FF0000000000000LL);
+    const __m256i exp_magic = _mm256_set1_epi64x(0x4330000000000000LL); // 2^52: exact int -> double.
+    __m256i bits = _mm256_castpd_si256(u);
+    __m256d k = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), exp_magic)), _mm256_set1_pd(4503599627370496.0));
+    k = _mm256_sub_pd(k, _mm256_set1_pd(1023.0));
+    __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)), one_bits));
+    __m256d big = _mm256_cmp_pd(m, _mm256_set1_pd(1.41421356237309504880), _CMP_GT_OQ);
+    m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+    k = _mm256_blendv_pd(k, _mm256_add_pd(k, _mm256_set1_pd(1.0)), big);
+    __m256d f = _mm256_sub_pd(m, _mm256_set1_pd(1.0));
+    __m256d s = _mm256_div_pd(f, _mm256_add_pd(_mm256_set1_pd(2.0), f));
+    __m256d z = _mm256_mul_pd(s, s), w = _mm256_mul_pd(z, z);
+    __m256d t1 = _mm256_add_pd(_mm256_set1_pd(2.222219843214978396e-01), _mm256_mul_pd(w, _mm256_set1_pd(1.531383769920937332e-01)));
+    t1 = _mm256_add_pd(_mm256_set1_pd(3.999999999940941908e-01), _mm256_mul_pd(w, t1));
+    t1 = _mm256_mul_pd(w, t1);
+    __m256d t2 = _mm256_add_pd(_mm256_set1_pd(1.818357216161805012e-01), _mm256_mul_pd(w, _mm256_set1_pd(1.479819860511658591e-01)));
+    t2 = _mm256_add_pd(_mm256_set1_pd(2.857142874366239149e-01), _mm256_mul_pd(w, t2));
+    t2 = _mm256_add_pd(_mm256_set1_pd(6.666666666666735130e-01), _mm256_mul_pd(w, t2));
+    t2 = _mm256_mul_pd(z, t2);
+    __m256d hfsq = _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(0.5), f), f);
+    __m256d inner = _mm256_add_pd(_mm256_mul_pd(s, _mm256_add_pd(hfsq, _mm256_add_pd(t2, t1))), _mm256_mul_pd(k, _mm256_set1_pd(ZRAND__LN2_LO)));
+    return _mm256_sub_pd(_mm256_mul_pd(k, _mm256_set1_pd(ZRAND__LN2_HI)), _mm256_sub_pd(_mm256_sub_pd(hfsq, inner), f));
+}
+
+static inline void zrand__sincos_small_x4(__m256d x, __m256d *sn, __m256d *cs) 
+{
+    __m256d z = _mm256_mul_pd(x, x);
+    __m256d r = _mm256_add_pd(_mm256_set1_pd(-2.50507602534068634195e-08), _mm256_mul_pd(z, _mm256_set1_pd(1.58969099521155010221e-10)));
+    r = _mm256_add_pd(_mm256_set1_pd(2.75573137070700676789e-06), _mm256_mul_pd(z, r));
+    r = _mm256_add_pd(_mm256_set1_pd(-1.98412698298579493134e-04), _mm256_mul_pd(z, r));
+    r = _mm256_add_pd(_mm256_set1_pd(8.33333333332248946124e-03), _mm256_mul_pd(z, r));
+    __m256d v = _mm256_add_pd(_mm256_set1_pd(-1.66666666666666324348e-01), _mm256_mul_pd(z, r));
+    *sn = _mm256_add_pd(x, _mm256_mul_pd(_mm256_mul_pd(z, x), v));
+    __m256d c = _mm256_add_pd(_mm256_set1_pd(2.08757232129817482790e-09), _mm256_mul_pd(z, _mm256_set1_pd(-1.13596475577881948265e-11)));
+    c = _mm256_add_pd(_mm256_set1_pd(-2.75573143513906633035e-07), _mm256_mul_pd(z, c));
+    c = _mm256_add_pd(_mm256_set1_pd(2.48015872894767294178e-05), _mm256_mul_pd(z, c));
+    c = _mm256_add_pd(_mm256_set1_pd(-1.38888888888741095749e-03), _mm256_mul_pd(z, c));
+    c = _mm256_add_pd(_mm256_set1_pd(4.16666666666666019037e-02), _mm256_mul_pd(z, c));
+    c = _mm256_mul_pd(z, c);
+    __m256d hz = _mm256_mul_pd(_mm256_set1_pd(0.5), z);
+    __m256d w = _mm256_sub_pd(_mm256_set1_pd(1.0), hz);
+    *cs = _mm256_add_pd(w, _mm256_add_pd(_mm256_sub_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), w), hz), _mm256_mul_pd(z, c)));
+}
+
+static inline __m256d zrand__exp_x4(__m256d x) 
+{
+    const __m256d magic = _mm256_set1_pd(ZRAND__ROUND_MAGIC);
+    x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(-708.0)), _mm256_set1_pd(709.0));
+    __m256d kr = _mm256_add_pd(_mm256_mul_pd(x, _mm256_set1_pd(1.44269504088896338700e+00)), magic);
+    __m256d k = _mm256_sub_pd(kr, magic);
+    __m256d hi = _mm256_sub_pd(x, _mm256_mul_pd(k, _mm256_set1_pd(ZRAND__LN2_HI)));
+    __m256d lo = _mm256_mul_pd(k, _mm256_set1_pd(ZRAND__LN2_LO));
+    __m256d r = _mm256_sub_pd(hi, lo), t = _mm256_mul_pd(r, r);
+    __m256d p = _mm256_add_pd(_mm256_set1_pd(-1.65339022054652515390e-06), _mm256_mul_pd(t, _mm256_set1_pd(4.13813679705723846039e-08)));
+    p = _mm256_add_pd(_mm256_set1_pd(6.61375632143793436117e-05), _mm256_mul_pd(t, p));
+    p = _mm256_add_pd(_mm256_set1_pd(-2.77777777770155933842e-03), _mm256_mul_pd(t, p));
+    p = _mm256_add_pd(_mm256_set1_pd(1.66666666666666019037e-01), _mm256_mul_pd(t, p));
+    __m256d c = _mm256_sub_pd(r, _mm256_mul_pd(t, p));
+    __m256d q = _mm256_div_pd(_mm256_mul_pd(r, c), _mm256_sub_pd(_mm256_set1_pd(2.0), c));
+    __m256d y = _mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_sub_pd(_mm256_sub_pd(lo, q), hi));
+    // The low bits of `kr` hold k; k + 1023 lands in the exponent field.
+    __m256i e = _mm256_slli_epi64(_mm256_add_epi64(_mm256_castpd_si256(kr), _mm256_set1_epi64x(1023)), 52);
+    return _mm256_mul_pd(y, _mm256_castsi256_pd(e));
+}
+#endif
+
+// zrand__pcg32_run() writes the next `n` outputs of `rng`'s own stream, as
+// `n` calls of zrand__pcg32() would, and advances `rng` past them. With SIMD,
+// lane j of eight leapfrogged copies of the stream produces outputs j, j + 8,
+// ..., so the multiply chains do not wait on each other. Scalar builds step
+// the stream in order, which is faster than emulating the lanes.
+static void zrand__pcg32_run(zrand_rng *rng, uint32_t *out, size_t n) 
+{
+    size_t i = 0;
+#if defined(ZRAND__AVX512) || defined(ZRAND__AVX2)
+    if (n >= 16) 
+    {
+        uint64_t st[8], mult, plus;
+        uint64_t inc = rng->inc | 1;
+        st[0] = rng->state;
+        for (int j = 1; j < 8; j++) 
+        {
+            st[j] = st[j - 1] * 6364136223846793005ULL + inc;
+        }
+        zrand__lcg_jump(8, 6364136223846793005ULL, inc, &mult, &plus);
+        ZRAND__STAT(ZRAND__STAT_STEPS, n - n % 8);
+#if defined(ZRAND__AVX512)
+        __m512i s = _mm512_loadu_si512((const void*)st);
+        const __m512i m = _mm512_set1_epi64((long long)mult);
+        const __m512i c = _mm512_set1_epi64((long long)plus);
+        for (; i + 8 <= n; i += 8) 
+        {
+            _mm256_storeu_si256((__m256i*)(out + i), zrand__pcg32_x8_mul(&s, m, c));
+        }
+        _mm512_storeu_si512((void*)st, s);
+#else
+        __m256i s0 = _mm256_loadu_si256((const __m256i*)st);
+        __m256i s1 = _mm256_loadu_si256((const __m256i*)(st + 4));
+        const __m256i m_lo = _mm256_set1_epi64x((long long)(mult & 0xFFFFFFFFu));
+        const __m256i m_hi = _mm256_set1_epi64x((long long)(mult >> 32));
+        const __m256i c = _mm256_set1_epi64x((long long)plus);
+        for (; i + 8 <= n; i += 8) 
+        {
+            _mm_storeu_si128((__m128i*)(out + i), zrand__pcg32_x4_mul(&s0, m_lo, m_hi, c));
+            _mm_storeu_si128((__m128i*)(out + i + 4), zrand__pcg32_x4_mul(&s1, m_lo, m_hi, c));
+        }
+        _mm256_storeu_si256((__m256i*)st, s0);
+#endif
+        rng->state = st[0];
+    }
+#endif
+    for (; i < n; i++) 
+    {
+        out[i] = zrand__pcg32(rng);
+    }
+}
+
+// The next `n` values of zrand_rng_u64(rng), `n` at most ZRAND__PATH_BLOCK.
+static void zrand__paths_u64(zrand_rng *rng, uint64_t *out, size_t n) 
+{
+#ifdef ZRAND_TRACE
+    // A trace session logs or replays every draw, so take them one by one.
+    if (ZRAND__TRACE_OFF != zrand__trace_mode) 
+    {
+        for (size_t i = 0; i < n; i++) 
+        {
+            out[i] = zrand_rng_u64(rng);
+        }
+        return;
+    }
+#endif
+    uint32_t w[2 * ZRAND__PATH_BLOCK];
+    zrand__pcg32_run(rng, w, 2 * n);
+    for (size_t i = 0; i < n; i++) 
+    {
+        out[i] = ((uint64_t)w[2 * i] << 32) | w[2 * i + 1];
+    }
+}
+
+// Standard normals without rejection, so the draw count per batch is fixed.
+// Box-Muller: u in (0, 1] and the angle 2 pi t are drawn in order as before;
+// t is split into a quadrant q and a remainder in [-1/8, 1/8] (exact in
+// integers) so sin/cos only see |x| <= pi/4. `n` is at most ZRAND__PATH_BLOCK.
+static void zrand__normals(zrand_rng *rng, double *out, size_t n) 
+{
+    enum { PAIRS = ZRAND__PATH_BLOCK / 2 };
+    size_t pairs = (n + 1) / 2;
+    double u[PAIRS], x[PAIRS], z[2 * PAIRS];
+    ZRAND_ALIGNED(32) int64_t q[PAIRS];
+    uint64_t d[2 * PAIRS];
+    zrand__paths_u64(rng, d, 2 * pairs);
+    for (size_t i = 0; i < pairs; i++) 
+    {
+        u[i] = ((double)(d[2 * i] >> 11) + 1.0) * (1.0 / 9007199254740992.0);
+        uint64_t t = d[2 * i + 1] >> 11;
+        uint64_t quad = (t + (1ULL << 50)) >> 51;
+        x[i] = (double)((int64_t)t - (int64_t)(quad << 51)) * (6.28318530717958647692 / 9007199254740992.0);
+        q[i] = (int64_t)(quad & 3);
+    }
+    size_t i = 0;
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+    for (; i + 4 <= pairs; i += 4) 
+    {
+        __m256d r = _mm256_sqrt_pd(_mm256_mul_pd(_mm256_set1_pd(-2.0), zrand__log_unit_x4(_mm256_loadu_pd(u + i))));
+        __m256d sn, cs;
+        zrand__sincos_small_x4(_mm256_loadu_pd(x + i), &sn, &cs);
+        // Rotate by q quarter turns: q odd swaps sin and cos, bit 1 of q + 1
+        // (resp. q) negates the cosine (resp. sine).
+        __m256i vq = _mm256_load_si256((const __m256i*)(q + i));
+        __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(vq, _mm256_set1_epi64x(1)), _mm256_set1_epi64x(1)));
+        __m256d neg_c = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(_mm256_add_epi64(vq, _mm256_set1_epi64x(1)), _mm256_set1_epi64x(2)), 62));
+        __m256d neg_s = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(vq, _mm256_set1_epi64x(2)), 62));
+        __m256d c = _mm256_mul_pd(r, _mm256_xor_pd(_mm256_blendv_pd(cs, sn, swap), neg_c));
+        __m256d s = _mm256_mul_pd(r, _mm256_xor_pd(_mm256_blendv_pd(sn, cs, swap), neg_s));
+        __m256d lo = _mm256_unpacklo_pd(c, s), hi = _mm256_unpackhi_pd(c, s);
+        _mm256_storeu_pd(z + 2 * i, _mm256_permute2f128_pd(lo, hi, 0x20));
+        _mm256_storeu_pd(z + 2 * i + 4, _mm256_permute2f128_pd(lo, hi, 0x31));
+    }
+#endif
+    for (; i < pairs; i++) 
+    {
+        double r = sqrt(-2.0 * zrand__log_unit(u[i]));
+        double sn, cs;
+        zrand__sincos_small(x[i], &sn, &cs);
+        double c = (q[i] & 1) ? sn : cs, s = (q[i] & 1) ? cs : sn;
+        z[2 * i] = r * (((q[i] + 1) & 2) ? -c : c);
+        z[2 * i + 1] = r * ((q[i] & 2) ? -s : s);
+    }
+    memcpy(out, z, n * sizeof(double));
+}
+
+static void zrand__paths(zrand_rng *rng, size_t npaths, size_t nsteps, double dt, zrand__path_kind kind, 
+                         double x0, double x1, double drift, double sigma, 
+                         const zrand_path_opts *opts, double *out) 
+{
+    bool anti = opts && opts->antithetic;
+    bool time_major = opts && ZRAND_TIME_MAJOR == opts->layout;
+    size_t stride = nsteps + 1;
+    double x[ZRAND__PATH_BLOCK], z[ZRAND__PATH_BLOCK];
+    double sdt = sqrt(dt);
+
+    for (size_t p0 = 0; p0 < npaths; p0 += ZRAND__PATH_BLOCK) 
+    {
+        size_t bn = npaths - p0 < ZRAND__PATH_BLOCK ? npaths - p0 : ZRAND__PATH_BLOCK;
+        for (size_t j = 0; j < bn; j++) 
+        {
+            x[j] = x0;
+        }
+        for (size_t k = 0; k <= nsteps; k++) 
+        {
+            if (k > 0) 
+            {
+                if (anti) 
+                {
+                    size_t pairs = bn / 2;
+                    zrand__normals(rng, z, pairs + (bn & 1));
+                    // Spread pairs out back to front so z[i] is read before it is overwritten.
+                    if (bn & 1) 
+                    {
+                        z[bn - 1] = z[pairs];
+                    }
+                    for (size_t i = pairs; i-- > 0;) 
+                    {
+                        z[2 * i] = z[i];
+                        z[2 * i + 1] = -z[i];
+                    }
+                }
+                else 
+                {
+                    zrand__normals(rng, z, bn);
+                }
+
+                if (ZRAND__PATH_BM == kind) 
+                {
+                    double m = drift * dt, s = sigma * sdt;
+                    size_t j = 0;
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+                    for (; j + 4 <= bn; j += 4) 
+                    {
+                        __m256d inc = _mm256_add_pd(_mm256_set1_pd(m), _mm256_mul_pd(_mm256_set1_pd(s), _mm256_loadu_pd(z + j)));
+                        _mm256_storeu_pd(x + j, _mm256_add_pd(_mm256_loadu_pd(x + j), inc));
+                    }
+#endif
+                    for (; j < bn; j++) 
+                    {
+                        x[j] += m + s * z[j];
+                    }
+                }
+                else if (ZRAND__PATH_GBM == kind) 
+                {
+                    double m = (drift - 0.5 * sigma * sigma) * dt, s = sigma * sdt;
+                    size_t j = 0;
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+                    for (; j + 4 <= bn; j += 4) 
+                    {
+                        __m256d e = zrand__exp_x4(_mm256_add_pd(_mm256_set1_pd(m), _mm256_mul_pd(_mm256_set1_pd(s), _mm256_loadu_pd(z + j))));
+                        _mm256_storeu_pd(x + j, _mm256_mul_pd(_mm256_loadu_pd(x + j), e));
+                    }
+#endif
+                    for (; j < bn; j++) 
+                    {
+                        x[j] *= zrand__exp(m + s * z[j]);
+                    }
+                }
+                else 
+                {
+                    // From t_k, (nsteps - k + 1) steps remain to the pinned endpoint.
+                    double left = (double)(nsteps - k + 1);
+                    double s = sigma * sdt * sqrt((left - 1.0) / left);
+                    size_t j = 0;
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+                    for (; j + 4 <= bn; j += 4) 
+                    {
+                        __m256d xj = _mm256_loadu_pd(x + j);
+                        __m256d pull = _mm256_div_pd(_mm256_sub_pd(_mm256_set1_pd(x1), xj), _mm256_set1_pd(left));
+                        __m256d inc = _mm256_add_pd(pull, _mm256_mul_pd(_mm256_set1_pd(s), _mm256_loadu_pd(z + j)));
+                        _mm256_storeu_pd(x + j, _mm256_add_pd(xj, inc));
+                    }
+#endif
+                    for (; j < bn; j++) 
+                    {
+                        x[j] += (x1 - x[j]) / left + s * z[j];
+                    }
+                }
+            }
+
+            if (time_major) 
+            {
+                memcpy(out + k * npaths + p0, x, bn * sizeof(double));
+            }
+            else 
+            {
+                for (size_t j = 0; j < bn; j++) 
+                {
+                    out[(p0 + j) * stride + k] = x[j];
+                }
+            }
+        }
+    }
+}
+
+void zrand_rng_brownian_paths(zrand_rng *rng, size_t npaths, size_t nsteps, double dt, double *out) 
+{
+    zrand__paths(rng, npaths, nsteps, dt, ZRAND__PATH_BM, 0.0, 0.0, 0.0, 1.0, NULL, out);
+}
+
+void zrand_rng_brownian_paths_ex(zrand_rng *rng, size_t npaths, size_t nsteps, double dt, 
+                                 double x0, double mu, double sigma, const zrand_path_opts *opts, double *out) 
+{
+    zrand__paths(rng, npaths, nsteps, dt, ZRAND__PATH_BM, x0, 0.0, mu, sigma, opts, out);
+}
+
+void zrand_rng_gbm_paths(zrand_rng *rng, size_t npaths, size_t nsteps, double dt, 
+                         double s0, double mu, double sigma, const zrand_path_opts *opts, double *out) 
+{
+    zrand__paths(rng, npaths, nsteps, dt, ZRAND__PATH_GBM, s0, 0.0, mu, sigma, opts, out);
+}
+
+void zrand_rng_brownian_bridge(zrand_rng *rng, size_t npaths, size_t nsteps, double dt, 
+                               double a, double b, double sigma, const zrand_path_opts *opts, double *out) 
+{
+    zrand__paths(rng, npaths, nsteps, dt, ZRAND__PATH_BRIDGE, a, b, 0.0, sigma, opts, out);
+}
+
+#endif // ZRAND_PATHS
+
+// Token sampling implementation.
+
+#ifdef ZRAND_LOGITS
+
+#include <math.h>
+
+typedef struct 
+{
+    float value;   // The logit, then its unnormalized softmax weight.
+    size_t index;
+} zrand__token;
+
+#define ZRAND__TOKENS_STACK 256 // Candidates kept on the stack before falling back to malloc.
+#define ZRAND__WALK_BLOCK 256   // Logits per block the walk skips by its stored sum.
+#define ZRAND__SUMS_STACK 1024  // Block sums on the stack: vocabularies up to 262144.
+#define ZRAND__NUCLEUS_BUCKETS 512 // Histogram resolution for the top-p cutoff.
+
+// exp(x) for x <= 0: x log2(e) = k + f with |f| <= 1/2, 2^f by the Cephes exp2f
+// polynomial, 2^k through the exponent bits. Relative error stays below 4e-6
+// (mostly from rounding x log2(e)); below -87.3, including -INFINITY, it is 0.
+static inline float zrand__expf_neg(float x) 
+{
+    float t = x * 1.44269504088896341f;
+    t = (t < -126.0f) ? -126.0f : t;
+    float k = (t + 12582912.0f) - 12582912.0f; // Round to nearest even.
+    float f = t - k;
+    float p = 1.535336188319500e-4f;
+    p = p * f + 1.339887440266574e-3f;
+    p = p * f + 9.618437357674640e-3f;
+    p = p * f + 5.550332471162809e-2f;
+    p = p * f + 2.402264791363012e-1f;
+    p = p * f + 6.931472028550421e-1f;
+    p = p * f + 1.0f;
+    int32_t bits = ((int32_t)k + 127) * (1 << 23);
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return (x < -87.33654f) ? 0.0f : p * scale;
+}
+
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+// Same operations as zrand__expf_neg, eight lanes at a time.
+static inline __m256 zrand__expf_neg_x8(__m256 x) 
+{
+    __m256 t = _mm256_max_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)), _mm256_set1_ps(-126.0f));
+    __m256 k = _mm256_round_ps(t, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 f = _mm256_sub_ps(t, k);
+    __m256 p = _mm256_set1_ps(1.535336188319500e-4f);
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(1.339887440266574e-3f));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(9.618437357674640e-3f));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(5.550332471162809e-2f));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(2.402264791363012e-1f));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(6.931472028550421e-1f));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(1.0f));
+    __m256i bits = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(k), _mm256_set1_epi32(127)), 23);
+    __m256 keep = _mm256_cmp_ps(x, _mm256_set1_ps(-87.33654f), _CMP_GE_OQ);
+    return _mm256_and_ps(_mm256_mul_ps(p, _mm256_castsi256_ps(bits)), keep);
+}
+#endif
+
+// Largest logit; `*arg` receives its first index.
+static float zrand__logits_max(const float *l, size_t n, size_t *arg) 
+{
+    float m = l[0];
+    size_t i = 0;
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+    if (n >= 8) 
+    {
+        __m256 vm = _mm256_loadu_ps(l);
+        for (i = 8; i + 8 <= n; i += 8) 
+        {
+            vm = _mm256_max_ps(vm, _mm256_loadu_ps(l + i));
+        }
+        float lanes[8];
+        _mm256_storeu_ps(lanes, vm);
+        for (int j = 0; j < 8; j++) 
+        {
+            m = (lanes[j] > m) ? lanes[j] : m;
+        }
+    }
+#else
+    // Independent lanes, so consecutive compares do not wait on each other.
+    float lanes[8] = { l[0], l[0], l[0], l[0], l[0], l[0], l[0], l[0] };
+    for (; i + 8 <= n; i += 8) 
+    {
+        for (int j = 0; j < 8; j++) 
+        {
+            lanes[j] = (l[i + j] > lanes[j]) ? l[i + j] : lanes[j];
+        }
+    }
+    for (int j = 0; j < 8; j++) 
+    {
+        m = (lanes[j] > m) ? lanes[j] : m;
+    }
+#endif
+    for (; i < n; i++) 
+    {
+        m = (l[i] > m) ? l[i] : m;
+    }
+    size_t a = 0;
+    while (l[a] != m) 
+    {
+        a++;
+    }
+    *arg = a;
+    return m;
+}
+
+// Sum of exp((l[i] - m) * inv_t) over [0, n) in eight float lanes; both
+// versions add in the same order.
+static double zrand__logits_expsum(const float *l, size_t n, float m, float inv_t) 
+{
+    float lanes[8];
+    size_t i = 0;
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+    const __m256 vm = _mm256_set1_ps(m);
+    const __m256 vt = _mm256_set1_ps(inv_t);
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) 
+    {
+        __m256 x = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(l + i), vm), vt);
+        acc = _mm256_add_ps(acc, zrand__expf_neg_x8(x));
+    }
+    _mm256_storeu_ps(lanes, acc);
+#else
+    memset(lanes, 0, sizeof(lanes));
+    for (; i + 8 <= n; i += 8) 
+    {
+        for (int j = 0; j < 8; j++) 
+        {
+            lanes[j] += zrand__expf_neg((l[i + j] - m) * inv_t);
+        }
+    }
+#endif
+    double total = 0.0;
+    for (int j = 0; j < 8; j++) 
+    {
+        total += lanes[j];
+    }
+    for (; i < n; i++) 
+    {
+        total += zrand__expf_neg((l[i] - m) * inv_t);
+    }
+    return total;
+}
+
+// First index in [i, n) whose logit is at least `cut` (`n` if none). Blocks of
+// eight below the cutoff are skipped with one compare when AVX2 is available.
+static inline size_t zrand__logits_find(const float *l, size_t i, size_t n, float cut) 
+{
+#if defined(__AVX2__) && !defined(ZRAND_NO_SIMD)
+    const __m256 vc = _mm256_set1_ps(cut);
+    for (; i + 8 <= n; i += 8) 
+    {
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(l + i), vc, _CMP_GE_OQ));
+        if (mask) 
+        {
+            break;
+        }
+    }
+#endif
+    while (i < n && !(l[i] >= cut)) 
+    {
+        i++;
+    }
+    return i;
+}
+
+// Index where the running weight first exceeds `target`: whole blocks are
+// skipped by their sums, then one block is rescanned. If rounding leaves the
+// target unmet, returns the last positive weight seen (or `fallback`).
+static size_t zrand__logits_walk(const float *l, size_t n, float m, float inv_t, const double *sums, double target, size_t fallback) 
+{
+    size_t nblocks = (n + ZRAND__WALK_BLOCK - 1) / ZRAND__WALK_BLOCK;
+    size_t b = 0;
+    double acc = 0.0;
+    while (b + 1 < nblocks && acc + sums[b] <= target) 
+    {
+        acc += sums[b++];
+    }
+    size_t end = (n - b * ZRAND__WALK_BLOCK > ZRAND__WALK_BLOCK) ? (b + 1) * ZRAND__WALK_BLOCK : n;
+    for (size_t i = b * ZRAND__WALK_BLOCK; i < end; i++) 
+    {
+        float w = zrand__expf_neg((l[i] - m) * inv_t);
+        if (w > 0.0f) 
+        {
+            fallback = i;
+            acc += w;
+            if (acc > target) 
+            {
+                return i;
+            }
+        }
+    }
+    return fallback;
+}
+
+// Sampling order of candidates: higher weight first, then lower index.
+static inline bool zrand__token_before(const zrand__token *a, const zrand__token *b) 
+{
+    return a->value > b->value || (a->value == b->value && a->index < b->index);
+}
+
+static inline void zrand__token_swap(zrand__token *a, zrand__token *b) 
+{
+    zrand__token t = *a;
+    *a = *b;
+    *b = t;
+}
+
+static void zrand__token_sift(zrand__token *h, size_t k, size_t i) 
+{
+    for (;;) 
+    {
+        size_t c = 2 * i + 1;
+        if (c >= k) 
+        {
+            return;
+        }
+        c += (c + 1 < k && h[c + 1].value < h[c].value);
+        if (h[i].value <= h[c].value) 
+        {
+            return;
+        }
+        zrand__token_swap(&h[i], &h[c]);
+        i = c;
+    }
+}
+
+// The `k` highest logits via a min-heap whose root is the current cutoff.
+// Later equal logits do not displace earlier ones.
+static void zrand__logits_top_k(const float *l, size_t n, size_t k, zrand__token *h) 
+{
+    for (size_t i = 0; i < k; i++) 
+    {
+        h[i].value = l[i];
+        h[i].index = i;
+    }
+    for (size_t i = k / 2; i-- > 0; ) 
+    {
+        zrand__token_sift(h, k, i);
+    }
+    for (size_t i = k; i < n; i++) 
+    {
+        if (l[i] > h[0].value) 
+        {
+            h[0].value = l[i];
+            h[0].index = i;
+            zrand__token_sift(h, k, 0);
+        }
+    }
+}
+
+// Weighted quickselect: moves the nucleus (the shortest prefix, in sampling
+// order, whose weight reaches `goal`) to the front of c[0..cnt) and returns
+// its size, with its weight in `*mass`. Expected O(cnt); no full sort.
+static size_t zrand__logits_nucleus(zrand__token *c, size_t cnt, double goal, double *mass) 
+{
+    size_t lo = 0, hi = cnt; // c[0..lo) is in the nucleus, c[hi..cnt) is not.
+    double acc = 0.0;
+    while (lo < hi) 
+    {
+        // Median of three as the pivot, parked at `lo`.
+        size_t a = lo, b = lo + (hi - lo) / 2, z = hi - 1;
+        if (zrand__token_before(&c[b], &c[a])) 
+        {
+            size_t t = a;
+            a = b;
+            b = t;
+        }
+        size_t med = zrand__token_before(&c[z], &c[a]) ? a : (zrand__token_before(&c[z], &c[b]) ? z : b);
+        zrand__token_swap(&c[lo], &c[med]);
+
+        size_t store = lo + 1;
+        double above = 0.0;
+        for (size_t j = lo + 1; j < hi; j++) 
+        {
+            if (zrand__token_before(&c[j], &c[lo])) 
+            {
+                above += c[j].value;
+                zrand__token_swap(&c[j], &c[store++]);
+            }
+        }
+        size_t mid = store - 1;
+        zrand__token_swap(&c[lo], &c[mid]);
+        if (acc + above >= goal) 
+        {
+            hi = mid;
+        }
+        else 
+        {
+            acc += above + c[mid].value;
+            lo = mid + 1;
+            hi = (acc >= goal) ? lo : hi;
+        }
+    }
+    *mass = acc;
+    return lo;
+}
+
+// Converts candidate logits to weights, applies top-p against `norm` (0: the
+// candidates' own mass) and draws one of the survivors with `u`.
+static size_t zrand__logits_pick(zrand__token *c, size_t cnt, float m, float inv_t, float top_p, double norm, double u) 
+{
+    double mass = 0.0;
+    for (size_t j = 0; j < cnt; j++) 
+    {
+        c[j].value = zrand__expf_neg((c[j].value - m) * inv_t);
+        mass += c[j].value;
+    }
+    if (top_p < 1.0f) 
+    {
+        cnt = zrand__logits_nucleus(c, cnt, top_p * ((norm > 0.0) ? norm : mass), &mass);
+    }
+    double target = u * mass, acc = 0.0;
+    size_t last = 0;
+    for (size_t j = 0; j < cnt; j++) 
+    {
+        acc += c[j].value;
+        last = (c[j].value > 0.0f) ? j : last;
+        if (c[j].value > 0.0f && acc > target) 
+        {
+            return c[j].index;
+        }
+    }
+    return c[last].index;
+}
+
+size_t zrand_sample_logits(zrand_rng *rng, const float *logits, size_t n, float temperature, size_t top_k, float top_p) 
+{
+    size_t arg;
+    float m = zrand__logits_max(logits, n, &arg);
+    if (temperature <= 0.0f || 1 == n) 
+    {
+        return arg;
+    }
+    double u = zrand_rng_f64(rng);
+    float inv_t = 1.0f / temperature;
+    bool nucleus = top_p > 0.0f && top_p < 1.0f;
+    zrand__token stack[ZRAND__TOKENS_STACK];
+    size_t pick = arg;
+
+    if (top_k > 0 && top_k < n) 
+    {
+        zrand__token *c = (top_k <= ZRAND__TOKENS_STACK) ? stack : (zrand__token*)malloc(top_k * sizeof(zrand__token));
+        if (c) 
+        {
+            zrand__logits_top_k(logits, n, top_k, c);
+            pick = zrand__logits_pick(c, top_k, m, inv_t, nucleus ? top_p : 1.0f, 0.0, u);
+        }
+        if (c != stack) 
+        {
+            free(c);
+        }
+        return pick;
+    }
+
+    if (!nucleus) 
+    {
+        double stack_sums[ZRAND__SUMS_STACK];
+        size_t nblocks = (n + ZRAND__WALK_BLOCK - 1) / ZRAND__WALK_BLOCK;
+        double *sums = (nblocks <= ZRAND__SUMS_STACK) ? stack_sums : (double*)malloc(nblocks * sizeof(double));
+        if (sums) 
+        {
+            double total = 0.0;
+            for (size_t b = 0; b < nblocks; b++) 
+            {
+                size_t len = (b + 1 < nblocks) ? ZRAND__WALK_BLOCK : n - b * ZRAND__WALK_BLOCK;
+                sums[b] = zrand__logits_expsum(logits + b * ZRAND__WALK_BLOCK, len, m, inv_t);
+                total += sums[b];
+            }
+            pick = zrand__logits_walk(logits, n, m, inv_t, sums, u * total, arg);
+        }
+        if (sums != stack_sums) 
+        {
+            free(sums);
+        }
+        return pick;
+    }
+
+    // No nucleus member is below (1 - top_p) / (n - 1) of the mass; the
+    // cutoff is moved into logit space and loosened to absorb exp error.
+    double total = zrand__logits_expsum(logits, n, m, inv_t);
+    double goal = top_p * total;
+    float cut = m + (float)(log(total * (1.0 - top_p) / (double)(n - 1) * 0.999) / inv_t);
+    // The bound exceeds the argmax when the nucleus is the argmax alone.
+    cut = (cut < m) ? cut : m;
+
+    // Raise it with a histogram of the survivors over [cut, m]: every weight
+    // in a bucket is at least that of its lower edge, so the first edge whose
+    // lower-bound mass reaches the goal still keeps the whole nucleus.
+    uint32_t hist[ZRAND__NUCLEUS_BUCKETS] = { 0 };
+    float width = (m - cut) / ZRAND__NUCLEUS_BUCKETS;
+    float inv_width = (width > 0.0f) ? 1.0f / width : 0.0f;
+    size_t cap = 0;
+    for (size_t i = zrand__logits_find(logits, 0, n, cut); i < n; i = zrand__logits_find(logits, i + 1, n, cut)) 
+    {
+        size_t b = (size_t)((m - logits[i]) * inv_width);
+        hist[(b < ZRAND__NUCLEUS_BUCKETS) ? b : ZRAND__NUCLEUS_BUCKETS - 1]++;
+        cap++;
+    }
+    double low = 0.0;
+    size_t kept = 0;
+    for (size_t b = 0; width > 0.0f && b < ZRAND__NUCLEUS_BUCKETS; b++) 
+    {
+        float edge = m - (float)(b + 1) * width;
+        low += hist[b] * (double)zrand__expf_neg((edge - m) * inv_t) * 0.999;
+        kept += hist[b];
+        if (low >= goal) 
+        {
+            // Rounding may bin a logit equal to `edge` one bucket lower.
+            cut = (edge > cut) ? edge : cut;
+            cap = kept + ((b + 1 < ZRAND__NUCLEUS_BUCKETS) ? hist[b + 1] : 0);
+            break;
+        }
+    }
+    zrand__token *c = (cap <= ZRAND__TOKENS_STACK) ? stack : (zrand__token*)malloc(cap * sizeof(zrand__token));
+    if (c) 
+    {
+        size_t cnt = 0;
+        for (size_t i = zrand__logits_find(logits, 0, n, cut); i < n && cnt < cap; i = zrand__logits_find(logits, i + 1, n, cut)) 
+        {
+            c[cnt].value = logits[i];
+            c[cnt++].index = i;
+        }
+        pick = zrand__logits_pick(c, cnt, m, inv_t, top_p, total, u);
+    }
+    if (c != stack) 
+    {
+        free(c);
+    }
+    return pick;
+}
+
+#endif // ZRAND_LOGITS
+
+// Recorded streams.
+
+#ifdef ZRAND_MMAP_STREAM
+
+#include <stdio.h>
+
+#if defined(_WIN32)
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   if defined(MADV_SEQUENTIAL)
+#       define ZRAND__MADV_SEQUENTIAL MADV_SEQUENTIAL
+#       define ZRAND__MADV_WILLNEED MADV_WILLNEED
+#       ifdef MADV_HUGEPAGE
+#           define ZRAND__MADV_HUGEPAGE MADV_HUGEPAGE
+#       endif
+#   elif defined(__linux__)
+        // madvise() is hidden in strict ISO C modes; the Linux advice values are ABI.
+        int madvise(void *addr, size_t len, int advice);
+#       define ZRAND__MADV_SEQUENTIAL 2
+#       define ZRAND__MADV_WILLNEED 3
+#       define ZRAND__MADV_HUGEPAGE 14
+#   endif
+#endif
+
+// 64-byte header; the values that follow stay cache-line aligned in the mapping.
+typedef struct 
+{
+    char magic[8];      // "ZRSTRM01".
+    uint32_t version;   // 1; a byte-swapped file fails this check.
+    uint32_t engine;
+    uint64_t seed;
+    uint64_t count;
+    uint64_t offset;    // Byte offset of value 0.
+    uint8_t reserved[24];
+} zrand__mmap_header;
+
+#define ZRAND__MMAP_BLOCK 8192 // Values generated per write.
+
+bool zrand_mmap_stream_write(const char *path, zrand_mmap_engine engine, uint64_t seed, uint64_t count) 
+{
+    if (0 == count || (ZRAND_MMAP_PCG != engine && ZRAND_MMAP_OS != engine)) 
+    {
+        return false;
+    }
+    uint64_t *block = (uint64_t*)malloc(ZRAND__MMAP_BLOCK * sizeof(uint64_t));
+    FILE *f = block ? fopen(path, "wb") : NULL;
+    if (!f) 
+    {
+        free(block);
+        return false;
+    }
+    zrand__mmap_header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, "ZRSTRM01", 8);
+    hdr.version = 1;
+    hdr.engine = (uint32_t)engine;
+    hdr.seed = seed;
+    hdr.count = count;
+    hdr.offset = sizeof(hdr);
+    bool ok = 1 == fwrite(&hdr, sizeof(hdr), 1, f);
+
+    zrand_rng rng;
+    zrand_rng_init(&rng, seed, 0);
+    for (uint64_t left = count; ok && left > 0; ) 
+    {
+        size_t n = (left < ZRAND__MMAP_BLOCK) ? (size_t)left : ZRAND__MMAP_BLOCK;
+        if (ZRAND_MMAP_PCG == engine) 
+        {
+            for (size_t i = 0; i < n; i++) 
+            {
+                block[i] = zrand_rng_u64(&rng);
+            }
+        }
+        else 
+        {
+            zrand__os_fill(block, n * sizeof(uint64_t));
+        }
+        ok = n == fwrite(block, sizeof(uint64_t), n, f);
+        left -= n;
+    }
+    ok = (0 == fclose(f)) && ok;
+    free(block);
+    if (!ok) 
+    {
+        remove(path);
+    }
+    return ok;
+}
+
+bool zrand_mmap_stream_open(zrand_mmap_stream *s, const char *path, bool preload) 
+{
+    memset(s, 0, sizeof(*s));
+    void *map = NULL;
+    size_t size = 0;
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (INVALID_HANDLE_VALUE == file) 
+    {
+        return false;
+    }
+    LARGE_INTEGER len;
+    if (GetFileSizeEx(file, &len) && (uint64_t)len.QuadPart >= sizeof(zrand__mmap_header) && (uint64_t)len.QuadPart <= (SIZE_MAX >> 1)) 
+    {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) 
+        {
+            // The view keeps the mapping alive after both handles are closed.
+            map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+        size = (size_t)len.QuadPart;
+    }
+    CloseHandle(file);
+    if (!map) 
+    {
+        return false;
+    }
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) 
+    {
+        return false;
+    }
+    struct stat st;
+    if (0 == fstat(fd, &st) && st.st_size >= (off_t)sizeof(zrand__mmap_header) && (uint64_t)st.st_size <= (SIZE_MAX >> 1)) 
+    {
+        int flags = MAP_PRIVATE;
+#   ifdef MAP_POPULATE
+        flags |= preload ? MAP_POPULATE : 0;
+#   endif
+        size = (size_t)st.st_size;
+        map = mmap(NULL, size, PROT_READ, flags, fd, 0);
+        map = (MAP_FAILED == map) ? NULL : map;
+    }
+    close(fd);
+    if (!map) 
+    {
+        return false;
+    }
+#endif
+    s->map = map;
+    s->map_size = size;
+
+    zrand__mmap_header hdr;
+    memcpy(&hdr, map, sizeof(hdr));
+    if (0 != memcmp(hdr.magic, "ZRSTRM01", 8) || 1 != hdr.version || 0 == hdr.count ||
+        hdr.offset < sizeof(hdr) || hdr.offset > size || 0 != hdr.offset % sizeof(uint64_t) ||
+        hdr.count > (size - hdr.offset) / sizeof(uint64_t)) 
+    {
+        zrand_mmap_stream_close(s);
+        return false;
+    }
+    s->data = (const uint64_t*)((const uint8_t*)map + hdr.offset);
+    s->count = hdr.count;
+    s->seed = hdr.seed;
+    s->engine = hdr.engine;
+
+#ifdef ZRAND__MADV_SEQUENTIAL
+    // Advice is best effort: a filesystem without huge page support ignores it.
+    madvise(map, size, ZRAND__MADV_SEQUENTIAL);
+#   ifdef ZRAND__MADV_HUGEPAGE
+    madvise(map, size, ZRAND__MADV_HUGEPAGE);
+#   endif
+    if (preload) 
+    {
+        madvise(map, size, ZRAND__MADV_WILLNEED);
+    }
+#endif
+    if (preload) 
+    {
+        // Touch one byte per page so the mapping is resident before timing starts.
+        volatile uint8_t sink = 0;
+        for (size_t off = 0; off < size; off += 4096) 
+        {
+            sink ^= ((const volatile uint8_t*)map)[off];
+        }
+        (void)sink;
+    }
+    return true;
+}
+
+void zrand_mmap_stream_close(zrand_mmap_stream *s) 
+{
+    if (s->map) 
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(s->map);
+#else
+        munmap(s->map, s->map_size);
+#endif
+    }
+    memset(s, 0, sizeof(*s));
+}
+
+void zrand_mmap_stream_seek(zrand_mmap_stream *s, uint64_t index) 
+{
+    s->pos = index % s->count;
+}
+
+void zrand_mmap_stream_fill_u64(zrand_mmap_stream *s, uint64_t *out, size_t n) 
+{
+    while (n > 0) 
+    {
+        if (s->pos == s->count) 
+        {
+            s->pos = 0;
+            s->wraps++;
+        }
+        uint64_t avail = s->count - s->pos;
+        size_t k = (avail < n) ? (size_t)avail : n;
+        memcpy(out, s->data + s->pos, k * sizeof(uint64_t));
+        s->pos += k;
+        out += k;
+        n -= k;
+    }
+}
+
+#endif // ZRAND_MMAP_STREAM
+
+// Threading and atomics (only for the opt-in concurrent modules).
+
+#if defined(ZRAND_PRODUCER) || defined(ZRAND_PARALLEL) || defined(ZRAND_SHARED)
+#   define ZRAND__THREADING
+#endif
+
+#ifdef ZRAND__THREADING
+
+#if defined(_WIN32)
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   include <windows.h>
+    typedef HANDLE zrand__thread;
+
+    typedef struct
+    {
+        void *(*fn)(void*);
+        void *arg;
+    } zrand__thread_start;
+
+    static DWORD WINAPI zrand__thread_tramp(LPVOID p) 
+    {
+        zrand__thread_start st = *(zrand__thread_start*)p;
+        free(p);
+        st.fn(st.arg);
+        return 0;
+    }
+
+    static inline bool zrand__thread_create(zrand__thread *t, void *(*fn)(void*), void *arg) 
+    {
+        zrand__thread_start *st = (zrand__thread_start*)malloc(sizeof(*st));
+        if (!st) 
+        {
+            return false;
+        }
+        st->fn = fn;
+        st->arg = arg;
+        *t = CreateThread(NULL, 0, zrand__thread_tramp, st, 0, NULL);
+        if (NULL == *t) 
+        {
+            free(st);
+            return false;
+        }
+        return true;
+    }
+
+    static inline void zrand__thread_join(zrand__thread t) 
+    {
+        WaitForSingleObject(t, INFINITE);
+        CloseHandle(t);
+    }
+
+    static inline void zrand__yield(void) 
+    {
+        Sleep(0);
+    }
+
+    static inline void zrand__nap(void) 
+    {
+        Sleep(1);
+    }
+
+    static inline unsigned zrand__cpu_count(void) 
+    {
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        return si.dwNumberOfProcessors > 0 ? (unsigned)si.dwNumberOfProcessors : 1;
     }
 #else
-#   include <stdio.h>
-    static uint64_t zrand__os_seed(void) 
+#   include <pthread.h>
+#   include <sched.h>
+#   include <time.h>
+#   include <unistd.h>
+    typedef pthread_t zrand__thread;
+
+    static inline bool zrand__thread_create(zrand__thread *t, void *(*fn)(void*), void *arg) 
     {
-        uint64_t seed = 0;
-        FILE *f = fopen("/dev/urandom", "rb");
-        if (f) 
-        {
-            size_t n = fread(&seed, sizeof(seed), 1, f);
-            fclose(f);
-            if (1 == n)
-            {
-                return seed;
-            }
-        }
-        return (uint64_t)time(NULL) ^ (uintptr_t)&seed;
+        return 0 == pthread_create(t, NULL, fn, arg);
     }
-#endif
 
-// PCG implementation details.
+    static inline void zrand__thread_join(zrand__thread t) 
+    {
+        pthread_join(t, NULL);
+    }
 
-static uint32_t zrand__pcg32(zrand_rng *rng) 
-{
-    uint64_t oldstate = rng->state;
-    rng->state = oldstate * 6364136223846793005ULL + (rng->inc | 1);
-    uint32_t xorshifted = (uint32_t)(((oldstate >> 18u) ^ oldstate) >> 27u);
-    uint32_t rot = (uint32_t)(oldstate >> 59u);
-    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
-}
+    static inline void zrand__yield(void) 
+    {
+        sched_yield();
+    }
 
-void zrand_rng_init(zrand_rng *rng, uint64_t seed, uint64_t seq) 
-{
-    rng->state = 0U;
-    rng->inc = (seq << 1u) | 1u;
-    zrand__pcg32(rng);
-    rng->state += seed;
-    zrand__pcg32(rng);
-}
+    static inline void zrand__nap(void) 
+    {
+        struct timespec ts = {0, 50000};
+#   if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+        thrd_sleep(&ts, NULL); // nanosleep() is hidden in strict ISO C modes.
+#   else
+        nanosleep(&ts, NULL);
+#   endif
+    }
 
-// Thread local state.
+    static inline unsigned zrand__cpu_count(void) 
+    {
+#   ifdef _SC_NPROCESSORS_ONLN
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        return n > 0 ? (unsigned)n : 1;
+#   else
+        return 1;
+#   endif
+    }
+#endif
 
-#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
-#   include <threads.h>
-#   define ZRAND_TLS _Thread_local
+#if defined(__GNUC__) || defined(__clang__)
+#   define ZRAND__LOAD_ACQ(p)       __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#   define ZRAND__LOAD_RLX(p)       __atomic_load_n((p), __ATOMIC_RELAXED)
+#   define ZRAND__STORE_REL(p, v)   __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#   define ZRAND__FETCH_ADD(p, v)   __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
 #elif defined(_MSC_VER)
-#   define ZRAND_TLS __declspec(thread)
-#elif defined(__GNUC__)
-#   define ZRAND_TLS __thread
+#   include <intrin.h>
+    // x86/x64 only: aligned 64-bit accesses are atomic and TSO gives acquire/release.
+#   define ZRAND__LOAD_ACQ(p)       (_ReadWriteBarrier(), *(volatile uint64_t*)(p))
+#   define ZRAND__LOAD_RLX(p)       (*(volatile uint64_t*)(p))
+#   define ZRAND__STORE_REL(p, v)   do { _ReadWriteBarrier(); *(volatile uint64_t*)(p) = (v); } while (0)
+#   define ZRAND__FETCH_ADD(p, v)   ((uint64_t)_InterlockedExchangeAdd64((volatile __int64*)(p), (__int64)(v)))
 #else
-#   define ZRAND_TLS
+#   error "zrand.h: concurrent modules need GCC/Clang atomics or MSVC."
 #endif
 
-static ZRAND_TLS zrand_rng zrand_global = {0x853C49E6748FEA9BULL, 0xDA3E39CB94B95BDBULL};
-static ZRAND_TLS bool zrand_seeded = false;
+static inline void *zrand__aligned_alloc(size_t size) 
+{
+    // 64-byte aligned allocation; the original pointer is stored just before the block.
+    void *raw = malloc(size + 64 + sizeof(void*));
+    if (!raw) 
+    {
+        return NULL;
+    }
+    uintptr_t p = ((uintptr_t)raw + sizeof(void*) + 63) & ~(uintptr_t)63;
+    ((void**)p)[-1] = raw;
+    return (void*)p;
+}
 
-static inline zrand_rng* zrand__get(void) 
+static inline void zrand__aligned_free(void *p) 
 {
-    if (!zrand_seeded) 
+    if (p) 
     {
-        zrand_init();
+        free(((void**)p)[-1]);
     }
-    return &zrand_global;
 }
 
-// Global API implementation.
+#endif // ZRAND__THREADING
 
-void zrand_init(void) 
+// Producer ring implementation.
+
+#ifdef ZRAND_PRODUCER
+
+struct zrand_ring 
 {
-    uint64_t seed = zrand__os_seed();
-    uint64_t seq = (uint64_t)(uintptr_t)&zrand_global; 
-    zrand_rng_init(&zrand_global, seed, seq);
-    zrand_seeded = true;
-}
+    // Producer-owned line.
+    ZRAND_ALIGNED(64) uint64_t head;  // Blocks published.
+    uint64_t producer_waits;
 
-uint32_t zrand_u32(void)
+    // Consumer-owned line.
+    ZRAND_ALIGNED(64) uint64_t tail;  // Blocks released back to the producer.
+    const uint64_t *cur;
+    size_t pos;
+    uint64_t popped;
+    uint64_t fallback;
+    zrand_rng local;
+
+    // Shared, read-mostly.
+    ZRAND_ALIGNED(64) uint64_t *blocks;
+    size_t nblocks;
+    zrand_fill_fn fill;
+    void *ctx;
+    zrand_rng pcg;
+    uint64_t stop;
+    zrand__thread thread;
+};
+
+void zrand_fill_pcg(void *ctx, uint64_t *out, size_t n) 
 {
-    return zrand__pcg32(zrand__get());
+    zrand_rng *rng = (zrand_rng*)ctx;
+    for (size_t i = 0; i < n; i++) 
+    {
+        out[i] = zrand_rng_u64(rng);
+    }
 }
 
-uint64_t zrand_u64(void) 
-{ 
-    zrand_rng *r = zrand__get(); 
-    return ((uint64_t)zrand__pcg32(r) << 32) | zrand__pcg32(r); 
+void zrand_fill_os(void *ctx, uint64_t *out, size_t n) 
+{
+    (void)ctx;
+    zrand__os_fill(out, n * sizeof(uint64_t));
 }
 
-float zrand_f32(void) 
-{ 
-    return (zrand_u32() >> 8) * (1.0f / 16777216.0f); 
+static void *zrand__ring_producer(void *arg) 
+{
+    zrand_ring *r = (zrand_ring*)arg;
+    uint64_t head = r->head;
+    unsigned spins = 0;
+    while (!ZRAND__LOAD_ACQ(&r->stop)) 
+    {
+        if (head - ZRAND__LOAD_ACQ(&r->tail) >= r->nblocks) 
+        {
+            // Ring full: spin briefly, then back off.
+            ZRAND__STORE_REL(&r->producer_waits, r->producer_waits + 1);
+            if (++spins < 64) 
+            {
+                zrand__yield();
+            }
+            else 
+            {
+                zrand__nap();
+            }
+            continue;
+        }
+        spins = 0;
+        r->fill(r->ctx, r->blocks + (head % r->nblocks) * ZRAND_RING_BLOCK, ZRAND_RING_BLOCK);
+        head++;
+        ZRAND__STORE_REL(&r->head, head);
+    }
+    return NULL;
 }
 
-double zrand_f64(void) 
-{ 
-    return (zrand_u64() >> 11) * (1.0 / 9007199254740992.0); 
+zrand_ring *zrand_ring_create(size_t nblocks, zrand_fill_fn fill, void *ctx) 
+{
+    if (0 == nblocks) 
+    {
+        return NULL;
+    }
+    zrand_ring *r = (zrand_ring*)zrand__aligned_alloc(sizeof(zrand_ring));
+    if (!r) 
+    {
+        return NULL;
+    }
+    memset(r, 0, sizeof(*r));
+    r->blocks = (uint64_t*)zrand__aligned_alloc(nblocks * ZRAND_RING_BLOCK * sizeof(uint64_t));
+    if (!r->blocks) 
+    {
+        zrand__aligned_free(r);
+        return NULL;
+    }
+    r->nblocks = nblocks;
+    r->pos = ZRAND_RING_BLOCK;
+    zrand_rng_init(&r->local, zrand__os_seed(), (uint64_t)(uintptr_t)r);
+    if (fill) 
+    {
+        r->fill = fill;
+        r->ctx = ctx;
+    }
+    else 
+    {
+        zrand_rng_init(&r->pcg, zrand__os_seed(), (uint64_t)(uintptr_t)r->blocks);
+        r->fill = zrand_fill_pcg;
+        r->ctx = &r->pcg;
+    }
+    if (!zrand__thread_create(&r->thread, zrand__ring_producer, r)) 
+    {
+        zrand__aligned_free(r->blocks);
+        zrand__aligned_free(r);
+        return NULL;
+    }
+    return r;
 }
 
-bool zrand_bool(void) 
-{ 
-    return (zrand_u32() & 1); 
+void zrand_ring_destroy(zrand_ring *ring) 
+{
+    if (!ring) 
+    {
+        return;
+    }
+    ZRAND__STORE_REL(&ring->stop, 1);
+    zrand__thread_join(ring->thread);
+    zrand__aligned_free(ring->blocks);
+    zrand__aligned_free(ring);
 }
 
-bool zrand_chance(double probability) 
-{ 
-    return zrand_f64() < probability; 
+static bool zrand__ring_advance(zrand_ring *r) 
+{
+    if (r->cur) 
+    {
+        // Hand the finished block back to the producer.
+        r->cur = NULL;
+        ZRAND__STORE_REL(&r->tail, r->tail + 1);
+    }
+    if (ZRAND__LOAD_ACQ(&r->head) == r->tail) 
+    {
+        return false;
+    }
+    r->cur = r->blocks + (r->tail % r->nblocks) * ZRAND_RING_BLOCK;
+    r->pos = 0;
+    return true;
 }
 
-int32_t zrand_range(int32_t min, int32_t max) 
+uint64_t zrand_ring_pop_u64(zrand_ring *ring) 
 {
-    if (min >= max) 
+    if (ZRAND_RING_BLOCK == ring->pos && !zrand__ring_advance(ring)) 
     {
-        return min;
+        ring->fallback++;
+        return zrand_rng_u64(&ring->local);
     }
-    uint32_t range = (uint32_t)(max - min) + 1;
-    uint32_t x, limit = (uint32_t) - 1;
-    uint32_t bucket_size = limit / range;
-    uint32_t rejection_limit = bucket_size * range;
-    do
-    {
-        x = zrand_u32();
-    } while (x >= rejection_limit); 
-    return min + (int32_t)(x / bucket_size);
+    ring->popped++;
+    return ring->cur[ring->pos++];
 }
 
-float zrand_range_f(float min, float max) 
+double zrand_ring_pop_f64(zrand_ring *ring) 
 {
-    return min + zrand_f32() * (max - min);
+    return (zrand_ring_pop_u64(ring) >> 11) * (1.0 / 9007199254740992.0);
 }
 
-static double zrand__box_muller(zrand_rng *rng, double mean, double stddev) 
+void zrand_ring_get_stats(zrand_ring *ring, zrand_ring_stats *out) 
 {
-    double u, v, s;
-    do 
-    { 
-        u = (zrand_rng_f64(rng) * 2) - 1; 
-        v = (zrand_rng_f64(rng) * 2) - 1; 
-        s = u * u + v * v; 
-    } while (s >= 1 || s == 0);
-    
-    s = zmath_sqrt((-2.0 * zmath_log(s)) / s);
-    return mean + (stddev * u * s); 
+    uint64_t head = ZRAND__LOAD_ACQ(&ring->head);
+    out->popped = ring->popped;
+    out->fallback = ring->fallback;
+    out->produced = head;
+    out->producer_waits = ZRAND__LOAD_RLX(&ring->producer_waits);
+    out->occupancy = (uint32_t)(head - ring->tail);
+    out->capacity = (uint32_t)ring->nblocks;
 }
 
-double zrand_gaussian(double mean, double stddev) 
-{ 
-    return zrand__box_muller(zrand__get(), mean, stddev); 
+#endif // ZRAND_PRODUCER
+
+// Shared generator implementation.
+
+#ifdef ZRAND_SHARED
+
+void zrand_shared_init(zrand_shared *sh, uint64_t seed) 
+{
+    memset(sh, 0, sizeof(*sh));
+    // Spread small seeds over the whole key space.
+    zrand_rng tmp;
+    zrand_rng_init(&tmp, seed, 0x5EED5EEDULL);
+    sh->key = zrand_rng_u64(&tmp);
 }
 
-// Utilities implementation.
+uint64_t zrand_shared_at(const zrand_shared *sh, uint64_t index) 
+{
+    // SplitMix64: golden-ratio Weyl sequence through a strong finalizer.
+    return zrand__mix64(sh->key + (index + 1) * 0x9E3779B97F4A7C15ULL);
+}
 
-void zrand_bytes(void *buf, size_t len) 
+uint64_t zrand_shared_reserve(zrand_shared *sh, uint64_t k) 
 {
-    uint8_t *p = (uint8_t*)buf;
-    while (len >= 4) 
-    { 
-        *(uint32_t*)p = zrand_u32(); 
-        p += 4; 
-        len -= 4; 
-    }
-    if (len > 0) 
-    { 
-        uint32_t rem = zrand_u32(); 
-        uint8_t *r = (uint8_t*)&rem; 
-        while (len--) 
-        {
-            *p++ = *r++; 
-        }
+    return ZRAND__FETCH_ADD(&sh->counter, k);
+}
+
+uint64_t zrand_shared_u64(zrand_shared *sh) 
+{
+    return zrand_shared_at(sh, ZRAND__FETCH_ADD(&sh->counter, 1));
+}
+
+void zrand_shared_fill_u64(zrand_shared *sh, uint64_t *out, size_t n) 
+{
+    uint64_t base = ZRAND__FETCH_ADD(&sh->counter, (uint64_t)n);
+    for (size_t i = 0; i < n; i++) 
+    {
+        out[i] = zrand_shared_at(sh, base + i);
     }
 }
 
-static const char ZRAND_ALPHANUM[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+void zrand_shared_cursor_init(zrand_shared_cursor *cur, zrand_shared *sh, uint32_t batch) 
+{
+    cur->shared = sh;
+    cur->next = 0;
+    cur->end = 0;
+    cur->batch = batch ? batch : 1;
+}
 
-void zrand_str(char *buf, size_t len) 
+uint64_t zrand_shared_cursor_u64(zrand_shared_cursor *cur) 
 {
-    for (size_t i = 0; i < len; i++)
+    if (cur->next == cur->end) 
     {
-        buf[i] = ZRAND_ALPHANUM[zrand_u32() % (sizeof(ZRAND_ALPHANUM) - 1)];
+        cur->next = ZRAND__FETCH_ADD(&cur->shared->counter, (uint64_t)cur->batch);
+        cur->end = cur->next + cur->batch;
     }
-    buf[len] = '\0';
+    return zrand_shared_at(cur->shared, cur->next++);
 }
 
-void zrand_uuid(char *buf) 
+#endif // ZRAND_SHARED
+
+// Parallel-for implementation.
+
+#ifdef ZRAND_PARALLEL
+
+typedef struct 
 {
-    static const char *hex = "0123456789abcdef";
-    uint8_t b[16]; 
-    zrand_bytes(b, 16);
-    
-    // Variant and version bits.
-    b[6] = (b[6] & 0x0F) | 0x40; 
-    b[8] = (b[8] & 0x3F) | 0x80;
-    
-    int k = 0;
-    for (int i = 0; i < 16; i++) 
+    ZRAND_ALIGNED(64) uint64_t next; // Next unclaimed chunk.
+    ZRAND_ALIGNED(64) size_t n;
+    size_t chunk;
+    uint64_t nchunks;
+    uint64_t seed;
+    zrand_task_fn fn;
+    void *ctx;
+} zrand__pfor;
+
+static void *zrand__pfor_worker(void *arg) 
+{
+    zrand__pfor *job = (zrand__pfor*)arg;
+    for (;;) 
     {
-        if (4 == i || 6 == i ||
-            8 == i || 10 == i) 
+        // Idle workers grab the next chunk, so uneven chunks balance out.
+        uint64_t c = ZRAND__FETCH_ADD(&job->next, 1);
+        if (c >= job->nchunks) 
         {
-            buf[k++] = '-';
+            break;
         }
-        buf[k++] = hex[(b[i] >> 4) & 0xF]; 
-        buf[k++] = hex[b[i] & 0xF];
+        zrand_rng rng;
+        zrand_rng_init(&rng, zrand__mix64(job->seed + (c + 1) * 0x9E3779B97F4A7C15ULL), c);
+        size_t begin = (size_t)c * job->chunk;
+        size_t end = (job->n - begin < job->chunk) ? job->n : begin + job->chunk;
+        job->fn(job->ctx, begin, end, &rng);
     }
-    buf[k] = '\0';
+    return NULL;
 }
 
-void zrand_shuffle(void *base, size_t nmemb, size_t size) 
+void zrand_parallel_for_ex(size_t n, size_t chunk, uint64_t seed, zrand_task_fn fn, void *ctx, unsigned nthreads) 
 {
-    if (nmemb <= 1) 
+    if (0 == n || !fn) 
     {
         return;
     }
-    char *arr = (char*)base; 
-    char temp[256]; 
-    char *swap_buf = (size > sizeof(temp)) ? (char*)malloc(size) : temp;
-    if (!swap_buf) 
+    if (0 == chunk) 
     {
-        return;
+        chunk = 1;
     }
+    zrand__pfor job;
+    memset(&job, 0, sizeof(job));
+    job.n = n;
+    job.chunk = chunk;
+    job.nchunks = n / chunk + (0 != n % chunk); // `n + chunk - 1` can overflow.
+    job.seed = seed;
+    job.fn = fn;
+    job.ctx = ctx;
 
-    for (size_t i = nmemb - 1; i > 0; i--) 
+    if (0 == nthreads) 
     {
-        size_t j = zrand_range(0, (int32_t)i);
-        if (i != j) 
+        nthreads = zrand__cpu_count();
+    }
+    if (nthreads > job.nchunks) 
+    {
+        nthreads = (unsigned)job.nchunks;
+    }
+
+    zrand__thread stack_pool[16];
+    zrand__thread *pool = stack_pool;
+    if (nthreads - 1 > sizeof(stack_pool) / sizeof(stack_pool[0])) 
+    {
+        pool = (zrand__thread*)malloc((nthreads - 1) * sizeof(zrand__thread));
+        if (!pool) 
         {
-            memcpy(swap_buf, arr + i * size, size);
-            memcpy(arr + i * size, arr + j * size, size);
-            memcpy(arr + j * size, swap_buf, size);
+            nthreads = 1;
+            pool = stack_pool;
         }
     }
-    if (swap_buf != temp) free(swap_buf);
-}
 
-void* zrand_choice(void *base, size_t nmemb, size_t size) 
-{
-    if (0 == nmemb) 
+    // The calling thread works too; if a spawn fails the others pick up its share.
+    unsigned started = 0;
+    while (started + 1 < nthreads && zrand__thread_create(&pool[started], zrand__pfor_worker, &job)) 
     {
-        return NULL;
+        started++;
+    }
+    zrand__pfor_worker(&job);
+    for (unsigned i = 0; i < started; i++) 
+    {
+        zrand__thread_join(pool[i]);
+    }
+    if (pool != stack_pool) 
+    {
+        free(pool);
     }
-    return (char*)base + (zrand_range(0, (int32_t)nmemb - 1) * size);
-}
-
-// Instance Wrappers (forwarding).
-
-uint32_t zrand_rng_u32(zrand_rng *rng) 
-{ 
-    return zrand__pcg32(rng); 
-}
-
-uint64_t zrand_rng_u64(zrand_rng *rng) 
-{ 
-    return ((uint64_t)zrand__pcg32(rng) << 32) | zrand__pcg32(rng); 
-}
-
-double zrand_rng_f64(zrand_rng *rng) 
-{ 
-    return (zrand_rng_u64(rng) >> 11) * (1.0 / 9007199254740992.0); 
-}
-
-double zrand_rng_gaussian(zrand_rng *r, double m, double s) 
-{ 
-    return zrand__box_muller(r, m, s); 
 }
 
-int32_t zrand_rng_range(zrand_rng *rng, int32_t min, int32_t max) 
+void zrand_parallel_for(size_t n, size_t chunk, uint64_t seed, zrand_task_fn fn, void *ctx) 
 {
-    if (min >= max) 
-    {
-        return min;
-    }
-    uint32_t range = (uint32_t)(max - min) + 1;
-    uint32_t x, bucket = ((uint32_t)-1) / range;
-    do 
-    { 
-        x = zrand_rng_u32(rng); 
-    } while (x >= bucket * range);
-    return min + (int32_t)(x / bucket);
+    zrand_parallel_for_ex(n, chunk, seed, fn, ctx, 0);
 }
 
+#endif // ZRAND_PARALLEL
+
 #endif //ZRAND_IMPLEMENTATION_GUARD
 #endif // ZRAND_IMPLEMENTATION